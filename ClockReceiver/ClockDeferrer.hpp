@@ -9,12 +9,23 @@
 #ifndef ClockDeferrer_h
 #define ClockDeferrer_h
 
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <vector>
 
 /*!
-	A ClockDeferrer maintains a list of ordered actions and the times at which
-	they should happen, and divides a total execution period up into the portions
-	that occur between those actions, triggering each action when it is reached.
+	A ClockDeferrer maintains a list of actions and the times at which they should happen,
+	and divides a total execution period up into the portions that occur between those actions,
+	triggering each action when it is reached.
+
+	Actions are keyed on absolute time, so they may be scheduled in any order; actions due at
+	the same time are performed in the order in which they were scheduled. While only a few
+	actions are pending the next is found by a linear search; beyond that they are kept in a
+	min-heap.
+	Storage for actions is pooled and reused, so once the deferrer has seen its maximum number
+	of simultaneously-pending actions, scheduling allocates nothing further.
 */
 template <typename TimeUnit> class ClockDeferrer {
 	public:
@@ -24,11 +35,28 @@ template <typename TimeUnit> class ClockDeferrer {
 		/*!
 			Schedules @c action to occur in @c delay units of time.
 
-			Actions must be scheduled in the order they will occur. It is undefined behaviour
-			to schedule them out of order.
+			Actions may be scheduled in any order, including from within other actions.
 		*/
-		void defer(TimeUnit delay, const std::function<void(void)> &action) {
-			pending_actions_.emplace_back(delay, action);
+		void defer(TimeUnit delay, std::function<void(void)> action) {
+			std::size_t index;
+			if(free_actions_.empty()) {
+				index = actions_.size();
+				actions_.emplace_back();
+			} else {
+				index = free_actions_.back();
+				free_actions_.pop_back();
+			}
+
+			actions_[index] = std::move(action);
+			pending_actions_.emplace_back(now_ + delay, next_sequence_, index);
+			++next_sequence_;
+
+			if(is_heap_) {
+				std::push_heap(pending_actions_.begin(), pending_actions_.end());
+			} else if(pending_actions_.size() > LinearSearchLimit) {
+				std::make_heap(pending_actions_.begin(), pending_actions_.end());
+				is_heap_ = true;
+			}
 		}
 
 		/*!
@@ -46,36 +74,87 @@ template <typename TimeUnit> class ClockDeferrer {
 			}
 
 			// Divide the time to run according to the pending actions.
-			while(length > TimeUnit(0)) {
-				TimeUnit next_period = pending_actions_.empty() ? length : std::min(length, pending_actions_[0].delay);
-				target_(next_period);
-				length -= next_period;
-
-				off_t performances = 0;
-				for(auto &action: pending_actions_) {
-					action.delay -= next_period;
-					if(!action.delay) {
-						action.action();
-						++performances;
-					}
+			const TimeUnit end = now_ + length;
+			while(now_ < end) {
+				const TimeUnit next_time = pending_actions_.empty() ? end : std::min(end, next_action()->time);
+				if(next_time > now_) {
+					target_(next_time - now_);
+					now_ = next_time;
 				}
-				if(performances) {
-					pending_actions_.erase(pending_actions_.begin(), pending_actions_.begin() + performances);
+
+				// Perform everything that is now due. Each action is removed from the pending list before
+				// it is called, and its storage released only afterwards, so that it may itself defer
+				// further actions.
+				while(!pending_actions_.empty()) {
+					const auto next = next_action();
+					if(now_ < next->time) break;
+
+					const std::size_t index = remove_action(next);
+					actions_[index]();
+					free_actions_.push_back(index);
 				}
 			}
+
+			// Time is measured relative to an arbitrary origin; reset it whenever nothing is
+			// pending so that it never grows without bound.
+			if(pending_actions_.empty()) {
+				now_ = TimeUnit(0);
+			}
 		}
 
 	private:
 		std::function<void(TimeUnit)> target_;
 
-		// The list of deferred actions.
-		struct DeferredAction {
-			TimeUnit delay;
-			std::function<void(void)> action;
+		// The pool of deferred actions; free_actions_ lists the indices of those that are available for reuse.
+		// A deque is used so that adding to the pool doesn't move any action that is currently being performed.
+		std::deque<std::function<void(void)>> actions_;
+		std::vector<std::size_t> free_actions_;
+
+		// The actions that are scheduled. Under the ordering below the earliest compares greatest;
+		// ties go to whichever was scheduled first. If is_heap_ is set then this is a heap, so the
+		// earliest is at the front; otherwise it is unordered.
+		struct PendingAction {
+			TimeUnit time;
+			unsigned int sequence;
+			std::size_t index;
 
-			DeferredAction(TimeUnit delay, const std::function<void(void)> &action) : delay(delay), action(std::move(action)) {}
+			PendingAction(TimeUnit time, unsigned int sequence, std::size_t index) : time(time), sequence(sequence), index(index) {}
+
+			bool operator <(const PendingAction &rhs) const {
+				if(time != rhs.time) return rhs.time < time;
+				return static_cast<int>(sequence - rhs.sequence) > 0;
+			}
 		};
-		std::vector<DeferredAction> pending_actions_;
+		std::vector<PendingAction> pending_actions_;
+		bool is_heap_ = false;
+
+		// The number of pending actions above which a heap is used. A linear search is cheaper
+		// for the one or two actions that are typically pending; once adopted, the heap is kept
+		// until nothing is pending.
+		static constexpr std::size_t LinearSearchLimit = 8;
+
+		/// @returns the pending action that is due first.
+		typename std::vector<PendingAction>::iterator next_action() {
+			if(is_heap_) return pending_actions_.begin();
+			return std::max_element(pending_actions_.begin(), pending_actions_.end());
+		}
+
+		/// Removes @c action, as returned by @c next_action, from the pending list, returning its index in the pool.
+		std::size_t remove_action(typename std::vector<PendingAction>::iterator action) {
+			if(is_heap_) {
+				std::pop_heap(pending_actions_.begin(), pending_actions_.end());
+			} else {
+				std::iter_swap(action, pending_actions_.end() - 1);
+			}
+
+			const std::size_t index = pending_actions_.back().index;
+			pending_actions_.pop_back();
+			if(pending_actions_.empty()) is_heap_ = false;
+			return index;
+		}
+
+		TimeUnit now_;
+		unsigned int next_sequence_ = 0;
 };
 
 #endif /* ClockDeferrer_h */
@@ -0,0 +1,175 @@
+//
+//  JustInTime.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef JustInTime_hpp
+#define JustInTime_hpp
+
+#include "ClockReceiver.hpp"
+#include "ForceInline.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace JustInTime {
+
+/// Locates the object that receives time, given whatever holds it: either the object itself or a std::unique_ptr to it.
+template <class T> struct Dereferencer {
+	typedef T Target;
+	static T &get(T &holder) { return holder; }
+};
+template <class T> struct Dereferencer<std::unique_ptr<T>> {
+	typedef T Target;
+	static T &get(std::unique_ptr<T> &holder) { return *holder; }
+};
+
+/// Determines whether @c T announces sequence points, i.e. whether it has a get_next_sequence_point method.
+template <class T> class HasSequencePoints {
+	private:
+		template <class C> static char test(decltype(&C::get_next_sequence_point));
+		template <class C> static long test(...);
+
+	public:
+		static constexpr bool value = sizeof(test<T>(nullptr)) == sizeof(char);
+};
+
+}
+
+/*!
+	A JustInTimeActor holds an object that implements run_for, and the amount of time that has
+	passed since that object was last run. It captures the idiomatic pattern by which owners
+	accumulate time for a component and bring it up to date only upon interaction.
+
+	Time is added using +=. Using -> to reach the object will first run it for all accumulated time.
+	If only information that is not time-dependent is required, last_valid provides access without
+	doing so.
+
+	Each unit of @c LocalTimeScale supplied is worth @c multiplier / @c divider units of the
+	@c TargetTimeScale that the object's run_for accepts; any remainder of a division is carried forward.
+
+	The object may optionally implement get_next_sequence_point, returning a @c TargetTimeScale count
+	of the time until it next does something that the owner needs to observe promptly, such as
+	changing an interrupt output, or a count that is not positive if there is no such time. That
+	will be queried after every flush and after every access via ->. += will then flush automatically
+	upon reaching the sequence point and return @c true, allowing owners to run uninterrupted
+	until the next thing of interest.
+
+	@c T may be either the object itself or a std::unique_ptr to it.
+*/
+template <class T, class LocalTimeScale = HalfCycles, class TargetTimeScale = LocalTimeScale, int multiplier = 1, int divider = 1> class JustInTimeActor {
+	public:
+		typedef typename JustInTime::Dereferencer<T>::Target Target;
+
+		/// Constructs a new JustInTimeActor using the same construction arguments as the included object.
+		template <typename... Args> JustInTimeActor(Args&&... args) : object_(std::forward<Args>(args)...) {}
+
+		/*!
+			Adds time to the actor.
+
+			@returns @c true if a sequence point has been reached, in which case the object has been flushed;
+				@c false otherwise. See @c last_sequence_point_overrun for the precise time at which it occurred.
+		*/
+		forceinline bool operator += (const LocalTimeScale &rhs) {
+			if(multiplier != 1) {
+				time_since_update_ += LocalTimeScale(rhs.as_int() * multiplier);
+			} else {
+				time_since_update_ += rhs;
+			}
+			is_flushed_ = false;
+
+			if(has_sequence_points && time_until_event_ > LocalTimeScale(0)) {
+				time_until_event_ -= rhs;
+				if(time_until_event_ <= LocalTimeScale(0)) {
+					time_overrun_ = time_until_event_;
+					flush();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// Provides access to the object, having first flushed it; its next sequence point is re-queried after the access.
+		class Accessor {
+			public:
+				Accessor(JustInTimeActor &actor) : actor_(actor) {}
+				~Accessor() { actor_.update_sequence_point(); }
+				forceinline Target *operator ->() { return &JustInTime::Dereferencer<T>::get(actor_.object_); }
+
+			private:
+				JustInTimeActor &actor_;
+		};
+
+		/// Flushes all accumulated time and provides access to the object.
+		forceinline Accessor operator ->() {
+			flush();
+			return Accessor(*this);
+		}
+
+		/// Provides access to the object without flushing; it will be in the state it reached upon the most recent flush.
+		forceinline Target *last_valid() {
+			return &JustInTime::Dereferencer<T>::get(object_);
+		}
+
+		/// Provides access to whatever holds the object, e.g. in order to replace the std::unique_ptr that owns it.
+		/// A call to update_sequence_point should follow any replacement.
+		forceinline T &object() {
+			return object_;
+		}
+
+		/// @returns the amount of time accumulated since the most recent flush.
+		forceinline LocalTimeScale time_since_flush() const {
+			return multiplier != 1 ? LocalTimeScale(time_since_update_.as_int() / multiplier) : time_since_update_;
+		}
+
+		/// Runs the object for all time accumulated since the most recent flush, and re-queries its next sequence point.
+		forceinline void flush() {
+			if(is_flushed_) return;
+			is_flushed_ = true;
+
+			const LocalTimeScale time = (divider != 1) ? time_since_update_.divide(LocalTimeScale(divider)) : time_since_update_.flush();
+			JustInTime::Dereferencer<T>::get(object_).run_for(TargetTimeScale(time.as_int()));
+			update_sequence_point();
+		}
+
+		/*!
+			@returns the amount of time since the most recent sequence point was reached, as a number
+				that is less than or equal to zero.
+		*/
+		forceinline LocalTimeScale last_sequence_point_overrun() const {
+			return time_overrun_;
+		}
+
+		/// Re-queries the object's next sequence point.
+		forceinline void update_sequence_point() {
+			update_sequence_point(std::integral_constant<bool, has_sequence_points>());
+		}
+
+	private:
+		static constexpr bool has_sequence_points = JustInTime::HasSequencePoints<Target>::value;
+
+		T object_;
+		LocalTimeScale time_since_update_, time_until_event_, time_overrun_;
+		bool is_flushed_ = true;
+
+		void update_sequence_point(std::false_type) {}
+		void update_sequence_point(std::true_type) {
+			const int sequence_point = JustInTime::Dereferencer<T>::get(object_).get_next_sequence_point().as_int();
+			if(sequence_point <= 0) {
+				time_until_event_ = LocalTimeScale(0);
+				return;
+			}
+
+			// Convert to local time, allowing for any time already accumulated, and rounding up;
+			// if that implies the sequence point is already due then report it at the next opportunity.
+			const int local_time = (sequence_point * divider - time_since_update_.as_int() + multiplier - 1) / multiplier;
+			time_until_event_ = LocalTimeScale(std::max(local_time, 1));
+		}
+};
+
+#endif /* JustInTime_hpp */
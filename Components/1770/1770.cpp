@@ -117,6 +117,7 @@ void WD1770::run_for(const Cycles cycles) {
 
 #define WAIT_FOR_EVENT(mask)	resume_point_ = __LINE__; interesting_event_mask_ = static_cast<int>(mask); return; case __LINE__:
 #define WAIT_FOR_TIME(ms)		resume_point_ = __LINE__; delay_time_ = ms * 8000; WAIT_FOR_EVENT(Event1770::Timer);
+#define WAIT_FOR_CYCLES(count)	resume_point_ = __LINE__; delay_time_ = static_cast<unsigned int>(count); WAIT_FOR_EVENT(Event1770::Timer);
 #define WAIT_FOR_BYTES(count)	resume_point_ = __LINE__; distance_into_section_ = 0; WAIT_FOR_EVENT(Event::Token); if(get_latest_token().type == Token::Byte) distance_into_section_++; if(distance_into_section_ < count) { interesting_event_mask_ = static_cast<int>(Event::Token); return; }
 #define BEGIN_SECTION()	switch(resume_point_) { default:
 #define END_SECTION()	(void)0; }
@@ -197,6 +198,7 @@ void WD1770::posit_event(int new_event_type) {
 	wait_for_command:
 		LOG("Idle...");
 		set_data_mode(DataMode::Scanning);
+		set_is_decoding_flux(true);
 		index_hole_count_ = 0;
 
 		update_status([] (Status &status) {
@@ -393,6 +395,20 @@ void WD1770::posit_event(int new_event_type) {
 			goto wait_for_command;
 		}
 
+		// If fast sector transfer is enabled, and this is a read, try to find the sector without
+		// going to the flux level.
+		if(!(command_&0x20)) {
+			Storage::Encodings::MFM::Sector::Address address;
+			address.track = track_;
+			address.side = (command_&0x08) >> 3;
+			address.sector = sector_;
+			if(get_fast_transfer_sector(address, 0, !has_motor_on_line() && (command_&0x02), false, fast_transfer_sector_)) {
+				if(fast_transfer_sector_) goto type2_fast_read_data;
+				goto type2_fast_record_not_found;
+			}
+		}
+		set_is_decoding_flux(true);
+
 	type2_get_header:
 		WAIT_FOR_EVENT(static_cast<int>(Event::IndexHole) | static_cast<int>(Event::Token));
 		READ_ID();
@@ -484,6 +500,49 @@ void WD1770::posit_event(int new_event_type) {
 		goto type2_check_crc;
 
 
+	type2_fast_read_data:
+		LOG("Fast transferring " << std::dec << track_ << "/" << sector_);
+		set_is_decoding_flux(false);
+		update_status([this] (Status &status) {
+			status.crc_error = false;
+			status.record_type = fast_transfer_sector_->is_deleted;
+		});
+		distance_into_section_ = 0;
+
+	type2_fast_read_byte:
+		WAIT_FOR_CYCLES(get_fast_transfer_byte_period().as_int());
+		data_ = fast_transfer_sector_->samples[0][static_cast<std::size_t>(distance_into_section_)];
+		update_status([] (Status &status) {
+			status.lost_data |= status.data_request;
+			status.data_request = true;
+		});
+		distance_into_section_++;
+		if(distance_into_section_ < 128 << fast_transfer_sector_->size) goto type2_fast_read_byte;
+
+		// Allow time for the CRC, which is already known to be correct. Then reset the position in the
+		// section, as the flux-level header search expects if it is used for the next sector.
+		fast_transfer_sector_.reset();
+		distance_into_section_ = 0;
+		WAIT_FOR_CYCLES(get_fast_transfer_byte_period().as_int() * 2);
+		if(command_ & 0x10) {
+			sector_++;
+			goto test_type2_write_protection;
+		}
+		LOG("Finished reading sector " << std::dec << sector_);
+		goto wait_for_command;
+
+
+	type2_fast_record_not_found:
+		set_is_decoding_flux(false);
+		WAIT_FOR_EVENT(Event::IndexHole);
+		if(index_hole_count_ < 5) goto type2_fast_record_not_found;
+		LOG("Failed to find sector " << std::dec << sector_);
+		update_status([] (Status &status) {
+			status.record_not_found = true;
+		});
+		goto wait_for_command;
+
+
 	type2_write_data:
 		WAIT_FOR_BYTES(2);
 		update_status([] (Status &status) {
@@ -35,6 +35,9 @@ class WD1770: public Storage::Disk::MFMController {
 		/// Sets the value of the double-density input; when @c is_double_density is @c true, reads and writes double-density format data.
 		using Storage::Disk::MFMController::set_is_double_density;
 
+		/// Enables or disables fast transfer of sectors that decode cleanly, optionally at @c speed_multiplier times the natural rate.
+		using Storage::Disk::MFMController::set_fast_sector_transfer;
+
 		/// Writes @c value to the register at @c address. Only the low two bits of the address are decoded.
 		void set_register(int address, uint8_t value);
 
@@ -126,6 +129,9 @@ class WD1770: public Storage::Disk::MFMController {
 		// ID buffer
 		uint8_t header_[6];
 
+		// The sector currently being supplied by fast sector transfer, if any.
+		std::shared_ptr<const Storage::Encodings::MFM::Sector> fast_transfer_sector_;
+
 		// 1793 head-loading logic
 		bool head_is_loaded_ = false;
 
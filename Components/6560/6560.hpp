@@ -15,6 +15,8 @@
 #include "../../Outputs/Speaker/Implementation/LowpassSpeaker.hpp"
 #include "../../Outputs/Speaker/Implementation/SampleSource.hpp"
 
+#include <cmath>
+
 namespace MOS {
 namespace MOS6560 {
 
@@ -77,7 +79,12 @@ template <class BusHandler> class MOS6560 {
 					"float chroma = step(yc.y, 0.75) * cos(phase + phaseOffset);"
 
 					"return vec2(yc.x, chroma);"
-				"}");
+				"}",
+				[] (const uint8_t *source, float phase, float amplitude, float *luminance_chrominance) {
+					const float chrominance = static_cast<float>(source[1]) / 255.0f;
+					luminance_chrominance[0] = static_cast<float>(source[0]) / 255.0f;
+					luminance_chrominance[1] = (chrominance <= 0.75f) ? std::cos(phase + 6.283185308f * 2.0f * chrominance) : 0.0f;
+				});
 
 			// default to s-video output
 			crt_->set_video_signal(Outputs::CRT::VideoSignal::SVideo);
@@ -11,6 +11,7 @@
 
 #include "../../ClockReceiver/ClockReceiver.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 
@@ -41,6 +42,13 @@ class BusHandler {
 			having to wait until the next cycle has begun.
 		*/
 		void perform_bus_cycle_phase2(const BusState &) {}
+
+		/*!
+			Performs @c number_of_cycles consecutive bus cycles during which no part of the bus state changes
+			other than the refresh address, which begins at the value given in @c state and increments by one
+			per cycle. Since sync cannot change during a run, no phase 2 calls are made for its cycles.
+		*/
+		void perform_bus_cycle_run(const BusState &, int number_of_cycles) {}
 };
 
 enum Personality {
@@ -112,7 +120,16 @@ template <class T> class CRTC6845 {
 
 		void run_for(Cycles cycles) {
 			int cyles_remaining = cycles.as_int();
-			while(cyles_remaining--) {
+			while(cyles_remaining) {
+				// Cycles in which only the refresh address will change are passed on as a single run.
+				const int run_length = std::min(cyles_remaining, get_cycles_until_event());
+				if(run_length) {
+					perform_bus_cycle_run(run_length);
+					cyles_remaining -= run_length;
+					continue;
+				}
+				--cyles_remaining;
+
 				// check for end of visible characters
 				if(character_counter_ == registers_[1]) {
 					// TODO: consider skew in character_is_visible_. Or maybe defer until perform_bus_cycle?
@@ -164,7 +181,40 @@ template <class T> class CRTC6845 {
 			return bus_state_;
 		}
 
+		/*!
+			@returns The number of cycles that will definitely elapse before hsync or vsync next changes, assuming
+			no intervening register changes; the change may occur during the cycle after those counted.
+		*/
+		int get_cycles_until_sync_change() const {
+			if(bus_state_.hsync) return 0;
+			return std::min(
+				distance_to_character(static_cast<uint8_t>(registers_[2] - 1)),
+				distance_to_character(registers_[0]));
+		}
+
 	private:
+		/// @returns The number of cycles until the character counter will reach @c character.
+		inline int distance_to_character(uint8_t character) const {
+			return static_cast<uint8_t>(character - character_counter_);
+		}
+
+		/*!
+			@returns The number of cycles before the next at which any part of the bus state other than the refresh
+			address might change; i.e. the length of the run that can currently be performed.
+		*/
+		inline int get_cycles_until_event() const {
+			// Require that display enable is not propagating through the skew shifter.
+			if((character_is_visible_shifter_ & 3) != (character_is_visible_ ? 3 : 0)) return 0;
+			return std::min(get_cycles_until_sync_change(), distance_to_character(registers_[1]));
+		}
+
+		inline void perform_bus_cycle_run(int number_of_cycles) {
+			bus_state_.display_enable = character_is_visible_ && line_is_visible_;
+			bus_handler_.perform_bus_cycle_run(bus_state_, number_of_cycles);
+			bus_state_.refresh_address = (bus_state_.refresh_address + number_of_cycles) & 0x3fff;
+			character_counter_ = static_cast<uint8_t>(character_counter_ + number_of_cycles);
+		}
+
 		inline void perform_bus_cycle_phase1() {
 			// Skew theory of operation: keep a history of the last three states, and apply whichever is selected.
 			character_is_visible_shifter_ = (character_is_visible_shifter_ << 1) | static_cast<unsigned int>(character_is_visible_);
@@ -199,7 +199,8 @@ uint8_t i8272::get_register(int address) {
 
 #define MS_TO_CYCLES(x)			x * 8000
 #define WAIT_FOR_EVENT(mask)	resume_point_ = __LINE__; interesting_event_mask_ = static_cast<int>(mask); return; case __LINE__:
-#define WAIT_FOR_TIME(ms)		resume_point_ = __LINE__; interesting_event_mask_ = static_cast<int>(Event8272::Timer); delay_time_ = MS_TO_CYCLES(ms); is_sleeping_ = false; update_clocking_observer(); case __LINE__: if(delay_time_) return;
+#define WAIT_FOR_CYCLES(n)		resume_point_ = __LINE__; interesting_event_mask_ = static_cast<int>(Event8272::Timer); delay_time_ = (n); is_sleeping_ = false; update_clocking_observer(); case __LINE__: if(delay_time_) return;
+#define WAIT_FOR_TIME(ms)		WAIT_FOR_CYCLES(MS_TO_CYCLES(ms))
 
 #define PASTE(x, y) x##y
 #define CONCAT(x, y) PASTE(x, y)
@@ -279,6 +280,7 @@ void i8272::posit_event(int event_type) {
 	wait_for_command:
 			expects_input_ = false;
 			set_data_mode(Storage::Disk::MFMController::DataMode::Scanning);
+			set_is_decoding_flux(true);
 			ResetBusy();
 			ResetNonDMAExecution();
 			command_.clear();
@@ -432,8 +434,73 @@ void i8272::posit_event(int event_type) {
 				<< static_cast<int>(command_[6]) << " "
 				<< static_cast<int>(command_[8]) << "]");
 		read_next_data:
+			// If fast sector transfer is enabled, try to find the sector without going to the flux level. Sectors
+			// with the wrong sort of data mark are left to the flux level if they would be skipped.
+			{
+				Storage::Encodings::MFM::Sector::Address address;
+				address.track = cylinder_;
+				address.side = head_;
+				address.sector = sector_;
+				if(get_fast_transfer_sector(address, size_, true, true, fast_transfer_sector_)) {
+					if(!fast_transfer_sector_) goto read_data_fast_transfer_no_data;
+					if(
+						!(command_[0]&0x20) ||
+						fast_transfer_sector_->is_deleted == ((command_[0] & 0x1f) == CommandReadDeletedData)
+					) goto read_data_fast_transfer;
+				}
+			}
+			set_is_decoding_flux(true);
 			goto read_write_find_header;
 
+		// Waits for two index holes, as if searching for a sector that fast sector transfer has found not to exist.
+		read_data_fast_transfer_no_data:
+			set_is_decoding_flux(false);
+			index_hole_limit_ = 2;
+		read_data_fast_transfer_await_index:
+			WAIT_FOR_EVENT(Event::IndexHole);
+			index_hole_limit_--;
+			if(index_hole_limit_) goto read_data_fast_transfer_await_index;
+			SetNoData();
+			goto abort;
+
+		// Supplies the sector found by fast sector transfer to the CPU at the fast transfer rate, with the same
+		// data request and overrun logic as at the flux level.
+		read_data_fast_transfer:
+			set_is_decoding_flux(false);
+			ClearControlMark();
+			if(fast_transfer_sector_->is_deleted != ((command_[0] & 0x1f) == CommandReadDeletedData)) {
+				SetControlMark();
+			}
+			distance_into_section_ = 0;
+			WAIT_FOR_CYCLES(get_fast_transfer_byte_period().as_int());
+
+		read_data_fast_transfer_get_byte:
+			result_stack_.push_back(fast_transfer_sector_->samples[0][static_cast<std::size_t>(distance_into_section_)]);
+			distance_into_section_++;
+			SetDataRequest();
+			SetDataDirectionToProcessor();
+			delay_time_ = get_fast_transfer_byte_period().as_int();
+			is_sleeping_ = false;
+			update_clocking_observer();
+			WAIT_FOR_EVENT(static_cast<int>(Event8272::ResultEmpty) | static_cast<int>(Event8272::Timer));
+			if(event_type == static_cast<int>(Event8272::Timer)) {
+				// The caller hasn't read the old byte yet and a new one has arrived.
+				SetOverrun();
+				goto abort;
+			}
+			ResetDataRequest();
+			WAIT_FOR_EVENT(Event8272::Timer);
+			if(distance_into_section_ < (128 << size_)) goto read_data_fast_transfer_get_byte;
+
+		// Allow time for the CRC, which is already known to be correct, then continue as per the flux level.
+			fast_transfer_sector_.reset();
+			WAIT_FOR_CYCLES(get_fast_transfer_byte_period().as_int());
+			if(sector_ != command_[6] && !ControlMark()) {
+				sector_++;
+				goto read_next_data;
+			}
+			goto post_st012chrn;
+
 		// Finds the next data block and sets data mode to reading, setting an error flag if the on-disk deleted
 		// flag doesn't match the sort the command was looking for.
 		read_data_found_header:
@@ -36,6 +36,9 @@ class i8272: public Storage::Disk::MFMController {
 		void set_register(int address, uint8_t value);
 		uint8_t get_register(int address);
 
+		/// Enables or disables fast transfer of sectors that decode cleanly, optionally at @c speed_multiplier times the natural rate.
+		using Storage::Disk::MFMController::set_fast_sector_transfer;
+
 		void set_dma_acknowledge(bool dack);
 		void set_terminal_count(bool tc);
 
@@ -115,6 +118,7 @@ class i8272: public Storage::Disk::MFMController {
 
 		// Transient storage and counters used while reading the disk.
 		uint8_t header_[6] = {0, 0, 0, 0, 0, 0};
+		std::shared_ptr<const Storage::Encodings::MFM::Sector> fast_transfer_sector_;
 		int distance_into_section_ = 0;
 		int index_hole_count_ = 0, index_hole_limit_ = 0;
 
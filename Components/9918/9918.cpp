@@ -45,6 +45,52 @@ struct ReverseTable {
 	}
 } reverse_table;
 
+/*!
+	Maps from a byte of planar graphics to eight bytes, each of which is 0 or 1 in correspondence with the
+	relevant bit; the leftmost pixel is stored first in memory. doubled_map does likewise but produces
+	sixteen bytes, with each pixel repeated, for magnified sprites.
+*/
+struct PlanarTable {
+	uint64_t map[256];
+	uint64_t doubled_map[256][2];
+
+	PlanarTable() {
+		for(int c = 0; c < 256; ++c) {
+			uint8_t bytes[16];
+			for(int b = 0; b < 8; ++b) {
+				bytes[b] = static_cast<uint8_t>((c >> (7 - b)) & 1);
+			}
+			memcpy(&map[c], bytes, sizeof(map[c]));
+
+			for(int b = 0; b < 16; ++b) {
+				bytes[b] = static_cast<uint8_t>((c >> (7 - (b >> 1))) & 1);
+			}
+			memcpy(doubled_map[c], bytes, sizeof(doubled_map[c]));
+		}
+	}
+} planar_table;
+
+const uint64_t EveryByte = 0x0101010101010101;
+
+/// @returns the eight four-bit pixels described by the bit planes @c plane0 to @c plane3, one per byte.
+inline uint64_t planar_to_chunky(const uint64_t *const map, uint8_t plane0, uint8_t plane1, uint8_t plane2, uint8_t plane3) {
+	return map[plane0] | (map[plane1] << 1) | (map[plane2] << 2) | (map[plane3] << 3);
+}
+
+/// @returns a mask that is 0xff in every byte of @c pixels with a nonzero low nibble, and 0x00 elsewhere.
+inline uint64_t opaque_mask(uint64_t pixels) {
+	return ((pixels | (pixels >> 1) | (pixels >> 2) | (pixels >> 3)) & EveryByte) * 0xff;
+}
+
+// The fixed sequence output across the horizontal blanking region, in CRT cycles.
+const Outputs::CRT::CRT::Span BlankingSpans[] = {
+	Outputs::CRT::CRT::Span::blank(8*4),
+	Outputs::CRT::CRT::Span::sync(26*4),
+	Outputs::CRT::CRT::Span::blank(2*4),
+	Outputs::CRT::CRT::Span::default_colour_burst(14*4),
+	Outputs::CRT::CRT::Span::blank(8*4),
+};
+
 }
 
 Base::Base(Personality p) :
@@ -89,7 +135,12 @@ TMS9918::TMS9918(Personality p):
 		"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
 		"{"
 			"return texture(sampler, coordinate).rgb / vec3(255.0);"
-		"}");
+		"}",
+		[] (const uint8_t *source, float *rgb) {
+			rgb[0] = static_cast<float>(source[0]) / 255.0f;
+			rgb[1] = static_cast<float>(source[1]) / 255.0f;
+			rgb[2] = static_cast<float>(source[2]) / 255.0f;
+		});
 	crt_->set_video_signal(Outputs::CRT::VideoSignal::RGB);
 	crt_->set_visible_area(Outputs::CRT::Rect(0.055f, 0.025f, 0.9f, 0.9f));
 	crt_->set_input_gamma(2.8f);
@@ -340,11 +391,7 @@ void TMS9918::run_for(const HalfCycles cycles) {
 					// and 58+15 = 73. So output the lot when the
 					// cursor passes 73.
 					if(read_pointer_.column < 73 && end_column >= 73) {
-						crt_->output_blank(8*4);
-						crt_->output_sync(26*4);
-						crt_->output_blank(2*4);
-						crt_->output_default_colour_burst(14*4);
-						crt_->output_blank(8*4);
+						crt_->output_spans(BlankingSpans, sizeof(BlankingSpans) / sizeof(*BlankingSpans));
 					}
 
 					// Border colour for the rest of the line.
@@ -356,11 +403,7 @@ void TMS9918::run_for(const HalfCycles cycles) {
 
 				// Blanking region.
 				if(read_pointer_.column < 73 && end_column >= 73) {
-					crt_->output_blank(8*4);
-					crt_->output_sync(26*4);
-					crt_->output_blank(2*4);
-					crt_->output_default_colour_burst(14*4);
-					crt_->output_blank(8*4);
+					crt_->output_spans(BlankingSpans, sizeof(BlankingSpans) / sizeof(*BlankingSpans));
 				}
 
 				// Left border.
@@ -808,6 +851,12 @@ void Base::draw_tms_text(int start, int end) {
 }
 
 void Base::draw_sms(int start, int end) {
+	// Whole lines can be composed eight pixels at a time.
+	if(!start && end == 256) {
+		draw_sms_line();
+		return;
+	}
+
 	LineBuffer &line_buffer = line_buffers_[read_pointer_.row];
 	int colour_buffer[256];
 
@@ -955,3 +1004,115 @@ void Base::draw_sms(int start, int end) {
 		}
 	}
 }
+
+void Base::draw_sms_line() {
+	LineBuffer &line_buffer = line_buffers_[read_pointer_.row];
+
+	// The colour buffer has space for the final, partial tile when scrolled; the sprite and
+	// collision buffers have space to either side for sprites that are partly offscreen.
+	alignas(8) uint8_t colour_buffer[256 + 8];
+	alignas(8) uint8_t sprite_buffer[8 + 256 + 16];
+	alignas(8) uint8_t collision_buffer[8 + 256 + 16];
+
+	/*
+		Add extra border for any pixels that fall before the fine scroll, then background
+		tiles, eight at a time, with the same encoding as draw_sms.
+	*/
+	int fine_scroll = 0;
+	if(read_pointer_.row >= 16 || !master_system_.horizontal_scroll_lock) {
+		fine_scroll = line_buffer.latched_horizontal_scroll & 7;
+		memset(colour_buffer, 16 + background_colour_, size_t(fine_scroll));
+	}
+
+	for(int column = 0; column < 32; ++column) {
+		const uint8_t *const pattern = line_buffer.patterns[column];
+		const uint8_t flags = line_buffer.names[column].flags;
+		uint64_t pixels;
+		if(flags&2) {
+			pixels = planar_to_chunky(planar_table.map,
+				reverse_table.map[pattern[0]], reverse_table.map[pattern[1]],
+				reverse_table.map[pattern[2]], reverse_table.map[pattern[3]]);
+		} else {
+			pixels = planar_to_chunky(planar_table.map, pattern[0], pattern[1], pattern[2], pattern[3]);
+		}
+		pixels |= uint64_t((flags&0x18) << 1) * EveryByte;
+		memcpy(&colour_buffer[fine_scroll + (column << 3)], &pixels, sizeof(pixels));
+	}
+
+	/*
+		Apply sprites (if any), from lowest priority to highest, using the opaque pixels of
+		each as a mask.
+	*/
+	if(line_buffer.active_sprite_slot) {
+		memset(sprite_buffer, 0, sizeof(sprite_buffer));
+		memset(collision_buffer, 0, sizeof(collision_buffer));
+
+		const int words_per_sprite = sprites_magnified_ ? 2 : 1;
+		for(int index = line_buffer.active_sprite_slot - 1; index >= 0; --index) {
+			LineBuffer::ActiveSprite &sprite = line_buffer.active_sprites[index];
+			sprite.shift_position = 16;
+
+			for(int word = 0; word < words_per_sprite; ++word) {
+				uint64_t colours;
+				if(sprites_magnified_) {
+					colours =
+						planar_table.doubled_map[sprite.image[0]][word] |
+						(planar_table.doubled_map[sprite.image[1]][word] << 1) |
+						(planar_table.doubled_map[sprite.image[2]][word] << 2) |
+						(planar_table.doubled_map[sprite.image[3]][word] << 3);
+				} else {
+					colours = planar_to_chunky(planar_table.map, sprite.image[0], sprite.image[1], sprite.image[2], sprite.image[3]);
+				}
+				const uint64_t opaque = opaque_mask(colours);
+				if(!opaque) continue;
+
+				const size_t offset = size_t(8 + sprite.x + (word << 3));
+				uint64_t existing, collisions;
+				memcpy(&existing, &sprite_buffer[offset], sizeof(existing));
+				memcpy(&collisions, &collision_buffer[offset], sizeof(collisions));
+
+				collisions |= existing & opaque;
+				existing = (existing & ~opaque) | ((colours | (0x10 * EveryByte)) & opaque);
+
+				memcpy(&sprite_buffer[offset], &existing, sizeof(existing));
+				memcpy(&collision_buffer[offset], &collisions, sizeof(collisions));
+			}
+		}
+
+		// Only collisions that occur on screen are reported.
+		uint64_t sprite_collision = 0;
+		for(size_t c = 8; c < 8 + 256; c += 8) {
+			uint64_t collisions;
+			memcpy(&collisions, &collision_buffer[c], sizeof(collisions));
+			sprite_collision |= collisions;
+		}
+		if(sprite_collision)
+			status_ |= StatusSpriteCollision;
+
+		// Draw the sprite buffer onto the colour buffer, wherever the tile map doesn't have
+		// priority (or is transparent).
+		for(size_t c = 0; c < 256; c += 8) {
+			uint64_t tiles, sprites;
+			memcpy(&tiles, &colour_buffer[c], sizeof(tiles));
+			memcpy(&sprites, &sprite_buffer[8 + c], sizeof(sprites));
+
+			const uint64_t sprite_mask = ((sprites >> 4) & EveryByte) * 0xff;
+			const uint64_t priority_mask = ((tiles >> 5) & EveryByte) * 0xff;
+			const uint64_t use_sprite = sprite_mask & ~(priority_mask & opaque_mask(tiles & (0x0f * EveryByte)));
+
+			tiles = (tiles & ~use_sprite) | (sprites & use_sprite);
+			memcpy(&colour_buffer[c], &tiles, sizeof(tiles));
+		}
+	}
+
+	// Map from the 32-colour buffer to real output pixels.
+	for(int c = 0; c < 256; ++c) {
+		pixel_target_[c] = master_system_.colour_ram[colour_buffer[c] & 0x1f];
+	}
+
+	// Hide the left column if the VDP is set to do so.
+	if(master_system_.hide_left_column) {
+		const uint32_t border = master_system_.colour_ram[16 + background_colour_];
+		for(int c = 0; c < 8; ++c) pixel_origin_[c] = border;
+	}
+}
@@ -74,6 +74,14 @@ class TMS9918: public Base {
 		*/
 		HalfCycles get_time_until_interrupt();
 
+		/*!
+			@returns the time until the next sequence point, i.e. the next change in interrupt output, for
+			the benefit of a JustInTimeActor. This is the same as @c get_time_until_interrupt.
+		*/
+		HalfCycles get_next_sequence_point() {
+			return get_time_until_interrupt();
+		}
+
 		/*!
 			@returns @c true if the interrupt line is currently active; @c false otherwise.
 		*/
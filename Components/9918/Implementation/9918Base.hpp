@@ -791,6 +791,7 @@ class Base {
 		void draw_tms_character(int start, int end);
 		void draw_tms_text(int start, int end);
 		void draw_sms(int start, int end);
+		void draw_sms_line();
 };
 
 }
@@ -21,9 +21,9 @@ void append_bool(Configurable::SelectionSet &selection_set, const std::string &n
 	Enquires for a Boolean selection for option @c name from @c selections_by_option, storing it to @c result if found.
 */
 bool get_bool(const Configurable::SelectionSet &selections_by_option, const std::string &name, bool &result) {
-	auto quickload = Configurable::selection<Configurable::BooleanSelection>(selections_by_option, "quickload");
-	if(!quickload) return false;
-	result = quickload->value;
+	auto selection = Configurable::selection<Configurable::BooleanSelection>(selections_by_option, name);
+	if(!selection) return false;
+	result = selection->value;
 	return true;
 }
 
@@ -41,6 +41,7 @@ std::vector<std::unique_ptr<Configurable::Option>> Configurable::standard_option
 		options.emplace_back(new Configurable::ListOption("Display", "display", display_options));
 	}
 	if(mask & AutomaticTapeMotorControl)	options.emplace_back(new Configurable::BooleanOption("Automatic Tape Motor Control", "autotapemotor"));
+	if(mask & QuickLoadDisk)				options.emplace_back(new Configurable::BooleanOption("Load Disks Quickly", "quickdisk"));
 	return options;
 }
 
@@ -53,6 +54,10 @@ void Configurable::append_automatic_tape_motor_control_selection(SelectionSet &s
 	append_bool(selection_set, "autotapemotor", selection);
 }
 
+void Configurable::append_quick_load_disk_selection(SelectionSet &selection_set, bool selection) {
+	append_bool(selection_set, "quickdisk", selection);
+}
+
 void Configurable::append_display_selection(Configurable::SelectionSet &selection_set, Display selection) {
 	std::string string_selection;
 	switch(selection) {
@@ -73,6 +78,10 @@ bool Configurable::get_automatic_tape_motor_control_selection(const SelectionSet
 	return get_bool(selections_by_option, "autotapemotor", result);
 }
 
+bool Configurable::get_quick_load_disk(const SelectionSet &selections_by_option, bool &result) {
+	return get_bool(selections_by_option, "quickdisk", result);
+}
+
 bool Configurable::get_display(const Configurable::SelectionSet &selections_by_option, Configurable::Display &result) {
 	auto display = Configurable::selection<Configurable::ListSelection>(selections_by_option, "display");
 	if(display) {
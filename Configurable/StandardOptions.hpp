@@ -18,7 +18,8 @@ enum StandardOptions {
 	DisplaySVideo				= (1 << 1),
 	DisplayComposite			= (1 << 2),
 	QuickLoadTape				= (1 << 3),
-	AutomaticTapeMotorControl	= (1 << 4)
+	AutomaticTapeMotorControl	= (1 << 4),
+	QuickLoadDisk				= (1 << 5)
 };
 
 enum class Display {
@@ -42,6 +43,11 @@ void append_quick_load_tape_selection(SelectionSet &selection_set, bool selectio
 */
 void append_automatic_tape_motor_control_selection(SelectionSet &selection_set, bool selection);
 
+/*!
+	Appends to @c selection_set a selection of @c selection for QuickLoadDisk.
+*/
+void append_quick_load_disk_selection(SelectionSet &selection_set, bool selection);
+
 /*!
 	Appends to @c selection_set a selection of @c selection for DisplayRGBComposite.
 */
@@ -65,6 +71,15 @@ bool get_quick_load_tape(const SelectionSet &selections_by_option, bool &result)
 */
 bool get_automatic_tape_motor_control_selection(const SelectionSet &selections_by_option, bool &result);
 
+/*!
+	Attempts to discern a QuickLoadDisk selection from @c selections_by_option.
+ 
+	@param selections_by_option The user selections.
+	@param result The location to which the selection will be stored if found.
+	@returns @c true if a selection is found; @c false otherwise.
+*/
+bool get_quick_load_disk(const SelectionSet &selections_by_option, bool &result);
+
 /*!
 	Attempts to discern a display RGB/composite selection from @c selections_by_option.
  
@@ -33,6 +33,8 @@
 
 #include "../../Analyser/Static/AmstradCPC/Target.hpp"
 
+#include "PixelExpansion.hpp"
+
 #include <cstdint>
 #include <vector>
 
@@ -40,7 +42,7 @@ namespace AmstradCPC {
 
 std::vector<std::unique_ptr<Configurable::Option>> get_options() {
 	return Configurable::standard_options(
-		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite)
+		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite | Configurable::QuickLoadDisk)
 	);
 }
 
@@ -174,6 +176,7 @@ class CRTCBusHandler {
 			ram_(ram),
 			interrupt_timer_(interrupt_timer) {
 				establish_palette_hits();
+				establish_pen_tables();
 				build_mode_table();
 			}
 
@@ -211,84 +214,18 @@ class CRTCBusHandler {
 				output_mode = OutputMode::Border;
 			}
 
-			// If a transition between sync/border/pixels just occurred, flush whatever was
-			// in progress to the CRT and reset counting.
-			if(output_mode != previous_output_mode_) {
-				if(cycles_) {
-					switch(previous_output_mode_) {
-						default:
-						case OutputMode::Blank:			crt_->output_blank(cycles_ * 16);					break;
-						case OutputMode::Sync:			crt_->output_sync(cycles_ * 16);					break;
-						case OutputMode::Border:		output_border(cycles_);								break;
-						case OutputMode::ColourBurst:	crt_->output_default_colour_burst(cycles_ * 16);	break;
-						case OutputMode::Pixels:
-							crt_->output_data(cycles_ * 16, cycles_ * 16 / pixel_divider_);
-							pixel_pointer_ = pixel_data_ = nullptr;
-						break;
-					}
-				}
-
-				cycles_ = 0;
-				previous_output_mode_ = output_mode;
-			}
-
-			// increment cycles since state changed
-			cycles_++;
-
-			// collect some more pixels if output is ongoing
-			if(previous_output_mode_ == OutputMode::Pixels) {
-				if(!pixel_data_) {
-					pixel_pointer_ = pixel_data_ = crt_->allocate_write_area(320, 8);
-				}
-				if(pixel_pointer_) {
-					// the CPC shuffles output lines as:
-					//	MA13 MA12	RA2 RA1 RA0		MA9 MA8 MA7 MA6 MA5 MA4 MA3 MA2 MA1 MA0		CCLK
-					// ... so form the real access address.
-					uint16_t address =
-						static_cast<uint16_t>(
-							((state.refresh_address & 0x3ff) << 1) |
-							((state.row_address & 0x7) << 11) |
-							((state.refresh_address & 0x3000) << 2)
-						);
-
-					// fetch two bytes and translate into pixels
-					switch(mode_) {
-						case 0:
-							reinterpret_cast<uint16_t *>(pixel_pointer_)[0] = mode0_output_[ram_[address]];
-							reinterpret_cast<uint16_t *>(pixel_pointer_)[1] = mode0_output_[ram_[address+1]];
-							pixel_pointer_ += 4;
-						break;
-
-						case 1:
-							reinterpret_cast<uint32_t *>(pixel_pointer_)[0] = mode1_output_[ram_[address]];
-							reinterpret_cast<uint32_t *>(pixel_pointer_)[1] = mode1_output_[ram_[address+1]];
-							pixel_pointer_ += 8;
-						break;
-
-						case 2:
-							reinterpret_cast<uint64_t *>(pixel_pointer_)[0] = mode2_output_[ram_[address]];
-							reinterpret_cast<uint64_t *>(pixel_pointer_)[1] = mode2_output_[ram_[address+1]];
-							pixel_pointer_ += 16;
-						break;
-
-						case 3:
-							reinterpret_cast<uint16_t *>(pixel_pointer_)[0] = mode3_output_[ram_[address]];
-							reinterpret_cast<uint16_t *>(pixel_pointer_)[1] = mode3_output_[ram_[address+1]];
-							pixel_pointer_ += 4;
-						break;
-
-					}
+			set_output_mode(output_mode);
+			output_cycles(state, 1);
+		}
 
-					// flush the current buffer pixel if full; the CRTC allows many different display
-					// widths so it's not necessarily possible to predict the correct number in advance
-					// and using the upper bound could lead to inefficient behaviour
-					if(pixel_pointer_ == pixel_data_ + 320) {
-						crt_->output_data(cycles_ * 16, cycles_ * 16 / pixel_divider_);
-						pixel_pointer_ = pixel_data_ = nullptr;
-						cycles_ = 0;
-					}
-				}
-			}
+		/*!
+			The CRTC entry function for a run of cycles in which only the refresh address changes; since hsync
+			is not active throughout, output is either sync, border or pixels for the whole run.
+		*/
+		forceinline void perform_bus_cycle_run(const Motorola::CRTC::BusState &state, int number_of_cycles) {
+			cycles_into_hsync_ = 0;
+			set_output_mode(state.vsync ? OutputMode::Sync : (state.display_enable ? OutputMode::Pixels : OutputMode::Border));
+			output_cycles(state, number_of_cycles);
 		}
 
 		/*!
@@ -326,12 +263,12 @@ class CRTCBusHandler {
 		/// Constructs an appropriate CRT for video output.
 		void setup_output(float aspect_ratio) {
 			crt_.reset(new Outputs::CRT::CRT(1024, 16, Outputs::CRT::DisplayType::PAL50, 1));
-			crt_->set_rgb_sampling_function(
-				"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
-				"{"
-					"uint sample = texture(texID, coordinate).r;"
-					"return vec3(float((sample >> 4) & 3u), float((sample >> 2) & 3u), float(sample & 3u)) / 2.0;"
-				"}");
+			crt_->set_rgb_palette(
+				[] (const uint8_t *source, float *rgb) {
+					rgb[0] = static_cast<float>((source[0] >> 4) & 3) / 2.0f;
+					rgb[1] = static_cast<float>((source[0] >> 2) & 3) / 2.0f;
+					rgb[2] = static_cast<float>(source[0] & 3) / 2.0f;
+				});
 			crt_->set_visible_area(Outputs::CRT::Rect(0.1072f, 0.1f, 0.842105263157895f, 0.842105263157895f));
 			crt_->set_video_signal(Outputs::CRT::VideoSignal::RGB);
 		}
@@ -376,6 +313,125 @@ class CRTCBusHandler {
 		}
 
 	private:
+		enum class OutputMode {
+			Sync,
+			Blank,
+			ColourBurst,
+			Border,
+			Pixels
+		};
+
+		/// If a transition between sync/border/pixels has just occurred, flushes whatever was
+		/// in progress to the CRT and resets counting.
+		forceinline void set_output_mode(OutputMode output_mode) {
+			if(output_mode == previous_output_mode_) return;
+
+			if(cycles_) {
+				switch(previous_output_mode_) {
+					default:
+					case OutputMode::Blank:			crt_->output_blank(cycles_ * 16);					break;
+					case OutputMode::Sync:			crt_->output_sync(cycles_ * 16);					break;
+					case OutputMode::Border:		output_border(cycles_);								break;
+					case OutputMode::ColourBurst:	crt_->output_default_colour_burst(cycles_ * 16);	break;
+					case OutputMode::Pixels:
+						crt_->output_data(cycles_ * 16, cycles_ * 16 / pixel_divider_);
+						pixel_pointer_ = pixel_data_ = nullptr;
+					break;
+				}
+			}
+
+			cycles_ = 0;
+			previous_output_mode_ = output_mode;
+		}
+
+		/// Accounts for @c number_of_cycles cycles in the current output mode, fetching and serialising pixels
+		/// from consecutive refresh addresses beginning with that in @c state if pixels are being output.
+		forceinline void output_cycles(const Motorola::CRTC::BusState &state, int number_of_cycles) {
+			if(previous_output_mode_ != OutputMode::Pixels) {
+				cycles_ += static_cast<unsigned int>(number_of_cycles);
+				return;
+			}
+
+			uint16_t refresh_address = state.refresh_address;
+			while(number_of_cycles) {
+				if(!pixel_data_) {
+					pixel_pointer_ = pixel_data_ = crt_->allocate_write_area(320, 8);
+				}
+				if(!pixel_pointer_) {
+					cycles_ += static_cast<unsigned int>(number_of_cycles);
+					return;
+				}
+
+				// Fetch up to the end of the current buffer; the CRTC allows many different display widths
+				// so it's not necessarily possible to predict the correct number in advance and using the
+				// upper bound could lead to inefficient behaviour.
+				const int bytes_per_cycle = 16 / static_cast<int>(pixel_divider_);
+				const int cycles_to_fetch = std::min(number_of_cycles, static_cast<int>(pixel_data_ + 320 - pixel_pointer_) / bytes_per_cycle);
+				switch(mode_) {
+					case 0:	fetch_pixels(mode0_output_, mode0_pens_, refresh_address, state.row_address, cycles_to_fetch);	break;
+					case 1:	fetch_pixels(mode1_output_, mode1_pens_, refresh_address, state.row_address, cycles_to_fetch);	break;
+					case 2:	fetch_pixels(mode2_output_, mode2_pens_, refresh_address, state.row_address, cycles_to_fetch);	break;
+					case 3:	fetch_pixels(mode3_output_, mode3_pens_, refresh_address, state.row_address, cycles_to_fetch);	break;
+				}
+				refresh_address += cycles_to_fetch;
+				number_of_cycles -= cycles_to_fetch;
+				cycles_ += static_cast<unsigned int>(cycles_to_fetch);
+
+				// Flush the current buffer if full.
+				if(pixel_pointer_ == pixel_data_ + 320) {
+					crt_->output_data(cycles_ * 16, cycles_ * 16 / pixel_divider_);
+					pixel_pointer_ = pixel_data_ = nullptr;
+					cycles_ = 0;
+				}
+			}
+		}
+
+		/// Fetches two bytes per cycle for @c number_of_cycles cycles and translates them into pixels; if vectorised expansion
+		/// is available then whole groups of four cycles are expanded via @c pens, and anything left over is translated via @c table.
+		template <typename PixelType, int PixelsPerByte> forceinline void fetch_pixels(const PixelType *table, const uint8_t (&pens)[PixelsPerByte][2][16], uint16_t refresh_address, uint16_t row_address, int number_of_cycles) {
+			if(use_pixel_expansion_) {
+				while(number_of_cycles >= 4) {
+					// Addresses are contiguous until MA9 carries into MA12.
+					const int run_length = std::min(number_of_cycles, 0x400 - (refresh_address & 0x3ff)) & ~3;
+					if(!run_length) break;
+
+					PixelExpansion::expand(&ram_[fetch_address(refresh_address, row_address)], static_cast<std::size_t>(run_length * 2), pens, palette_, pixel_pointer_);
+					pixel_pointer_ += run_length * 2 * PixelsPerByte;
+					refresh_address += run_length;
+					number_of_cycles -= run_length;
+				}
+			}
+
+			fetch_pixels(table, refresh_address, row_address, number_of_cycles);
+		}
+
+		/// Fetches two bytes per cycle for @c number_of_cycles cycles and translates them into pixels via @c table.
+		template <typename PixelType> forceinline void fetch_pixels(const PixelType *table, uint16_t refresh_address, uint16_t row_address, int number_of_cycles) {
+			PixelType *target = reinterpret_cast<PixelType *>(pixel_pointer_);
+			while(number_of_cycles--) {
+				const uint16_t address = fetch_address(refresh_address, row_address);
+				++refresh_address;
+
+				target[0] = table[ram_[address]];
+				target[1] = table[ram_[address+1]];
+				target += 2;
+			}
+			pixel_pointer_ = reinterpret_cast<uint8_t *>(target);
+		}
+
+		/// @returns the address of the first of the two bytes fetched for @c refresh_address and @c row_address.
+		static forceinline uint16_t fetch_address(uint16_t refresh_address, uint16_t row_address) {
+			// the CPC shuffles output lines as:
+			//	MA13 MA12	RA2 RA1 RA0		MA9 MA8 MA7 MA6 MA5 MA4 MA3 MA2 MA1 MA0		CCLK
+			// ... so form the real access address.
+			return
+				static_cast<uint16_t>(
+					((refresh_address & 0x3ff) << 1) |
+					((row_address & 0x7) << 11) |
+					((refresh_address & 0x3000) << 2)
+				);
+		}
+
 		void output_border(unsigned int length) {
 			uint8_t *colour_pointer = static_cast<uint8_t *>(crt_->allocate_write_area(1));
 			if(colour_pointer) *colour_pointer = border_;
@@ -408,6 +464,31 @@ class CRTCBusHandler {
 			}
 		}
 
+		/// Decomposes @c colour, which maps a byte to the pen of one of its pixels, into separate contributions from each nibble.
+		template <typename Function> static void establish_pen_table(uint8_t (&pens)[2][16], Function colour) {
+			for(int c = 0; c < 16; c++) {
+				pens[0][c] = static_cast<uint8_t>(colour(c << 4));
+				pens[1][c] = static_cast<uint8_t>(colour(c));
+			}
+		}
+
+		void establish_pen_tables() {
+			establish_pen_table(mode0_pens_[0], [] (int c) { return Mode0Colour0(c); });
+			establish_pen_table(mode0_pens_[1], [] (int c) { return Mode0Colour1(c); });
+
+			establish_pen_table(mode1_pens_[0], [] (int c) { return Mode1Colour0(c); });
+			establish_pen_table(mode1_pens_[1], [] (int c) { return Mode1Colour1(c); });
+			establish_pen_table(mode1_pens_[2], [] (int c) { return Mode1Colour2(c); });
+			establish_pen_table(mode1_pens_[3], [] (int c) { return Mode1Colour3(c); });
+
+			for(int pixel = 0; pixel < 8; pixel++) {
+				establish_pen_table(mode2_pens_[pixel], [pixel] (int c) { return (c >> (7 - pixel)) & 1; });
+			}
+
+			establish_pen_table(mode3_pens_[0], [] (int c) { return Mode3Colour0(c); });
+			establish_pen_table(mode3_pens_[1], [] (int c) { return Mode3Colour1(c); });
+		}
+
 		void build_mode_table() {
 			switch(mode_) {
 				case 0:
@@ -521,13 +602,7 @@ class CRTCBusHandler {
 			return mapping[colour];
 		}
 
-		enum class OutputMode {
-			Sync,
-			Blank,
-			ColourBurst,
-			Border,
-			Pixels
-		} previous_output_mode_ = OutputMode::Sync;
+		OutputMode previous_output_mode_ = OutputMode::Sync;
 		unsigned int cycles_ = 0;
 
 		bool was_hsync_ = false, was_vsync_ = false;
@@ -550,6 +625,13 @@ class CRTCBusHandler {
 		std::vector<uint8_t> mode1_palette_hits_[4];
 		std::vector<uint8_t> mode3_palette_hits_[4];
 
+		// Per-pixel pen contributions of each byte's high and low nibbles, for the vectorised fetch if this processor supports it.
+		const bool use_pixel_expansion_ = PixelExpansion::is_available();
+		uint8_t mode0_pens_[2][2][16];
+		uint8_t mode1_pens_[4][2][16];
+		uint8_t mode2_pens_[8][2][16];
+		uint8_t mode3_pens_[2][2][16];
+
 		int pen_ = 0;
 		uint8_t palette_[16];
 		uint8_t border_ = 0;
@@ -846,30 +928,17 @@ template <bool has_fdc> class ConcreteMachine:
 			clock_offset_ = (clock_offset_ + cycle.length) & HalfCycles(7);
 			z80_.set_wait_line(clock_offset_ >= HalfCycles(2));
 
-			// Update the CRTC once every eight half cycles; aiming for half-cycle 4 as
-			// per the initial seed to the crtc_counter_, but any time in the final four
-			// will do as it's safe to conclude that nobody else has touched video RAM
-			// during that whole window
+			// Accumulate time for the CRTC, which is run only once it might have signalled the
+			// interrupt timer, or when the CPU is about to interact with it or with video RAM.
 			crtc_counter_ += cycle.length;
-			Cycles crtc_cycles = crtc_counter_.divide_cycles(Cycles(4));
-			if(crtc_cycles > Cycles(0)) crtc_.run_for(crtc_cycles);
-
-			// Check whether that prompted a change in the interrupt line. If so then date
-			// it to whenever the cycle was triggered.
-			if(interrupt_timer_.request_has_changed()) z80_.set_interrupt_line(interrupt_timer_.get_request(), -crtc_counter_);
-
-			// TODO (in the player, not here): adapt it to accept an input clock rate and
-			// run_for as HalfCycles
-			if(!tape_player_is_sleeping_) tape_player_.run_for(cycle.length.as_int());
+			if(crtc_counter_ >= crtc_horizon_) update_crtc();
 
-			// Pump the AY
+			// Accumulate time for the AY, FDC, tape and typer; each is brought up to date only when
+			// the CPU is about to observe or alter its state, or upon a flush.
 			ay_.run_for(cycle.length);
-
-			// Clock the FDC, if connected, using a lazy scale by two
 			time_since_fdc_update_ += cycle.length;
-
-			// Update typing activity
-			if(typer_) typer_->run_for(cycle.length);
+			time_since_tape_update_ += cycle.length;
+			time_since_typer_update_ += cycle.length;
 
 			// Stop now if no action is strictly required.
 			if(!cycle.is_terminal()) return HalfCycles(0);
@@ -882,10 +951,13 @@ template <bool has_fdc> class ConcreteMachine:
 				break;
 
 				case CPU::Z80::PartialMachineCycle::Write:
+					update_crtc();
 					write_pointers_[address >> 14][address & 16383] = *cycle.value;
 				break;
 
 				case CPU::Z80::PartialMachineCycle::Output:
+					update_crtc();
+
 					// Check for a gate array access.
 					if((address & 0xc000) == 0x4000) {
 						write_to_gate_array(*cycle.value);
@@ -908,6 +980,8 @@ template <bool has_fdc> class ConcreteMachine:
 
 					// Check for an 8255 PIO access
 					if(!(address & 0x800)) {
+						update_tape();
+						update_typer();
 						i8255_.set_register((address >> 8) & 3, *cycle.value);
 					}
 
@@ -922,13 +996,20 @@ template <bool has_fdc> class ConcreteMachine:
 						flush_fdc();
 						fdc_.set_motor_on(!!(*cycle.value));
 					}
+
+					// Catch any change in CRTC programming or interrupt state.
+					update_crtc();
 				break;
 				case CPU::Z80::PartialMachineCycle::Input:
+					update_crtc();
+
 					// Default to nothing answering
 					*cycle.value = 0xff;
 
 					// Check for a PIO access
 					if(!(address & 0x800)) {
+						update_tape();
+						update_typer();
 						*cycle.value &= i8255_.get_register((address >> 8) & 3);
 					}
 
@@ -954,13 +1035,17 @@ template <bool has_fdc> class ConcreteMachine:
 					if((address & 0xc000) == 0x4000) {
 						write_to_gate_array(*cycle.value);
 					}
+
+					update_crtc();
 				break;
 
 				case CPU::Z80::PartialMachineCycle::Interrupt:
 					// Nothing is loaded onto the bus during an interrupt acknowledge, but
 					// the fact of the acknowledge needs to be posted on to the interrupt timer.
+					update_crtc();
 					*cycle.value = 0xff;
 					interrupt_timer_.signal_interrupt_acknowledge();
+					update_crtc();
 				break;
 
 				default: break;
@@ -975,10 +1060,13 @@ template <bool has_fdc> class ConcreteMachine:
 
 		/// Another Z80 entry point; indicates that a partcular run request has concluded.
 		void flush() {
-			// Just flush the AY.
+			// Bring video up to date, flush the AY and catch up on all other deferred activity.
+			update_crtc();
 			ay_.update();
 			ay_.flush();
 			flush_fdc();
+			update_tape();
+			update_typer();
 		}
 
 		/// A CRTMachine function; indicates that outputs should be created now.
@@ -1009,6 +1097,7 @@ template <bool has_fdc> class ConcreteMachine:
 		bool insert_media(const Analyser::Static::Media &media) override final {
 			// If there are any tapes supplied, use the first of them.
 			if(!media.tapes.empty()) {
+				update_tape();
 				tape_player_.set_tape(media.tapes.front());
 			}
 
@@ -1030,6 +1119,9 @@ template <bool has_fdc> class ConcreteMachine:
 
 		// MARK: - Keyboard
 		void type_string(const std::string &string) override final {
+			// Time that passed before this typer existed doesn't count towards it.
+			update_typer();
+
 			std::unique_ptr<CharacterMapper> mapper(new CharacterMapper());
 			Utility::TypeRecipient::add_typer(string, std::move(mapper));
 		}
@@ -1071,17 +1163,24 @@ template <bool has_fdc> class ConcreteMachine:
 			if(Configurable::get_display(selections_by_option, display)) {
 				set_video_signal_configurable(display);
 			}
+
+			bool quickdisk;
+			if(has_fdc && Configurable::get_quick_load_disk(selections_by_option, quickdisk)) {
+				fdc_.set_fast_sector_transfer(quickdisk);
+			}
 		}
 
 		Configurable::SelectionSet get_accurate_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_display_selection(selection_set, Configurable::Display::RGB);
+			Configurable::append_quick_load_disk_selection(selection_set, false);
 			return selection_set;
 		}
 
 		Configurable::SelectionSet get_user_friendly_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_display_selection(selection_set, Configurable::Display::RGB);
+			Configurable::append_quick_load_disk_selection(selection_set, true);
 			return selection_set;
 		}
 
@@ -1157,9 +1256,36 @@ template <bool has_fdc> class ConcreteMachine:
 
 		InterruptTimer interrupt_timer_;
 		Storage::Tape::BinaryTapePlayer tape_player_;
+		HalfCycles time_since_tape_update_;
+		void update_tape() {
+			// TODO (in the player, not here): adapt it to accept an input clock rate and
+			// run_for as HalfCycles
+			const HalfCycles time = time_since_tape_update_.flush();
+			if(!tape_player_is_sleeping_) tape_player_.run_for(time.as_int());
+		}
+
+		HalfCycles time_since_typer_update_;
+		void update_typer() {
+			const HalfCycles time = time_since_typer_update_.flush();
+			if(typer_) typer_->run_for(time);
+		}
 
 		HalfCycles clock_offset_;
-		HalfCycles crtc_counter_;
+		HalfCycles crtc_counter_, crtc_horizon_;
+
+		/// Runs the CRTC up to now, notes how long it can next go unobserved and posts any change in the interrupt line.
+		forceinline void update_crtc() {
+			const Cycles crtc_cycles = crtc_counter_.divide_cycles(Cycles(4));
+			if(crtc_cycles > Cycles(0)) crtc_.run_for(crtc_cycles);
+
+			// The CRTC can next affect the interrupt timer only in the cycle after those for
+			// which sync is known to be stable.
+			crtc_horizon_ = HalfCycles((crtc_.get_cycles_until_sync_change() + 1) * 4);
+
+			// Check whether that prompted a change in the interrupt line. If so then date
+			// it to whenever the cycle was triggered.
+			if(interrupt_timer_.request_has_changed()) z80_.set_interrupt_line(interrupt_timer_.get_request(), -crtc_counter_);
+		}
 		HalfCycles half_cycles_since_ay_update_;
 
 		uint8_t ram_[128 * 1024];
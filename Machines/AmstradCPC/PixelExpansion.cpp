@@ -0,0 +1,120 @@
+//
+//  PixelExpansion.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 19/10/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "PixelExpansion.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_SSSE3_EXPANSION
+#include <tmmintrin.h>
+#endif
+
+#ifdef HAS_SSSE3_EXPANSION
+
+// Everything below is compiled for SSSE3 regardless of the target otherwise selected, and is reached only after
+// the check in is_available.
+#define ssse3 __attribute__((target("ssse3")))
+#define ssse3_inline __attribute__((always_inline, target("ssse3"))) inline
+
+namespace {
+
+/// Interleaves the first and second pixels of each of sixteen bytes.
+ssse3_inline void interleave(const __m128i (&colours)[2], __m128i *pixels) {
+	pixels[0] = _mm_unpacklo_epi8(colours[0], colours[1]);
+	pixels[1] = _mm_unpackhi_epi8(colours[0], colours[1]);
+}
+
+ssse3_inline void interleave_quads(const __m128i *colours, __m128i *pixels) {
+	const __m128i pairs[2] = {_mm_unpacklo_epi8(colours[0], colours[1]), _mm_unpackhi_epi8(colours[0], colours[1])};
+	const __m128i next_pairs[2] = {_mm_unpacklo_epi8(colours[2], colours[3]), _mm_unpackhi_epi8(colours[2], colours[3])};
+	for(int c = 0; c < 2; ++c) {
+		pixels[c*2 + 0] = _mm_unpacklo_epi16(pairs[c], next_pairs[c]);
+		pixels[c*2 + 1] = _mm_unpackhi_epi16(pairs[c], next_pairs[c]);
+	}
+}
+
+/// Interleaves the four pixels of each of sixteen bytes.
+ssse3_inline void interleave(const __m128i (&colours)[4], __m128i *pixels) {
+	interleave_quads(colours, pixels);
+}
+
+/// Interleaves the eight pixels of each of sixteen bytes.
+ssse3_inline void interleave(const __m128i (&colours)[8], __m128i *pixels) {
+	__m128i low_quads[4], high_quads[4];
+	interleave_quads(&colours[0], low_quads);
+	interleave_quads(&colours[4], high_quads);
+	for(int c = 0; c < 4; ++c) {
+		pixels[c*2 + 0] = _mm_unpacklo_epi32(low_quads[c], high_quads[c]);
+		pixels[c*2 + 1] = _mm_unpackhi_epi32(low_quads[c], high_quads[c]);
+	}
+}
+
+/// Expands each byte of @c bytes into @c PixelsPerByte pixels, writing them in order to @c pixels.
+template <int PixelsPerByte> ssse3_inline void expand_bytes(__m128i bytes, const uint8_t (&pens)[PixelsPerByte][2][16], __m128i palette, __m128i *pixels) {
+	const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+	const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask);
+	const __m128i low = _mm_and_si128(bytes, nibble_mask);
+
+	__m128i colours[PixelsPerByte];
+	for(int c = 0; c < PixelsPerByte; ++c) {
+		const __m128i pen = _mm_or_si128(
+			_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pens[c][0])), high),
+			_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pens[c][1])), low));
+		colours[c] = _mm_shuffle_epi8(palette, pen);
+	}
+	interleave(colours, pixels);
+}
+
+template <int PixelsPerByte> ssse3 void expand_ssse3(const uint8_t *source, std::size_t length, const uint8_t (&pens)[PixelsPerByte][2][16], const uint8_t *palette, uint8_t *target) {
+	const __m128i palette_vector = _mm_loadu_si128(reinterpret_cast<const __m128i *>(palette));
+	__m128i pixels[PixelsPerByte];
+	__m128i *target_vector = reinterpret_cast<__m128i *>(target);
+
+	for(; length >= 16; length -= 16) {
+		expand_bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source)), pens, palette_vector, pixels);
+		for(int c = 0; c < PixelsPerByte; ++c) _mm_storeu_si128(&target_vector[c], pixels[c]);
+		source += 16;
+		target_vector += PixelsPerByte;
+	}
+	if(length) {
+		expand_bytes(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(source)), pens, palette_vector, pixels);
+		for(int c = 0; c < PixelsPerByte / 2; ++c) _mm_storeu_si128(&target_vector[c], pixels[c]);
+	}
+}
+
+}
+
+bool AmstradCPC::PixelExpansion::is_available() {
+	static const bool supports_ssse3 = __builtin_cpu_supports("ssse3");
+	return supports_ssse3;
+}
+
+template <int PixelsPerByte> void AmstradCPC::PixelExpansion::expand(const uint8_t *source, std::size_t length, const uint8_t (&pens)[PixelsPerByte][2][16], const uint8_t *palette, uint8_t *target) {
+	expand_ssse3(source, length, pens, palette, target);
+}
+
+#else
+
+bool AmstradCPC::PixelExpansion::is_available() {
+	return false;
+}
+
+template <int PixelsPerByte> void AmstradCPC::PixelExpansion::expand(const uint8_t *source, std::size_t length, const uint8_t (&pens)[PixelsPerByte][2][16], const uint8_t *palette, uint8_t *target) {
+	// Never used in practice, but provided for completeness.
+	while(length--) {
+		const uint8_t byte = *source++;
+		for(int c = 0; c < PixelsPerByte; ++c) {
+			*target++ = palette[pens[c][0][byte >> 4] | pens[c][1][byte & 0xf]];
+		}
+	}
+}
+
+#endif
+
+template void AmstradCPC::PixelExpansion::expand<2>(const uint8_t *, std::size_t, const uint8_t (&)[2][2][16], const uint8_t *, uint8_t *);
+template void AmstradCPC::PixelExpansion::expand<4>(const uint8_t *, std::size_t, const uint8_t (&)[4][2][16], const uint8_t *, uint8_t *);
+template void AmstradCPC::PixelExpansion::expand<8>(const uint8_t *, std::size_t, const uint8_t (&)[8][2][16], const uint8_t *, uint8_t *);
@@ -0,0 +1,36 @@
+//
+//  PixelExpansion.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 19/10/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef AmstradCPC_PixelExpansion_hpp
+#define AmstradCPC_PixelExpansion_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AmstradCPC {
+namespace PixelExpansion {
+
+/*!
+	@returns @c true if this processor supports the vectorised expansion provided by @c expand; @c false otherwise.
+	The test is performed at runtime, so the vectorised path is available regardless of compiler flags.
+*/
+bool is_available();
+
+/*!
+	Expands each of the @c length bytes at @c source into @c PixelsPerByte one-byte pixels, writing them in order to
+	@c target. The pen for each pixel is the OR of its entries in @c pens for the byte's high and low nibbles, which
+	is then mapped through the sixteen-entry @c palette.
+
+	@c length must be a multiple of eight, and this may be called only if @c is_available().
+*/
+template <int PixelsPerByte> void expand(const uint8_t *source, std::size_t length, const uint8_t (&pens)[PixelsPerByte][2][16], const uint8_t *palette, uint8_t *target);
+
+}
+}
+
+#endif /* AmstradCPC_PixelExpansion_hpp */
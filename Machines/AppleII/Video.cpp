@@ -8,8 +8,53 @@
 
 #include "Video.hpp"
 
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace AppleII::Video;
 
+namespace {
+
+/*!
+	Maps from source bytes to complete 14-sample output windows, using the same sample
+	values as would be produced by shifting each byte out bit by bit.
+*/
+struct ExpansionTables {
+	/// Maps from a high-resolution byte to its 14 samples. If the delay bit is set then the
+	/// first sample is left as zero; it should be replaced with the graphics carry.
+	uint8_t high_resolution[256][14];
+
+	/// Maps from the low seven bits of an auxiliary byte, at index 0, or a main byte, at index 1,
+	/// to that byte's share of a double-high-resolution window. The two can be ORd together.
+	alignas(16) uint8_t double_high_resolution[2][128][16];
+
+	ExpansionTables() {
+		memset(this, 0, sizeof(*this));
+
+		for(int c = 0; c < 256; ++c) {
+			const int delay = (c & 0x80) ? 1 : 0;
+			for(int bit = 0; bit < 7; ++bit) {
+				high_resolution[c][delay + bit*2] = static_cast<uint8_t>(c & (1 << bit));
+				if(delay + bit*2 + 1 < 14) {
+					high_resolution[c][delay + bit*2 + 1] = static_cast<uint8_t>(c & (1 << bit));
+				}
+			}
+		}
+
+		for(int c = 0; c < 128; ++c) {
+			for(int bit = 0; bit < 7; ++bit) {
+				double_high_resolution[0][c][bit] =
+				double_high_resolution[1][c][7 + bit] = static_cast<uint8_t>(c & (1 << bit));
+			}
+		}
+	}
+} expansion_tables;
+
+}
+
 VideoBase::VideoBase(bool is_iie, std::function<void(Cycles)> &&target) :
 	crt_(new Outputs::CRT::CRT(910, 1, Outputs::CRT::DisplayType::NTSC60, 1)),
 	is_iie_(is_iie),
@@ -21,7 +66,10 @@ VideoBase::VideoBase(bool is_iie, std::function<void(Cycles)> &&target) :
 		"float composite_sample(usampler2D sampler, vec2 coordinate, float phase, float amplitude)"
 		"{"
 			"return clamp(texture(sampler, coordinate).r, 0.0, 0.66);"
-		"}");
+		"}",
+		[] (const uint8_t *source, float phase, float amplitude) {
+			return source[0] ? 0.66f : 0.0f;
+		});
 
 	// Show only the centre 75% of the TV frame.
 	crt_->set_video_signal(Outputs::CRT::VideoSignal::Composite);
@@ -293,47 +341,68 @@ void VideoBase::output_high_resolution(uint8_t *target, const uint8_t *const sou
 		// If there is a delay, the previous output level is held to bridge the gap.
 		// Delays may be ignored on a IIe if Annunciator 3 is set; that's the state that
 		// high_resolution_mask_ models.
-		if(source[c] & high_resolution_mask_ & 0x80) {
-			target[0] = graphics_carry_;
-			target[1] = target[2] = source[c] & 0x01;
-			target[3] = target[4] = source[c] & 0x02;
-			target[5] = target[6] = source[c] & 0x04;
-			target[7] = target[8] = source[c] & 0x08;
-			target[9] = target[10] = source[c] & 0x10;
-			target[11] = target[12] = source[c] & 0x20;
-			target[13] = source[c] & 0x40;
-		} else {
-			target[0] = target[1] = source[c] & 0x01;
-			target[2] = target[3] = source[c] & 0x02;
-			target[4] = target[5] = source[c] & 0x04;
-			target[6] = target[7] = source[c] & 0x08;
-			target[8] = target[9] = source[c] & 0x10;
-			target[10] = target[11] = source[c] & 0x20;
-			target[12] = target[13] = source[c] & 0x40;
-		}
+		const uint8_t value = source[c] & high_resolution_mask_;
+		memcpy(target, expansion_tables.high_resolution[value], 14);
+		if(value & 0x80) target[0] = graphics_carry_;
+
 		graphics_carry_ = source[c] & 0x40;
 		target += 14;
 	}
 }
 
 void VideoBase::output_double_high_resolution(uint8_t *target, const uint8_t *const source, const uint8_t *const auxiliary_source, size_t length) const {
-	for(size_t c = 0; c < length; ++c) {
-		target[0] = auxiliary_source[c] & 0x01;
-		target[1] = auxiliary_source[c] & 0x02;
-		target[2] = auxiliary_source[c] & 0x04;
-		target[3] = auxiliary_source[c] & 0x08;
-		target[4] = auxiliary_source[c] & 0x10;
-		target[5] = auxiliary_source[c] & 0x20;
-		target[6] = auxiliary_source[c] & 0x40;
-		target[7] = source[c] & 0x01;
-		target[8] = source[c] & 0x02;
-		target[9] = source[c] & 0x04;
-		target[10] = source[c] & 0x08;
-		target[11] = source[c] & 0x10;
-		target[12] = source[c] & 0x20;
-		target[13] = source[c] & 0x40;
-
-		graphics_carry_ = auxiliary_source[c] & 0x40;
+	if(!length) return;
+
+	// Each window is composed as sixteen bytes, of which the final two are zero; output
+	// all but the final window sixteen bytes at a time, with each window's excess being
+	// overwritten by the next.
+	for(size_t c = 0; c < length - 1; ++c) {
+		const uint8_t *const auxiliary = expansion_tables.double_high_resolution[0][auxiliary_source[c] & 0x7f];
+		const uint8_t *const base = expansion_tables.double_high_resolution[1][source[c] & 0x7f];
+#if defined(__SSE2__)
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i *>(target),
+			_mm_or_si128(
+				_mm_load_si128(reinterpret_cast<const __m128i *>(auxiliary)),
+				_mm_load_si128(reinterpret_cast<const __m128i *>(base))
+			)
+		);
+#else
+		uint64_t halves[2][2];
+		memcpy(halves[0], auxiliary, 16);
+		memcpy(halves[1], base, 16);
+		halves[0][0] |= halves[1][0];
+		halves[0][1] |= halves[1][1];
+		memcpy(target, halves[0], 16);
+#endif
 		target += 14;
 	}
+
+	// The final window is output exactly, so as not to write beyond it.
+	const uint8_t *const auxiliary = expansion_tables.double_high_resolution[0][auxiliary_source[length - 1] & 0x7f];
+	const uint8_t *const base = expansion_tables.double_high_resolution[1][source[length - 1] & 0x7f];
+	memcpy(target, auxiliary, 7);
+	memcpy(&target[7], &base[7], 7);
+
+	graphics_carry_ = auxiliary_source[length - 1] & 0x40;
+}
+
+void VideoBase::make_line_key(LineKey &key, GraphicsMode mode, int pixel_row) const {
+	// Record all state that affects pixel generation other than the source bytes.
+	key[0] = static_cast<uint8_t>(mode);
+	key[1] = static_cast<uint8_t>(pixel_row);
+	key[2] = high_resolution_mask_;
+	for(size_t c = 0; c < 4; ++c) {
+		key[3 + c*2] = character_zones[c].address_mask;
+		key[4 + c*2] = character_zones[c].xor_mask;
+	}
+
+	// Then the source bytes; the auxiliary stream is relevant only in double modes.
+	const size_t stream_start = key.size() - 80;
+	memcpy(&key[stream_start], base_stream_.data(), 40);
+	if(is_double_mode(mode)) {
+		memcpy(&key[stream_start + 40], auxiliary_stream_.data(), 40);
+	} else {
+		memset(&key[stream_start + 40], 0, 40);
+	}
 }
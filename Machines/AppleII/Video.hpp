@@ -14,6 +14,7 @@
 #include "../../ClockReceiver/ClockDeferrer.hpp"
 
 #include <array>
+#include <cstring>
 #include <vector>
 
 namespace AppleII {
@@ -167,8 +168,8 @@ class VideoBase {
 			DoubleLowRes,
 			FatLowRes
 		};
-		bool is_text_mode(GraphicsMode m) { return m <= GraphicsMode::DoubleText; }
-		bool is_double_mode(GraphicsMode m) { return !!(static_cast<int>(m)&1); }
+		bool is_text_mode(GraphicsMode m) const { return m <= GraphicsMode::DoubleText; }
+		bool is_double_mode(GraphicsMode m) const { return !!(static_cast<int>(m)&1); }
 
 		// Various soft-switch values.
 		bool alternative_character_set_ = false, set_alternative_character_set_ = false;
@@ -247,6 +248,30 @@ class VideoBase {
 		*/
 		void output_fat_low_resolution(uint8_t *target, const uint8_t *source, size_t length, int column, int row) const;
 
+		/*!
+			Describes everything that contributes to a line of pixels: the source bytes, the
+			graphics mode and the other state that affects the appearance of that mode.
+		*/
+		typedef std::array<uint8_t, 11 + 80> LineKey;
+
+		/*!
+			Populates @c key to describe a line in @c mode with pixel row @c pixel_row, given the current
+			contents of the base and auxiliary streams.
+		*/
+		void make_line_key(LineKey &key, GraphicsMode mode, int pixel_row) const;
+
+		// Retains the output of each line that was output in full, alongside the key that
+		// produced it, so that a line that hasn't changed since the previous frame can be
+		// copied rather than regenerated.
+		struct CachedLine {
+			LineKey key;
+			std::array<uint8_t, 568> pixels;
+			uint8_t graphics_carry = 0;
+			bool is_valid = false;
+		};
+		std::vector<CachedLine> line_cache_ = std::vector<CachedLine>(192);
+		bool line_is_cached_ = false, line_should_be_cached_ = false;
+
 		// Maintain a ClockDeferrer for delayed mode switches.
 		ClockDeferrer<Cycles> deferrer_;
 };
@@ -405,6 +430,25 @@ template <class BusHandler, bool is_iie> class Video: public VideoBase {
 							pixel_pointer_ = crt_->allocate_write_area(568);
 							graphics_carry_ = 0;
 							was_double_ = true;
+
+							// If this line will be output in one go then compare it to its predecessor
+							// from the last frame and, if it's unchanged, just copy that.
+							line_is_cached_ = line_should_be_cached_ = false;
+							if(pixel_pointer_ && ending_column >= 40) {
+								CachedLine &cached_line = line_cache_[static_cast<size_t>(row_)];
+								LineKey key;
+								make_line_key(key, line_mode, row_ & 7);
+
+								if(cached_line.is_valid && cached_line.key == key) {
+									memcpy(pixel_pointer_, cached_line.pixels.data(), cached_line.pixels.size());
+									graphics_carry_ = cached_line.graphics_carry;
+									line_is_cached_ = true;
+								} else {
+									cached_line.key = key;
+									line_should_be_cached_ = true;
+								}
+								cached_line.is_valid = false;
+							}
 						}
 
 						if(column_ < 40) {
@@ -413,90 +457,104 @@ template <class BusHandler, bool is_iie> class Video: public VideoBase {
 							const int pixel_row = row_ & 7;
 
 							const bool is_double = Video::is_double_mode(line_mode);
-							if(!is_double && was_double_) {
-								pixel_pointer_[pixel_start*14 + 0] =
-								pixel_pointer_[pixel_start*14 + 1] =
-								pixel_pointer_[pixel_start*14 + 2] =
-								pixel_pointer_[pixel_start*14 + 3] =
-								pixel_pointer_[pixel_start*14 + 4] =
-								pixel_pointer_[pixel_start*14 + 5] =
-								pixel_pointer_[pixel_start*14 + 6] = 0;
-							}
-							was_double_ = is_double;
+							// A write area may be unavailable, e.g. if the CRT is discarding this field; if so then skip pixel generation.
+							if(pixel_pointer_ && !line_is_cached_) {
+								if(!is_double && was_double_) {
+									pixel_pointer_[pixel_start*14 + 0] =
+									pixel_pointer_[pixel_start*14 + 1] =
+									pixel_pointer_[pixel_start*14 + 2] =
+									pixel_pointer_[pixel_start*14 + 3] =
+									pixel_pointer_[pixel_start*14 + 4] =
+									pixel_pointer_[pixel_start*14 + 5] =
+									pixel_pointer_[pixel_start*14 + 6] = 0;
+								}
 
-							switch(line_mode) {
-								case GraphicsMode::Text:
-									output_text(
-										&pixel_pointer_[pixel_start * 14 + 7],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start),
-										static_cast<size_t>(pixel_row));
-								break;
-
-								case GraphicsMode::DoubleText:
-									output_double_text(
-										&pixel_pointer_[pixel_start * 14],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										&auxiliary_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start),
-										static_cast<size_t>(pixel_row));
-								break;
-
-								case GraphicsMode::LowRes:
-									output_low_resolution(
-										&pixel_pointer_[pixel_start * 14 + 7],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start),
-										pixel_start,
-										pixel_row);
-								break;
-
-								case GraphicsMode::FatLowRes:
-									output_fat_low_resolution(
-										&pixel_pointer_[pixel_start * 14 + 7],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start),
-										pixel_start,
-										pixel_row);
-								break;
-
-								case GraphicsMode::DoubleLowRes:
-									output_double_low_resolution(
-										&pixel_pointer_[pixel_start * 14],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										&auxiliary_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start),
-										pixel_start,
-										pixel_row);
-								break;
-
-								case GraphicsMode::HighRes:
-									output_high_resolution(
-										&pixel_pointer_[pixel_start * 14 + 7],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start));
-								break;
-
-								case GraphicsMode::DoubleHighRes:
-									output_double_high_resolution(
-										&pixel_pointer_[pixel_start * 14],
-										&base_stream_[static_cast<size_t>(pixel_start)],
-										&auxiliary_stream_[static_cast<size_t>(pixel_start)],
-										static_cast<size_t>(pixel_end - pixel_start));
-								break;
-
-								default: break;
+								switch(line_mode) {
+									case GraphicsMode::Text:
+										output_text(
+											&pixel_pointer_[pixel_start * 14 + 7],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start),
+											static_cast<size_t>(pixel_row));
+									break;
+
+									case GraphicsMode::DoubleText:
+										output_double_text(
+											&pixel_pointer_[pixel_start * 14],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											&auxiliary_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start),
+											static_cast<size_t>(pixel_row));
+									break;
+
+									case GraphicsMode::LowRes:
+										output_low_resolution(
+											&pixel_pointer_[pixel_start * 14 + 7],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start),
+											pixel_start,
+											pixel_row);
+									break;
+
+									case GraphicsMode::FatLowRes:
+										output_fat_low_resolution(
+											&pixel_pointer_[pixel_start * 14 + 7],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start),
+											pixel_start,
+											pixel_row);
+									break;
+
+									case GraphicsMode::DoubleLowRes:
+										output_double_low_resolution(
+											&pixel_pointer_[pixel_start * 14],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											&auxiliary_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start),
+											pixel_start,
+											pixel_row);
+									break;
+
+									case GraphicsMode::HighRes:
+										output_high_resolution(
+											&pixel_pointer_[pixel_start * 14 + 7],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start));
+									break;
+
+									case GraphicsMode::DoubleHighRes:
+										output_double_high_resolution(
+											&pixel_pointer_[pixel_start * 14],
+											&base_stream_[static_cast<size_t>(pixel_start)],
+											&auxiliary_stream_[static_cast<size_t>(pixel_start)],
+											static_cast<size_t>(pixel_end - pixel_start));
+									break;
+
+									default: break;
+								}
 							}
+							was_double_ = is_double;
 
 							if(pixel_end == 40) {
-								if(was_double_) {
-									pixel_pointer_[560] = pixel_pointer_[561] = pixel_pointer_[562] = pixel_pointer_[563] =
-									pixel_pointer_[564] = pixel_pointer_[565] = pixel_pointer_[566] = pixel_pointer_[567] = 0;
-								} else {
-									if(line_mode == GraphicsMode::HighRes && base_stream_[39]&0x80)
-										pixel_pointer_[567] = graphics_carry_;
-									else
-										pixel_pointer_[567] = 0;
+								if(pixel_pointer_) {
+									if(was_double_) {
+										pixel_pointer_[560] = pixel_pointer_[561] = pixel_pointer_[562] = pixel_pointer_[563] =
+										pixel_pointer_[564] = pixel_pointer_[565] = pixel_pointer_[566] = pixel_pointer_[567] = 0;
+									} else {
+										if(line_mode == GraphicsMode::HighRes && base_stream_[39]&0x80)
+											pixel_pointer_[567] = graphics_carry_;
+										else
+											pixel_pointer_[567] = 0;
+									}
+
+									if(line_is_cached_ || line_should_be_cached_) {
+										CachedLine &cached_line = line_cache_[static_cast<size_t>(row_)];
+										if(line_should_be_cached_) {
+											memcpy(cached_line.pixels.data(), pixel_pointer_, cached_line.pixels.size());
+											cached_line.graphics_carry = graphics_carry_;
+										}
+										cached_line.is_valid = true;
+									}
 								}
 
 								crt_->output_data(568, 568);
@@ -101,6 +101,7 @@ template<class T> class Cartridge:
 							case 0x05:		// missile 1 / playfield / ball collisions
 							case 0x06:		// ball / playfield collisions
 							case 0x07:		// player / player, missile / missile collisions
+								update_video();
 								returnValue &= tia_->get_collision_flags(decodedAddress);
 							break;
 
@@ -159,8 +160,8 @@ template<class T> class Cartridge:
 							case 0x23:	update_video(); tia_->set_missile_motion(decodedAddress - 0x22, *value);			break;
 							case 0x24:	update_video(); tia_->set_ball_motion(*value);										break;
 							case 0x25:
-							case 0x26:	tia_->set_player_delay(decodedAddress - 0x25, (*value)&1);							break;
-							case 0x27:	tia_->set_ball_delay((*value)&1);													break;
+							case 0x26:	update_video(); tia_->set_player_delay(decodedAddress - 0x25, (*value)&1);			break;
+							case 0x27:	update_video(); tia_->set_ball_delay((*value)&1);									break;
 							case 0x28:
 							case 0x29:	update_video(); tia_->set_missile_position_to_player(decodedAddress - 0x28, (*value)&2);		break;
 							case 0x2a:	update_video(); tia_->move();														break;
@@ -200,6 +201,7 @@ template<class T> class Cartridge:
 		void flush() {
 			update_audio();
 			update_video();
+			tia_->flush();
 			audio_queue_.perform();
 		}
 
@@ -9,6 +9,7 @@
 #include "TIA.hpp"
 
 #include <cassert>
+#include <cmath>
 #include <cstring>
 
 using namespace Atari2600;
@@ -120,6 +121,7 @@ TIA::TIA(std::function<void(uint8_t *output_buffer)> line_end_function) : TIA(fa
 }
 
 void TIA::set_output_mode(Atari2600::TIA::OutputMode output_mode) {
+	flush();
 	Outputs::CRT::DisplayType display_type;
 
 	if(output_mode == OutputMode::NTSC) {
@@ -132,7 +134,13 @@ void TIA::set_output_mode(Atari2600::TIA::OutputMode output_mode) {
 
 				"float phaseOffset = 6.283185308 * float(iPhase) / 13.0 + 5.074880441076923;"
 				"return vec2(float(y) / 14.0, step(1, iPhase) * cos(phase - phaseOffset));"
-			"}");
+			"}",
+			[] (const uint8_t *source, float phase, float amplitude, float *luminance_chrominance) {
+				const int phase_index = source[0] >> 4;
+				const float phase_offset = 6.283185308f * static_cast<float>(phase_index) / 13.0f + 5.074880441076923f;
+				luminance_chrominance[0] = static_cast<float>(source[0] & 14) / 14.0f;
+				luminance_chrominance[1] = phase_index ? std::cos(phase - phase_offset) : 0.0f;
+			});
 		display_type = Outputs::CRT::DisplayType::NTSC60;
 	} else {
 		crt_->set_svideo_sampling_function(
@@ -146,7 +154,16 @@ void TIA::set_output_mode(Atari2600::TIA::OutputMode output_mode) {
 				"float phaseOffset = float(7u - direction) + (float(direction) - 0.5) * 2.0 * float(iPhase >> 1);"
 				"phaseOffset *= 6.283185308 / 12.0;"
 				"return vec2(float(y) / 14.0, step(4, (iPhase + 2u) & 15u) * cos(phase + phaseOffset));"
-			"}");
+			"}",
+			[] (const uint8_t *source, float phase, float amplitude, float *luminance_chrominance) {
+				const int phase_index = source[0] >> 4;
+				const int direction = phase_index & 1;
+				const float phase_offset =
+					(static_cast<float>(7 - direction) + (static_cast<float>(direction) - 0.5f) * 2.0f * static_cast<float>(phase_index >> 1)) *
+					6.283185308f / 12.0f;
+				luminance_chrominance[0] = static_cast<float>(source[0] & 14) / 14.0f;
+				luminance_chrominance[1] = (((phase_index + 2) & 15) >= 4) ? std::cos(phase + phase_offset) : 0.0f;
+			});
 		display_type = Outputs::CRT::DisplayType::PAL50;
 	}
 	crt_->set_video_signal(Outputs::CRT::VideoSignal::Composite);
@@ -161,7 +178,21 @@ void TIA::set_output_mode(Atari2600::TIA::OutputMode output_mode) {
 }
 
 void TIA::run_for(const Cycles cycles) {
-	int number_of_cycles = cycles.as_int();
+	cycles_pending_ += cycles.as_int();
+
+	// Don't defer beyond the end of a line, so that the CRT is fed at a steady rate.
+	if(horizontal_counter_ + cycles_pending_ >= cycles_per_line) {
+		output_for_pending_cycles();
+	}
+}
+
+void TIA::flush() {
+	if(cycles_pending_) output_for_pending_cycles();
+}
+
+void TIA::output_for_pending_cycles() {
+	int number_of_cycles = cycles_pending_;
+	cycles_pending_ = 0;
 
 	// if part way through a line, definitely perform a partial, at most up to the end of the line
 	if(horizontal_counter_) {
@@ -183,91 +214,127 @@ void TIA::run_for(const Cycles cycles) {
 }
 
 void TIA::set_sync(bool sync) {
-	output_mode_ = (output_mode_ & ~sync_flag) | (sync ? sync_flag : 0);
+	const int output_mode = (output_mode_ & ~sync_flag) | (sync ? sync_flag : 0);
+	if(output_mode == output_mode_) return;
+	flush();
+	output_mode_ = output_mode;
 }
 
 void TIA::set_blank(bool blank) {
-	output_mode_ = (output_mode_ & ~blank_flag) | (blank ? blank_flag : 0);
+	const int output_mode = (output_mode_ & ~blank_flag) | (blank ? blank_flag : 0);
+	if(output_mode == output_mode_) return;
+	flush();
+	output_mode_ = output_mode;
 }
 
 void TIA::reset_horizontal_counter() {
 }
 
 int TIA::get_cycles_until_horizontal_blank(const Cycles from_offset) {
-	return (cycles_per_line - (horizontal_counter_ + from_offset.as_int()) % cycles_per_line) % cycles_per_line;
+	return (cycles_per_line - (horizontal_counter_ + cycles_pending_ + from_offset.as_int()) % cycles_per_line) % cycles_per_line;
 }
 
 void TIA::set_background_colour(uint8_t colour) {
-	colour_palette_[static_cast<int>(ColourIndex::Background)] = colour;
+	set_colour(ColourIndex::Background, colour);
+}
+
+void TIA::set_colour(ColourIndex index, uint8_t colour) {
+	if(colour_palette_[static_cast<int>(index)] == colour) return;
+	flush();
+	colour_palette_[static_cast<int>(index)] = colour;
 }
 
 void TIA::set_playfield(uint16_t offset, uint8_t value) {
 	assert(offset >= 0 && offset < 3);
+	uint32_t background[2];
 	switch(offset) {
+		default:
 		case 0:
-			background_[1] = (background_[1] & 0x0ffff) | (static_cast<uint32_t>(reverse_table[value & 0xf0]) << 16);
-			background_[0] = (background_[0] & 0xffff0) | static_cast<uint32_t>(value >> 4);
+			background[1] = (background_[1] & 0x0ffff) | (static_cast<uint32_t>(reverse_table[value & 0xf0]) << 16);
+			background[0] = (background_[0] & 0xffff0) | static_cast<uint32_t>(value >> 4);
 		break;
 		case 1:
-			background_[1] = (background_[1] & 0xf00ff) | (static_cast<uint32_t>(value) << 8);
-			background_[0] = (background_[0] & 0xff00f) | (static_cast<uint32_t>(reverse_table[value]) << 4);
+			background[1] = (background_[1] & 0xf00ff) | (static_cast<uint32_t>(value) << 8);
+			background[0] = (background_[0] & 0xff00f) | (static_cast<uint32_t>(reverse_table[value]) << 4);
 		break;
 		case 2:
-			background_[1] = (background_[1] & 0xfff00) | reverse_table[value];
-			background_[0] = (background_[0] & 0x00fff) | (static_cast<uint32_t>(value) << 12);
+			background[1] = (background_[1] & 0xfff00) | reverse_table[value];
+			background[0] = (background_[0] & 0x00fff) | (static_cast<uint32_t>(value) << 12);
 		break;
 	}
+	if(background[0] == background_[0] && background[1] == background_[1]) return;
+
+	flush();
+	background_[0] = background[0];
+	background_[1] = background[1];
 }
 
 void TIA::set_playfield_control_and_ball_size(uint8_t value) {
-	background_half_mask_ = value & 1;
+	PlayfieldPriority playfield_priority;
 	switch(value & 6) {
+		default:
 		case 0:
-			playfield_priority_ = PlayfieldPriority::Standard;
+			playfield_priority = PlayfieldPriority::Standard;
 		break;
 		case 2:
-			playfield_priority_ = PlayfieldPriority::Score;
+			playfield_priority = PlayfieldPriority::Score;
 		break;
 		case 4:
 		case 6:
-			playfield_priority_ = PlayfieldPriority::OnTop;
+			playfield_priority = PlayfieldPriority::OnTop;
 		break;
 	}
+	const int ball_size = 1 << ((value >> 4)&3);
+	if(background_half_mask_ == (value & 1) && playfield_priority_ == playfield_priority && ball_.size == ball_size) return;
 
-	ball_.size = 1 << ((value >> 4)&3);
+	flush();
+	background_half_mask_ = value & 1;
+	playfield_priority_ = playfield_priority;
+	ball_.size = ball_size;
 }
 
 void TIA::set_playfield_ball_colour(uint8_t colour) {
-	colour_palette_[static_cast<int>(ColourIndex::PlayfieldBall)] = colour;
+	set_colour(ColourIndex::PlayfieldBall, colour);
 }
 
 void TIA::set_player_number_and_size(int player, uint8_t value) {
 	assert(player >= 0 && player < 2);
-	int size = 0;
+	int size = 0, copy_flags = 0;
 	switch(value & 7) {
 		case 0: case 1: case 2: case 3: case 4:
-			player_[player].copy_flags = value & 7;
+			copy_flags = value & 7;
 		break;
 		case 5:
 			size = 1;
-			player_[player].copy_flags = 0;
 		break;
 		case 6:
-			player_[player].copy_flags = 6;
+			copy_flags = 6;
 		break;
 		case 7:
 			size = 2;
-			player_[player].copy_flags = 0;
 		break;
 	}
+	const int missile_size = 1 << ((value >> 4)&3);
+	if(player_[player].copy_flags == copy_flags && player_[player].adder == (4 >> size) && missile_[player].size == missile_size) return;
 
-	missile_[player].size = 1 << ((value >> 4)&3);
-	missile_[player].copy_flags = player_[player].copy_flags;
+	flush();
+	missile_[player].size = missile_size;
+	missile_[player].copy_flags = player_[player].copy_flags = copy_flags;
 	player_[player].adder = 4 >> size;
 }
 
 void TIA::set_player_graphic(int player, uint8_t value) {
 	assert(player >= 0 && player < 2);
+
+	// Writing to either player's graphic also latches the other's vertically-delayed
+	// graphic, and writing to player 1's latches the ball's delayed enable.
+	if(
+		player_[player].graphic[1] == value &&
+		player_[player^1].graphic[0] == player_[player^1].graphic[1] &&
+		(!player || ball_.enabled[0] == ball_.enabled[1])
+	) return;
+
+	flush();
 	player_[player].graphic[1] = value;
 	player_[player^1].graphic[0] = player_[player^1].graphic[1];
 	if(player) ball_.enabled[0] = ball_.enabled[1];
@@ -275,12 +342,20 @@ void TIA::set_player_graphic(int player, uint8_t value) {
 
 void TIA::set_player_reflected(int player, bool reflected) {
 	assert(player >= 0 && player < 2);
-	player_[player].reverse_mask = reflected ? 7 : 0;
+	const int reverse_mask = reflected ? 7 : 0;
+	if(player_[player].reverse_mask == reverse_mask) return;
+
+	flush();
+	player_[player].reverse_mask = reverse_mask;
 }
 
 void TIA::set_player_delay(int player, bool delay) {
 	assert(player >= 0 && player < 2);
-	player_[player].graphic_index = delay ? 0 : 1;
+	const int graphic_index = delay ? 0 : 1;
+	if(player_[player].graphic_index == graphic_index) return;
+
+	flush();
+	player_[player].graphic_index = graphic_index;
 }
 
 void TIA::set_player_position(int player) {
@@ -290,49 +365,63 @@ void TIA::set_player_position(int player) {
 	// one behind its real hardware value, creating the extra delay; and (ii) the player
 	// code is written to start a draw upon wraparound from 159 to 0, so -1 is the
 	// correct option rather than 159.
+	flush();
 	player_[player].position = -1;
 }
 
 void TIA::set_player_motion(int player, uint8_t motion) {
 	assert(player >= 0 && player < 2);
-	player_[player].motion = (motion >> 4)&0xf;
+	set_motion(player_[player], motion);
 }
 
 void TIA::set_player_missile_colour(int player, uint8_t colour) {
 	assert(player >= 0 && player < 2);
-	colour_palette_[static_cast<int>(ColourIndex::PlayerMissile0) + player] = colour;
+	set_colour(static_cast<ColourIndex>(static_cast<int>(ColourIndex::PlayerMissile0) + player), colour);
 }
 
 void TIA::set_missile_enable(int missile, bool enabled) {
 	assert(missile >= 0 && missile < 2);
+	if(missile_[missile].enabled == enabled) return;
+
+	flush();
 	missile_[missile].enabled = enabled;
 }
 
 void TIA::set_missile_position(int missile) {
 	assert(missile >= 0 && missile < 2);
+	flush();
 	missile_[missile].position = 0;
 }
 
 void TIA::set_missile_position_to_player(int missile, bool lock) {
 	assert(missile >= 0 && missile < 2);
+	flush();
 	missile_[missile].locked_to_player = lock;
 	player_[missile].latched_pixel4_time = -1;
 }
 
 void TIA::set_missile_motion(int missile, uint8_t motion) {
 	assert(missile >= 0 && missile < 2);
-	missile_[missile].motion = (motion >> 4)&0xf;
+	set_motion(missile_[missile], motion);
 }
 
 void TIA::set_ball_enable(bool enabled) {
+	if(ball_.enabled[1] == enabled) return;
+
+	flush();
 	ball_.enabled[1] = enabled;
 }
 
 void TIA::set_ball_delay(bool delay) {
-	ball_.enabled_index = delay ? 0 : 1;
+	const int enabled_index = delay ? 0 : 1;
+	if(ball_.enabled_index == enabled_index) return;
+
+	flush();
+	ball_.enabled_index = enabled_index;
 }
 
 void TIA::set_ball_position() {
+	flush();
 	ball_.position = 0;
 
 	// setting the ball position also triggers a draw
@@ -340,10 +429,19 @@ void TIA::set_ball_position() {
 }
 
 void TIA::set_ball_motion(uint8_t motion) {
-	ball_.motion = (motion >> 4) & 0xf;
+	set_motion(ball_, motion);
+}
+
+template<class T> void TIA::set_motion(T &object, uint8_t motion) {
+	const int value = (motion >> 4) & 0xf;
+	if(object.motion == value) return;
+
+	flush();
+	object.motion = value;
 }
 
 void TIA::move() {
+	flush();
 	horizontal_blank_extend_ = true;
 	player_[0].is_moving = player_[1].is_moving = missile_[0].is_moving = missile_[1].is_moving = ball_.is_moving = true;
 	player_[0].motion_step = player_[1].motion_step = missile_[0].motion_step = missile_[1].motion_step = ball_.motion_step = 15;
@@ -351,14 +449,17 @@ void TIA::move() {
 }
 
 void TIA::clear_motion() {
+	flush();
 	player_[0].motion = player_[1].motion = missile_[0].motion = missile_[1].motion = ball_.motion = 0;
 }
 
 uint8_t TIA::get_collision_flags(int offset) {
+	flush();
 	return static_cast<uint8_t>((collision_flags_ >> (offset << 1)) << 6) & 0xc0;
 }
 
 void TIA::clear_collision_flags() {
+	flush();
 	collision_flags_ = 0;
 }
 
@@ -455,11 +556,8 @@ void TIA::output_for_cycles(int number_of_cycles) {
 		// convert that into pixels
 		if(pixel_target_) output_pixels(output_cursor, horizontal_counter_);
 
-		// accumulate collision flags
-		while(output_cursor < horizontal_counter_) {
-			collision_flags_ |= collision_flags_by_buffer_vaules_[collision_buffer_[output_cursor - first_pixel_cycle]];
-			output_cursor++;
-		}
+		accumulate_collision_flags(output_cursor - first_pixel_cycle, horizontal_counter_ - first_pixel_cycle);
+		output_cursor = horizontal_counter_;
 
 		if(horizontal_counter_ == cycles_per_line && crt_) {
 			const unsigned int data_length = static_cast<unsigned int>(output_cursor - pixels_start_location_);
@@ -510,6 +608,29 @@ void TIA::output_pixels(int start, int end) {
 	}
 }
 
+void TIA::accumulate_collision_flags(int start, int end) {
+	// OR together the contents of the collision buffer a word at a time to establish which objects
+	// appear anywhere in [start, end); if every collision between those objects has already been
+	// flagged then there's nothing to be learnt from inspecting individual pixels.
+	uint32_t objects = 0;
+	int position = start;
+	while(position < end && (position&3)) objects |= collision_buffer_[position++];
+	while(position + 4 <= end) {
+		objects |= *reinterpret_cast<uint32_t *>(&collision_buffer_[position]);
+		position += 4;
+	}
+	while(position < end) objects |= collision_buffer_[position++];
+	objects |= objects >> 16;
+	objects |= objects >> 8;
+
+	if(!(collision_flags_by_buffer_vaules_[objects & 0x3f] & ~collision_flags_)) return;
+
+	while(start < end) {
+		collision_flags_ |= collision_flags_by_buffer_vaules_[collision_buffer_[start]];
+		start++;
+	}
+}
+
 void TIA::output_line() {
 	switch(output_mode_) {
 		default:
@@ -29,8 +29,15 @@ class TIA {
 
 		/*!
 			Advances the TIA by @c cycles. Any queued setters take effect in the first cycle performed.
+
+			Output is deferred until a setter actually changes TIA state, collision flags are read,
+			a line is completed or @c flush is called, so that lines are drawn in as few pieces as possible.
 		*/
 		void run_for(const Cycles cycles);
+
+		/// Performs all output deferred by @c run_for.
+		void flush();
+
 		void set_output_mode(OutputMode output_mode);
 
 		void set_sync(bool sync);
@@ -83,6 +90,10 @@ class TIA {
 		// the master counter; counts from 0 to 228 with all visible pixels being in the final 160
 		int horizontal_counter_ = 0;
 
+		// the number of cycles that have been run for but not yet output
+		int cycles_pending_ = 0;
+		void output_for_pending_cycles();
+
 		// contains flags to indicate whether sync or blank are currently active
 		int output_mode_ = 0;
 
@@ -116,6 +127,7 @@ class TIA {
 			PlayerMissile1
 		};
 		uint8_t colour_palette_[4];
+		void set_colour(ColourIndex index, uint8_t colour);
 
 		// playfield state
 		int background_half_mask_ = 0;
@@ -291,6 +303,7 @@ class TIA {
 		bool horizontal_blank_extend_ = false;
 		template<class T> void perform_border_motion(T &object, int start, int end);
 		template<class T> void perform_motion_step(T &object);
+		template<class T> void set_motion(T &object, uint8_t motion);
 
 		// drawing methods and state
 		void draw_missile(Missile &, Player &, const uint8_t collision_identity, int start, int end);
@@ -299,6 +312,7 @@ class TIA {
 		inline void draw_playfield(int start, int end);
 
 		inline void output_for_cycles(int number_of_cycles);
+		inline void accumulate_collision_flags(int start, int end);
 		inline void output_line();
 
 		int pixels_start_location_ = 0;
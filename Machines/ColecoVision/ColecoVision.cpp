@@ -18,6 +18,7 @@
 #include "../JoystickMachine.hpp"
 
 #include "../../ClockReceiver/ForceInline.hpp"
+#include "../../ClockReceiver/JustInTime.hpp"
 
 #include "../../Outputs/Speaker/Implementation/CompoundSource.hpp"
 #include "../../Outputs/Speaker/Implementation/LowpassSpeaker.hpp"
@@ -170,16 +171,17 @@ class ConcreteMachine:
 		}
 
 		void setup_output(float aspect_ratio) override {
-			vdp_.reset(new TI::TMS::TMS9918(TI::TMS::TMS9918A));
+			vdp_.object().reset(new TI::TMS::TMS9918(TI::TMS::TMS9918A));
+			vdp_.update_sequence_point();
 			get_crt()->set_video_signal(Outputs::CRT::VideoSignal::Composite);
 		}
 
 		void close_output() override {
-			vdp_.reset();
+			vdp_.object().reset();
 		}
 
 		Outputs::CRT::CRT *get_crt() override {
-			return vdp_->get_crt();
+			return vdp_.last_valid()->get_crt();
 		}
 
 		Outputs::Speaker::Speaker *get_speaker() override {
@@ -203,7 +205,9 @@ class ConcreteMachine:
 			);
 			const HalfCycles length = cycle.length + penalty;
 
-			time_since_vdp_update_ += length;
+			if(vdp_ += length) {
+				z80_.set_non_maskable_interrupt_line(vdp_.last_valid()->get_interrupt_line(), vdp_.last_sequence_point_overrun());
+			}
 			time_since_sn76489_update_ += length;
 
 			// Act only if necessary.
@@ -248,10 +252,8 @@ class ConcreteMachine:
 					case CPU::Z80::PartialMachineCycle::Input:
 						switch((address >> 5) & 7) {
 							case 5:
-								update_video();
 								*cycle.value = vdp_->get_register(address);
-								z80_.set_non_maskable_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_non_maskable_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 
 							case 7: {
@@ -292,10 +294,8 @@ class ConcreteMachine:
 							break;
 
 							case 5:
-								update_video();
 								vdp_->set_register(address, *cycle.value);
-								z80_.set_non_maskable_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_non_maskable_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 
 							case 7:
@@ -336,18 +336,11 @@ class ConcreteMachine:
 				}
 			}
 
-			if(time_until_interrupt_ > 0) {
-				time_until_interrupt_ -= length;
-				if(time_until_interrupt_ <= HalfCycles(0)) {
-					z80_.set_non_maskable_interrupt_line(true, time_until_interrupt_);
-				}
-			}
-
 			return penalty;
 		}
 
 		void flush() {
-			update_video();
+			vdp_.flush();
 			update_audio();
 			audio_queue_.perform();
 		}
@@ -365,12 +358,9 @@ class ConcreteMachine:
 		inline void update_audio() {
 			speaker_.run_for(audio_queue_, time_since_sn76489_update_.divide_cycles(Cycles(sn76489_divider)));
 		}
-		inline void update_video() {
-			vdp_->run_for(time_since_vdp_update_.flush());
-		}
 
 		CPU::Z80::Processor<ConcreteMachine, false, false> z80_;
-		std::unique_ptr<TI::TMS::TMS9918> vdp_;
+		JustInTimeActor<std::unique_ptr<TI::TMS::TMS9918>> vdp_;
 
 		Concurrency::DeferringAsyncTaskQueue audio_queue_;
 		TI::SN76489 sn76489_;
@@ -393,9 +383,7 @@ class ConcreteMachine:
 		std::vector<std::unique_ptr<Inputs::Joystick>> joysticks_;
 		bool joysticks_in_keypad_mode_ = false;
 
-		HalfCycles time_since_vdp_update_;
 		HalfCycles time_since_sn76489_update_;
-		HalfCycles time_until_interrupt_;
 
 		Analyser::Dynamic::ConfidenceCounter confidence_counter_;
 		int pc_zero_accesses_ = 0;
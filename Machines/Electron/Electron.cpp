@@ -15,6 +15,7 @@
 
 #include "../../ClockReceiver/ClockReceiver.hpp"
 #include "../../ClockReceiver/ForceInline.hpp"
+#include "../../ClockReceiver/JustInTime.hpp"
 #include "../../Configurable/StandardOptions.hpp"
 #include "../../Outputs/Speaker/Implementation/LowpassSpeaker.hpp"
 #include "../../Processors/6502/6502.hpp"
@@ -34,7 +35,7 @@ namespace Electron {
 
 std::vector<std::unique_ptr<Configurable::Option>> get_options() {
 	return Configurable::standard_options(
-		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite | Configurable::QuickLoadTape)
+		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite | Configurable::QuickLoadTape | Configurable::QuickLoadDisk)
 	);
 }
 
@@ -154,13 +155,13 @@ class ConcreteMachine:
 				if(isReadOperation(operation)) {
 					*value = ram_[address];
 				} else {
-					if(address >= video_access_range_.low_address && address <= video_access_range_.high_address) update_display();
+					if(address >= video_access_range_.low_address && address <= video_access_range_.high_address) video_output_.flush();
 					ram_[address] = *value;
 				}
 
 				// for the entire frame, RAM is accessible only on odd cycles; in modes below 4
 				// it's also accessible only outside of the pixel regions
-				cycles += video_output_->get_cycles_until_next_ram_availability(cycles_since_display_update_.as_int() + 1);
+				cycles += video_output_.last_valid()->get_cycles_until_next_ram_availability(video_output_.time_since_flush().as_int() + 1);
 			} else {
 				switch(address & 0xff0f) {
 					case 0xfe00:
@@ -197,10 +198,9 @@ class ConcreteMachine:
 					case 0xfe08: case 0xfe09: case 0xfe0a: case 0xfe0b:
 					case 0xfe0c: case 0xfe0d: case 0xfe0e: case 0xfe0f:
 						if(!isReadOperation(operation)) {
-							update_display();
 							video_output_->set_register(address, *value);
-							video_access_range_ = video_output_->get_memory_access_range();
-							queue_next_display_interrupt();
+							video_access_range_ = video_output_.last_valid()->get_memory_access_range();
+							next_display_interrupt_ = video_output_.last_valid()->get_next_interrupt().interrupt;
 						}
 					break;
 					case 0xfe04:
@@ -340,18 +340,14 @@ class ConcreteMachine:
 				}
 			}
 
-			cycles_since_display_update_ += Cycles(static_cast<int>(cycles));
+			if(video_output_ += Cycles(static_cast<int>(cycles))) {
+				signal_interrupt(next_display_interrupt_);
+				next_display_interrupt_ = video_output_.last_valid()->get_next_interrupt().interrupt;
+			}
 			cycles_since_audio_update_ += Cycles(static_cast<int>(cycles));
 			if(cycles_since_audio_update_ > Cycles(16384)) update_audio();
 			tape_.run_for(Cycles(static_cast<int>(cycles)));
 
-			cycles_until_display_interrupt_ -= cycles;
-			if(cycles_until_display_interrupt_ < 0) {
-				signal_interrupt(next_display_interrupt_);
-				update_display();
-				queue_next_display_interrupt();
-			}
-
 			if(typer_) typer_->run_for(Cycles(static_cast<int>(cycles)));
 			if(plus3_) plus3_->run_for(Cycles(4*static_cast<int>(cycles)));
 			if(shift_restart_counter_) {
@@ -368,21 +364,23 @@ class ConcreteMachine:
 		}
 
 		forceinline void flush() {
-			update_display();
+			video_output_.flush();
 			update_audio();
 			audio_queue_.perform();
 		}
 
 		void setup_output(float aspect_ratio) override final {
-			video_output_.reset(new VideoOutput(ram_));
+			video_output_.object().reset(new VideoOutput(ram_));
+			video_output_.update_sequence_point();
+			next_display_interrupt_ = video_output_.last_valid()->get_next_interrupt().interrupt;
 		}
 
 		void close_output() override final {
-			video_output_.reset();
+			video_output_.object().reset();
 		}
 
 		Outputs::CRT::CRT *get_crt() override final {
-			return video_output_->get_crt();
+			return video_output_.last_valid()->get_crt();
 		}
 
 		Outputs::Speaker::Speaker *get_speaker() override final {
@@ -427,6 +425,11 @@ class ConcreteMachine:
 				set_use_fast_tape_hack();
 			}
 
+			bool quickdisk;
+			if(plus3_ && Configurable::get_quick_load_disk(selections_by_option, quickdisk)) {
+				plus3_->set_fast_sector_transfer(quickdisk);
+			}
+
 			Configurable::Display display;
 			if(Configurable::get_display(selections_by_option, display)) {
 				set_video_signal_configurable(display);
@@ -436,6 +439,7 @@ class ConcreteMachine:
 		Configurable::SelectionSet get_accurate_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_quick_load_tape_selection(selection_set, false);
+			Configurable::append_quick_load_disk_selection(selection_set, false);
 			Configurable::append_display_selection(selection_set, Configurable::Display::Composite);
 			return selection_set;
 		}
@@ -443,6 +447,7 @@ class ConcreteMachine:
 		Configurable::SelectionSet get_user_friendly_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_quick_load_tape_selection(selection_set, true);
+			Configurable::append_quick_load_disk_selection(selection_set, true);
 			Configurable::append_display_selection(selection_set, Configurable::Display::RGB);
 			return selection_set;
 		}
@@ -506,18 +511,6 @@ class ConcreteMachine:
 		}
 
 		// MARK: - Work deferral updates.
-		inline void update_display() {
-			if(cycles_since_display_update_ > 0) {
-				video_output_->run_for(cycles_since_display_update_.flush());
-			}
-		}
-
-		inline void queue_next_display_interrupt() {
-			VideoOutput::Interrupt next_interrupt = video_output_->get_next_interrupt();
-			cycles_until_display_interrupt_ = next_interrupt.cycles;
-			next_display_interrupt_ = next_interrupt.interrupt;
-		}
-
 		inline void update_audio() {
 			speaker_.run_for(audio_queue_, cycles_since_audio_update_.divide(Cycles(SoundGenerator::clock_rate_divider)));
 		}
@@ -562,9 +555,7 @@ class ConcreteMachine:
 		Electron::KeyboardMapper keyboard_mapper_;
 
 		// Counters related to simultaneous subsystems
-		Cycles cycles_since_display_update_ = 0;
 		Cycles cycles_since_audio_update_ = 0;
-		int cycles_until_display_interrupt_ = 0;
 		Interrupt next_display_interrupt_ = Interrupt::RealTimeClock;
 		VideoOutput::Range video_access_range_ = {0, 0xffff};
 
@@ -583,7 +574,7 @@ class ConcreteMachine:
 		int shift_restart_counter_ = 0;
 
 		// Outputs
-		std::unique_ptr<VideoOutput> video_output_;
+		JustInTimeActor<std::unique_ptr<VideoOutput>, Cycles> video_output_;
 
 		Concurrency::DeferringAsyncTaskQueue audio_queue_;
 		SoundGenerator sound_generator_;
@@ -44,12 +44,12 @@ VideoOutput::VideoOutput(uint8_t *memory) : ram_(memory) {
 	setup_base_address();
 
 	crt_.reset(new Outputs::CRT::CRT(crt_cycles_per_line, 8, Outputs::CRT::DisplayType::PAL50, 1));
-	crt_->set_rgb_sampling_function(
-		"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
-		"{"
-			"uint texValue = texture(sampler, coordinate).r;"
-			"return vec3( uvec3(texValue) & uvec3(4u, 2u, 1u));"
-		"}");
+	crt_->set_rgb_palette(
+		[] (const uint8_t *source, float *rgb) {
+			rgb[0] = (source[0] & 4) ? 1.0f : 0.0f;
+			rgb[1] = (source[0] & 2) ? 1.0f : 0.0f;
+			rgb[2] = (source[0] & 1) ? 1.0f : 0.0f;
+		});
 	// TODO: as implied below, I've introduced a clock's latency into the graphics pipeline somehow. Investigate.
 	crt_->set_visible_area(crt_->get_rect_for_area(first_graphics_line - 1, 256, (first_graphics_cycle+1) * crt_cycles_multiplier, 80 * crt_cycles_multiplier, 4.0f / 3.0f));
 }
@@ -60,6 +60,15 @@ class VideoOutput {
 		*/
 		Interrupt get_next_interrupt();
 
+		/*!
+			@returns the number of cycles until the next change in interrupt output, for the benefit
+			of a JustInTimeActor; the interrupt is signalled once the full count returned by
+			@c get_next_interrupt has elapsed, i.e. upon the cycle after.
+		*/
+		Cycles get_next_sequence_point() {
+			return Cycles(get_next_interrupt().cycles + 1);
+		}
+
 		/*!
 			@returns the number of cycles after (final cycle of last run_for batch + @c from_time)
 			before the video circuits will allow the CPU to access RAM.
@@ -44,6 +44,7 @@
 
 #include "../../Configurable/StandardOptions.hpp"
 #include "../../ClockReceiver/ForceInline.hpp"
+#include "../../ClockReceiver/JustInTime.hpp"
 
 #include "../../Analyser/Static/MSX/Target.hpp"
 
@@ -219,15 +220,16 @@ class ConcreteMachine:
 		}
 
 		void setup_output(float aspect_ratio) override {
-			vdp_.reset(new TI::TMS::TMS9918(TI::TMS::TMS9918A));
+			vdp_.object().reset(new TI::TMS::TMS9918(TI::TMS::TMS9918A));
+			vdp_.update_sequence_point();
 		}
 
 		void close_output() override {
-			vdp_.reset();
+			vdp_.object().reset();
 		}
 
 		Outputs::CRT::CRT *get_crt() override {
-			return vdp_->get_crt();
+			return vdp_.last_valid()->get_crt();
 		}
 
 		Outputs::Speaker::Speaker *get_speaker() override {
@@ -279,6 +281,7 @@ class ConcreteMachine:
 			}
 
 			if(!media.tapes.empty()) {
+				update_tape();
 				tape_player_.set_tape(media.tapes.front());
 			}
 
@@ -354,18 +357,19 @@ class ConcreteMachine:
 			// but otherwise runs without pause.
 			const HalfCycles addition((cycle.operation == CPU::Z80::PartialMachineCycle::ReadOpcode) ? 2 : 0);
 			const HalfCycles total_length = addition + cycle.length;
-			time_since_vdp_update_ += total_length;
+			if(vdp_ += total_length) {
+				z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line(), vdp_.last_sequence_point_overrun());
+			}
 			time_since_ay_update_ += total_length;
-			memory_slots_[0].cycles_since_update += total_length;
-			memory_slots_[1].cycles_since_update += total_length;
-			memory_slots_[2].cycles_since_update += total_length;
-			memory_slots_[3].cycles_since_update += total_length;
+			time_since_slot_update_ += total_length;
 
 			if(cycle.is_terminal()) {
 				uint16_t address = cycle.address ? *cycle.address : 0x0000;
 				switch(cycle.operation) {
 					case CPU::Z80::PartialMachineCycle::ReadOpcode:
 						if(use_fast_tape_) {
+							if(address == 0x1a63 || address == 0x1abc) update_tape();
+
 							if(address == 0x1a63) {
 								// TAPION
 
@@ -432,7 +436,7 @@ class ConcreteMachine:
 							*cycle.value = read_pointers_[address >> 13][address & 8191];
 						} else {
 							int slot_hit = (paged_memory_ >> ((address >> 14) * 2)) & 3;
-							memory_slots_[slot_hit].handler->run_for(memory_slots_[slot_hit].cycles_since_update.flush());
+							update_slot(slot_hit);
 							*cycle.value = memory_slots_[slot_hit].handler->read(address);
 						}
 					break;
@@ -443,7 +447,7 @@ class ConcreteMachine:
 						int slot_hit = (paged_memory_ >> ((address >> 14) * 2)) & 3;
 						if(memory_slots_[slot_hit].handler) {
 							update_audio();
-							memory_slots_[slot_hit].handler->run_for(memory_slots_[slot_hit].cycles_since_update.flush());
+							update_slot(slot_hit);
 							memory_slots_[slot_hit].handler->write(address, *cycle.value, read_pointers_[pc_address_ >> 13] != memory_slots_[0].read_pointers[pc_address_ >> 13]);
 						}
 					} break;
@@ -451,14 +455,13 @@ class ConcreteMachine:
 					case CPU::Z80::PartialMachineCycle::Input:
 						switch(address & 0xff) {
 							case 0x98:	case 0x99:
-								vdp_->run_for(time_since_vdp_update_.flush());
 								*cycle.value = vdp_->get_register(address);
-								z80_.set_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 
 							case 0xa2:
 								update_audio();
+								update_tape();
 								ay_.set_control_lines(static_cast<GI::AY38910::ControlLines>(GI::AY38910::BC2 | GI::AY38910::BC1));
 								*cycle.value = ay_.get_data_output();
 								ay_.set_control_lines(static_cast<GI::AY38910::ControlLines>(0));
@@ -479,10 +482,8 @@ class ConcreteMachine:
 						const int port = address & 0xff;
 						switch(port) {
 							case 0x98:	case 0x99:
-								vdp_->run_for(time_since_vdp_update_.flush());
 								vdp_->set_register(address, *cycle.value);
-								z80_.set_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 
 							case 0xa0:	case 0xa1:
@@ -494,6 +495,7 @@ class ConcreteMachine:
 
 							case 0xa8:	case 0xa9:
 							case 0xaa:	case 0xab:
+								update_tape();
 								i8255_.set_register(address, *cycle.value);
 							break;
 
@@ -542,22 +544,15 @@ class ConcreteMachine:
 				}
 			}
 
-			if(!tape_player_is_sleeping_)
-				tape_player_.run_for(cycle.length.as_int());
-
-			if(time_until_interrupt_ > 0) {
-				time_until_interrupt_ -= total_length;
-				if(time_until_interrupt_ <= HalfCycles(0)) {
-					z80_.set_interrupt_line(true, time_until_interrupt_);
-				}
-			}
+			time_since_tape_update_ += cycle.length;
 			return addition;
 		}
 
 		void flush() {
-			vdp_->run_for(time_since_vdp_update_.flush());
+			vdp_.flush();
 			update_audio();
 			audio_queue_.perform();
+			update_tape();
 		}
 
 		void set_keyboard_line(int line) {
@@ -685,7 +680,7 @@ class ConcreteMachine:
 		};
 
 		CPU::Z80::Processor<ConcreteMachine, false, false> z80_;
-		std::unique_ptr<TI::TMS::TMS9918> vdp_;
+		JustInTimeActor<std::unique_ptr<TI::TMS::TMS9918>> vdp_;
 		Intel::i8255::i8255<i8255PortHandler> i8255_;
 
 		Concurrency::DeferringAsyncTaskQueue audio_queue_;
@@ -697,6 +692,11 @@ class ConcreteMachine:
 
 		Storage::Tape::BinaryTapePlayer tape_player_;
 		bool tape_player_is_sleeping_ = false;
+		HalfCycles time_since_tape_update_;
+		void update_tape() {
+			const HalfCycles time = time_since_tape_update_.flush();
+			if(!tape_player_is_sleeping_) tape_player_.run_for(time.as_int());
+		}
 		bool allow_fast_tape_ = false;
 		bool use_fast_tape_ = false;
 		void set_use_fast_tape() {
@@ -725,13 +725,19 @@ class ConcreteMachine:
 			ROMSlotHandler::WrappingStrategy wrapping_strategy = ROMSlotHandler::WrappingStrategy::Repeat;
 		} memory_slots_[4];
 
+		// Time is accumulated here for all slots in common, and is distributed only when a slot handler is accessed.
+		HalfCycles time_since_slot_update_;
+		void update_slot(int slot) {
+			const HalfCycles time = time_since_slot_update_.flush();
+			for(auto &memory_slot: memory_slots_) memory_slot.cycles_since_update += time;
+			memory_slots_[slot].handler->run_for(memory_slots_[slot].cycles_since_update.flush());
+		}
+
 		uint8_t ram_[65536];
 		uint8_t scratch_[8192];
 		uint8_t unpopulated_[8192];
 
-		HalfCycles time_since_vdp_update_;
 		HalfCycles time_since_ay_update_;
-		HalfCycles time_until_interrupt_;
 
 		uint8_t key_states_[16];
 		int selected_key_line_ = 0;
@@ -17,6 +17,7 @@
 #include "../JoystickMachine.hpp"
 
 #include "../../ClockReceiver/ForceInline.hpp"
+#include "../../ClockReceiver/JustInTime.hpp"
 
 #include "../../Outputs/Speaker/Implementation/LowpassSpeaker.hpp"
 #include "../../Outputs/Log.hpp"
@@ -146,7 +147,7 @@ class ConcreteMachine:
 		}
 
 		void setup_output(float aspect_ratio) override {
-			vdp_.reset(new TI::TMS::TMS9918(model_ == Target::Model::SG1000 ? TI::TMS::TMS9918A : TI::TMS::SMSVDP));
+			vdp_.object().reset(new TI::TMS::TMS9918(model_ == Target::Model::SG1000 ? TI::TMS::TMS9918A : TI::TMS::SMSVDP));
 			vdp_->set_tv_standard(
 				(region_ == Target::Region::Europe) ?
 					TI::TMS::TVStandard::PAL : TI::TMS::TVStandard::NTSC);
@@ -154,11 +155,11 @@ class ConcreteMachine:
 		}
 
 		void close_output() override {
-			vdp_.reset();
+			vdp_.object().reset();
 		}
 
 		Outputs::CRT::CRT *get_crt() override {
-			return vdp_->get_crt();
+			return vdp_.last_valid()->get_crt();
 		}
 
 		Outputs::Speaker::Speaker *get_speaker() override {
@@ -170,7 +171,9 @@ class ConcreteMachine:
 		}
 
 		forceinline HalfCycles perform_machine_cycle(const CPU::Z80::PartialMachineCycle &cycle) {
-			time_since_vdp_update_ += cycle.length;
+			if(vdp_ += cycle.length) {
+				z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line(), vdp_.last_sequence_point_overrun());
+			}
 			time_since_sn76489_update_ += cycle.length;
 
 			if(cycle.is_terminal()) {
@@ -214,17 +217,14 @@ class ConcreteMachine:
 								*cycle.value = 0xff;
 							break;
 							case 0x40:
-								update_video();
 								*cycle.value = vdp_->get_current_line();
 							break;
 							case 0x41:
 								*cycle.value = vdp_->get_latched_horizontal_counter();
 							break;
 							case 0x80: case 0x81:
-								update_video();
 								*cycle.value = vdp_->get_register(address);
-								z80_.set_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 							case 0xc0: {
 								Joystick *const joypad1 = static_cast<Joystick *>(joysticks_[0].get());
@@ -265,7 +265,6 @@ class ConcreteMachine:
 
 								// Latch if either TH has newly gone to 1.
 								if((new_ths^previous_ths)&new_ths) {
-									update_video();
 									vdp_->latch_horizontal_counter();
 								}
 							} break;
@@ -274,10 +273,8 @@ class ConcreteMachine:
 								sn76489_.set_register(*cycle.value);
 							break;
 							case 0x80: case 0x81:
-								update_video();
 								vdp_->set_register(address, *cycle.value);
-								z80_.set_interrupt_line(vdp_->get_interrupt_line());
-								time_until_interrupt_ = vdp_->get_time_until_interrupt();
+								z80_.set_interrupt_line(vdp_.last_valid()->get_interrupt_line());
 							break;
 							case 0xc0:
 								LOG("TODO: [output] I/O port A/N; " << int(*cycle.value));
@@ -300,18 +297,11 @@ class ConcreteMachine:
 				}
 			}
 
-			if(time_until_interrupt_ > 0) {
-				time_until_interrupt_ -= cycle.length;
-				if(time_until_interrupt_ <= HalfCycles(0)) {
-					z80_.set_interrupt_line(true, time_until_interrupt_);
-				}
-			}
-
 			return HalfCycles(0);
 		}
 
 		void flush() {
-			update_video();
+			vdp_.flush();
 			update_audio();
 			audio_queue_.perform();
 		}
@@ -335,16 +325,13 @@ class ConcreteMachine:
 		inline void update_audio() {
 			speaker_.run_for(audio_queue_, time_since_sn76489_update_.divide_cycles(Cycles(sn76489_divider)));
 		}
-		inline void update_video() {
-			vdp_->run_for(time_since_vdp_update_.flush());
-		}
 
 		using Target = Analyser::Static::Sega::Target;
 		Target::Model model_;
 		Target::Region region_;
 		Target::PagingScheme paging_scheme_;
 		CPU::Z80::Processor<ConcreteMachine, false, false> z80_;
-		std::unique_ptr<TI::TMS::TMS9918> vdp_;
+		JustInTimeActor<std::unique_ptr<TI::TMS::TMS9918>> vdp_;
 
 		Concurrency::DeferringAsyncTaskQueue audio_queue_;
 		TI::SN76489 sn76489_;
@@ -352,9 +339,7 @@ class ConcreteMachine:
 
 		std::vector<std::unique_ptr<Inputs::Joystick>> joysticks_;
 
-		HalfCycles time_since_vdp_update_;
 		HalfCycles time_since_sn76489_update_;
-		HalfCycles time_until_interrupt_;
 
 		uint8_t ram_[8*1024];
 		uint8_t bios_[8*1024];
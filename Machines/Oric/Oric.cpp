@@ -46,7 +46,7 @@ enum ROM {
 
 std::vector<std::unique_ptr<Configurable::Option>> get_options() {
 	return Configurable::standard_options(
-		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite | Configurable::QuickLoadTape)
+		static_cast<Configurable::StandardOptions>(Configurable::DisplayRGB | Configurable::DisplayComposite | Configurable::QuickLoadTape | Configurable::QuickLoadDisk)
 	);
 }
 
@@ -413,7 +413,10 @@ template <Analyser::Static::Oric::Target::DiskInterface disk_interface> class Co
 					if(isReadOperation(operation))
 						*value = ram_[address];
 					else {
-						if(address >= 0x9800 && address <= 0xc000) update_video();
+						if(address >= 0x9800 && address <= 0xc000) {
+							update_video();
+							video_output_->mark_written(address);
+						}
 						ram_[address] = *value;
 					}
 				}
@@ -531,6 +534,11 @@ template <Analyser::Static::Oric::Target::DiskInterface disk_interface> class Co
 				set_use_fast_tape_hack(quickload);
 			}
 
+			bool quickdisk;
+			if(Configurable::get_quick_load_disk(selections_by_option, quickdisk)) {
+				microdisc_.set_fast_sector_transfer(quickdisk);
+			}
+
 			Configurable::Display display;
 			if(Configurable::get_display(selections_by_option, display)) {
 				set_video_signal_configurable(display);
@@ -544,6 +552,7 @@ template <Analyser::Static::Oric::Target::DiskInterface disk_interface> class Co
 		Configurable::SelectionSet get_accurate_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_quick_load_tape_selection(selection_set, false);
+			Configurable::append_quick_load_disk_selection(selection_set, false);
 			Configurable::append_display_selection(selection_set, Configurable::Display::Composite);
 			return selection_set;
 		}
@@ -551,6 +560,7 @@ template <Analyser::Static::Oric::Target::DiskInterface disk_interface> class Co
 		Configurable::SelectionSet get_user_friendly_selections() override {
 			Configurable::SelectionSet selection_set;
 			Configurable::append_quick_load_tape_selection(selection_set, true);
+			Configurable::append_quick_load_disk_selection(selection_set, true);
 			Configurable::append_display_selection(selection_set, Configurable::Display::RGB);
 			return selection_set;
 		}
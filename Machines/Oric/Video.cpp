@@ -8,6 +8,8 @@
 
 #include "Video.hpp"
 
+#include <cstring>
+
 using namespace Oric;
 
 namespace {
@@ -17,19 +19,40 @@ namespace {
 	const unsigned int PAL60VSyncEndPosition = 238*64;
 	const unsigned int PAL50Period = 312*64;
 	const unsigned int PAL60Period = 262*64;
+
+	/*!
+		Maps from any six-pixel pattern to masks that select the ink colour for set pixels,
+		as three pairs of 16-bit pixels.
+	*/
+	struct PixelMasks {
+		uint32_t masks[64][3];
+
+		PixelMasks() {
+			for(int c = 0; c < 64; ++c) {
+				uint16_t pixels[6];
+				for(int pixel = 0; pixel < 6; ++pixel) {
+					pixels[pixel] = ((c >> (5 - pixel)) & 1) ? 0xffff : 0x0000;
+				}
+				memcpy(masks[c], pixels, sizeof(masks[c]));
+			}
+		}
+	} pixel_masks;
 }
 
 VideoOutput::VideoOutput(uint8_t *memory) :
 		ram_(memory),
 		crt_(new Outputs::CRT::CRT(64*6, 6, Outputs::CRT::DisplayType::PAL50, 2)),
 		v_sync_start_position_(PAL50VSyncStartPosition), v_sync_end_position_(PAL50VSyncEndPosition),
-		counter_period_(PAL50Period) {
-	crt_->set_rgb_sampling_function(
-		"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
-		"{"
-			"uint texValue = texture(sampler, coordinate).r;"
-			"return vec3( uvec3(texValue) & uvec3(4u, 2u, 1u));"
-		"}");
+		counter_period_(PAL50Period),
+		write_tracker_(65536) {
+	for(std::size_t c = 0; c < 8; c++) colour_forms_[c] = 0;
+
+	crt_->set_rgb_palette(
+		[] (const uint8_t *source, float *rgb) {
+			rgb[0] = (source[0] & 4) ? 1.0f : 0.0f;
+			rgb[1] = (source[0] & 2) ? 1.0f : 0.0f;
+			rgb[2] = (source[0] & 1) ? 1.0f : 0.0f;
+		});
 	crt_->set_composite_sampling_function(
 		"float composite_sample(usampler2D sampler, vec2 coordinate, float phase, float amplitude)"
 		"{"
@@ -37,7 +60,12 @@ VideoOutput::VideoOutput(uint8_t *memory) :
 			"uint iPhase = uint((phase + 3.141592654 + 0.39269908175) * 2.0 / 3.141592654) & 3u;"
 			"texValue = (texValue >> (4u*(3u - iPhase))) & 15u;"
 			"return (float(texValue) - 4.0) / 20.0;"
-		"}"
+		"}",
+		[] (const uint8_t *source, float phase, float amplitude) {
+			const int value = source[0] | (source[1] << 8);
+			const int phase_index = static_cast<int>((phase + 3.141592654f + 0.39269908175f) * 2.0f / 3.141592654f) & 3;
+			return (static_cast<float>((value >> (4 * (3 - phase_index))) & 15) - 4.0f) / 20.0f;
+		}
 	);
 	crt_->set_composite_function_type(Outputs::CRT::CRT::CompositeSourceType::DiscreteFourSamplesPerCycle, 0.0f);
 
@@ -48,6 +76,18 @@ VideoOutput::VideoOutput(uint8_t *memory) :
 void VideoOutput::set_video_signal(Outputs::CRT::VideoSignal video_signal) {
 	video_signal_ = video_signal;
 	crt_->set_video_signal(video_signal);
+	set_palette();
+}
+
+void VideoOutput::set_palette() {
+	for(std::size_t c = 0; c < 8; c++) {
+		palette_[c] = (video_signal_ == Outputs::CRT::VideoSignal::RGB) ? static_cast<uint16_t>(c) : colour_forms_[c];
+	}
+	invalidate_cached_lines();
+}
+
+void VideoOutput::invalidate_cached_lines() {
+	for(auto &line: cached_lines_) line.is_valid = false;
 }
 
 void VideoOutput::set_colour_rom(const std::vector<uint8_t> &rom) {
@@ -65,6 +105,8 @@ void VideoOutput::set_colour_rom(const std::vector<uint8_t> &rom) {
 			colour_forms_[c] = static_cast<uint16_t>((colour_forms_[c] >> 8) | (colour_forms_[c] << 8));
 		}
 	}
+
+	set_palette();
 }
 
 Outputs::CRT::CRT *VideoOutput::get_crt() {
@@ -103,6 +145,47 @@ void VideoOutput::run_for(const Cycles cycles) {
 					v_sync_end_position_ = next_frame_is_sixty_hertz_ ? PAL60VSyncEndPosition : PAL50VSyncEndPosition;
 					counter_period_ = next_frame_is_sixty_hertz_ ? PAL60Period : PAL50Period;
 				}
+
+				// If this line will be output in one go, check whether it can be replayed from the
+				// cache. A line is conservatively assumed to depend on both its graphics and its
+				// text memory, and on all character sets.
+				const uint64_t generation = write_tracker_.advance();
+				line_is_cached_ = line_should_be_cached_ = false;
+				if(pixel_target_ && number_of_cycles >= 40) {
+					CachedLine &line = cached_lines_[counter_ >> 6];
+					const int blink_phase = frame_counter_ & 32;
+					const std::size_t text_address = static_cast<std::size_t>(0xbb80 + (counter_ >> 9) * 40);
+					const std::size_t graphics_address = static_cast<std::size_t>(0xa000 + (counter_ >> 6) * 40);
+
+					if(
+						line.is_valid &&
+						line.started_in_graphics_mode == is_graphics_mode_ &&
+						line.started_sixty_hertz == next_frame_is_sixty_hertz_ &&
+						line.blink_phase == blink_phase &&
+						!write_tracker_.has_changed(text_address, text_address + 40, line.generation) &&
+						(counter_ >= 200*64 || !write_tracker_.has_changed(graphics_address, graphics_address + 40, line.generation)) &&
+						!write_tracker_.has_changed(0x9800, 0xa000, line.generation) &&
+						!write_tracker_.has_changed(0xb400, 0xbc00, line.generation)
+					) {
+						memcpy(pixel_target_, line.pixels, sizeof(line.pixels));
+						ink_ = line.ink;
+						paper_ = line.paper;
+						is_graphics_mode_ = line.is_graphics_mode;
+						next_frame_is_sixty_hertz_ = line.next_frame_is_sixty_hertz;
+						use_alternative_character_set_ = line.use_alternative_character_set;
+						use_double_height_characters_ = line.use_double_height_characters;
+						blink_text_ = line.blink_text;
+						set_character_set_base_address();
+						line_is_cached_ = true;
+					} else {
+						line.generation = generation;
+						line.started_in_graphics_mode = is_graphics_mode_;
+						line.started_sixty_hertz = next_frame_is_sixty_hertz_;
+						line.blink_phase = blink_phase;
+						line_should_be_cached_ = true;
+					}
+					line.is_valid = false;
+				}
 			}
 
 			cycles_run_for = std::min(40 - h_counter, number_of_cycles);
@@ -111,6 +194,12 @@ void VideoOutput::run_for(const Cycles cycles) {
 			int character_base_address = 0xbb80 + (counter_ >> 9) * 40;
 			uint8_t blink_mask = (blink_text_ && (frame_counter_&32)) ? 0x00 : 0xff;
 
+			if(line_is_cached_) {
+				columns = 0;
+				h_counter = 40;
+				pixel_target_ += 240;
+			}
+
 			while(columns--) {
 				uint8_t pixels, control_byte;
 
@@ -128,20 +217,15 @@ void VideoOutput::run_for(const Cycles cycles) {
 
 				if(control_byte & 0x60) {
 					if(pixel_target_) {
-						uint16_t colours[2];
-						if(video_signal_ == Outputs::CRT::VideoSignal::RGB) {
-							colours[0] = static_cast<uint8_t>(paper_ ^ inverse_mask);
-							colours[1] = static_cast<uint8_t>(ink_ ^ inverse_mask);
-						} else {
-							colours[0] = colour_forms_[paper_ ^ inverse_mask];
-							colours[1] = colour_forms_[ink_ ^ inverse_mask];
-						}
-						pixel_target_[0] = colours[(pixels >> 5)&1];
-						pixel_target_[1] = colours[(pixels >> 4)&1];
-						pixel_target_[2] = colours[(pixels >> 3)&1];
-						pixel_target_[3] = colours[(pixels >> 2)&1];
-						pixel_target_[4] = colours[(pixels >> 1)&1];
-						pixel_target_[5] = colours[(pixels >> 0)&1];
+						const uint32_t paper = palette_[paper_ ^ inverse_mask] * 0x00010001u;
+						const uint32_t ink = palette_[ink_ ^ inverse_mask] * 0x00010001u;
+						const uint32_t *const masks = pixel_masks.masks[pixels & 0x3f];
+
+						uint32_t output[3];
+						output[0] = (ink & masks[0]) | (paper & ~masks[0]);
+						output[1] = (ink & masks[1]) | (paper & ~masks[1]);
+						output[2] = (ink & masks[2]) | (paper & ~masks[2]);
+						memcpy(pixel_target_, output, sizeof(output));
 					}
 				} else {
 					switch(control_byte & 0x1f) {
@@ -183,7 +267,7 @@ void VideoOutput::run_for(const Cycles cycles) {
 						pixel_target_[0] = pixel_target_[1] =
 						pixel_target_[2] = pixel_target_[3] =
 						pixel_target_[4] = pixel_target_[5] =
-							(video_signal_ == Outputs::CRT::VideoSignal::RGB) ? paper_ ^ inverse_mask : colour_forms_[paper_ ^ inverse_mask];
+							palette_[paper_ ^ inverse_mask];
 					}
 				}
 				if(pixel_target_) pixel_target_ += 6;
@@ -191,6 +275,21 @@ void VideoOutput::run_for(const Cycles cycles) {
 			}
 
 			if(h_counter == 40) {
+				if(line_should_be_cached_) {
+					CachedLine &line = cached_lines_[counter_ >> 6];
+					memcpy(line.pixels, pixel_target_ - 240, sizeof(line.pixels));
+					line.ink = ink_;
+					line.paper = paper_;
+					line.is_graphics_mode = is_graphics_mode_;
+					line.next_frame_is_sixty_hertz = next_frame_is_sixty_hertz_;
+					line.use_alternative_character_set = use_alternative_character_set_;
+					line.use_double_height_characters = use_double_height_characters_;
+					line.blink_text = blink_text_;
+					line.is_valid = true;
+				} else if(line_is_cached_) {
+					cached_lines_[counter_ >> 6].is_valid = true;
+				}
+
 				crt_->output_data(40 * 6);
 			}
 		} else {
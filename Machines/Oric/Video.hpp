@@ -11,6 +11,7 @@
 
 #include "../../Outputs/CRT/CRT.hpp"
 #include "../../ClockReceiver/ClockReceiver.hpp"
+#include "../Utility/WriteTracker.hpp"
 
 namespace Oric {
 
@@ -22,6 +23,22 @@ class VideoOutput {
 		void set_colour_rom(const std::vector<uint8_t> &rom);
 		void set_video_signal(Outputs::CRT::VideoSignal output_device);
 
+		/*!
+			Records that the byte at @c address has been written to, so that any cached
+			line output that depends upon it will be regenerated.
+		*/
+		inline void mark_written(uint16_t address) {
+			write_tracker_.mark_written(address);
+		}
+
+		/*!
+			@returns the number of cycles in the current frame: 312 or 262 lines of 64 cycles
+			for a 50Hz or 60Hz frame respectively.
+		*/
+		inline int get_frame_length() const {
+			return counter_period_;
+		}
+
 	private:
 		uint8_t *ram_;
 		std::unique_ptr<Outputs::CRT::CRT> crt_;
@@ -35,6 +52,10 @@ class VideoOutput {
 		uint16_t colour_forms_[8];
 		Outputs::CRT::VideoSignal video_signal_;
 
+		// The output value for each of the eight colours, given the current video signal.
+		uint16_t palette_[8];
+		void set_palette();
+
 		// Registers
 		uint8_t ink_, paper_;
 
@@ -46,6 +67,27 @@ class VideoOutput {
 		bool use_alternative_character_set_;
 		bool use_double_height_characters_;
 		bool blink_text_;
+
+		// Line caching: the write tracker's generation is advanced at the start of every pixel line.
+		Memory::WriteTracker<6> write_tracker_;
+
+		// Retains the output of each pixel line that was output in one go, alongside the
+		// state it started from and the state it left behind, so that it can be replayed if
+		// none of the memory it depends upon has changed.
+		struct CachedLine {
+			uint16_t pixels[240];
+			uint64_t generation = 0;
+			bool is_valid = false;
+
+			bool started_in_graphics_mode, started_sixty_hertz;
+			int blink_phase;
+
+			uint8_t ink, paper;
+			bool is_graphics_mode, next_frame_is_sixty_hertz;
+			bool use_alternative_character_set, use_double_height_characters, blink_text;
+		} cached_lines_[224];
+		bool line_is_cached_ = false, line_should_be_cached_ = false;
+		void invalidate_cached_lines();
 };
 
 }
@@ -0,0 +1,69 @@
+//
+//  WriteTracker.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef WriteTracker_hpp
+#define WriteTracker_hpp
+
+#include "../../ClockReceiver/ForceInline.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Memory {
+
+/*!
+	Divides a block of memory into pages of 2^@c PageShift bytes and records, for each page, the
+	generation during which it was last written to.
+
+	The generation is advanced by whichever party wishes to know about changes, typically a video
+	generator that advances it once per line. Machines' bus handlers report writes via @c mark_written,
+	which is a single store. A video generator that records the generation in which it produced some
+	output can then use @c has_changed to discover whether the memory that output was built from has
+	since been modified, and if not then it can reuse that output rather than building it again.
+*/
+template <int PageShift> class WriteTracker {
+	public:
+		/// Constructs a tracker for @c size bytes of memory.
+		WriteTracker(std::size_t size) : generations_((size + (1 << PageShift) - 1) >> PageShift, 0) {}
+
+		/// Records a write to @c address, which is an offset into the tracked block of memory.
+		forceinline void mark_written(std::size_t address) {
+			generations_[address >> PageShift] = generation_;
+		}
+
+		/*!
+			Advances the generation. Output built after this call is considered current only
+			until the next write to the memory it was built from.
+
+			@returns the new generation.
+		*/
+		uint64_t advance() {
+			return ++generation_;
+		}
+
+		/*!
+			@returns @c true if any byte in the range [@c start, @c end) has been written to since
+			output was built during @c generation; @c false otherwise.
+		*/
+		bool has_changed(std::size_t start, std::size_t end, uint64_t generation) const {
+			if(!generation) return true;
+			for(std::size_t page = start >> PageShift; page <= (end - 1) >> PageShift; ++page) {
+				if(generations_[page] >= generation) return true;
+			}
+			return false;
+		}
+
+	private:
+		std::vector<uint64_t> generations_;
+		uint64_t generation_ = 0;
+};
+
+}
+
+#endif /* WriteTracker_hpp */
@@ -29,7 +29,10 @@ Video::Video() :
 		"float composite_sample(usampler2D sampler, vec2 coordinate, float phase, float amplitude)"
 		"{"
 			"return texture(sampler, coordinate).r;"
-		"}");
+		"}",
+		[] (const uint8_t *source, float phase, float amplitude) {
+			return source[0] ? 1.0f : 0.0f;
+		});
 
 	// Show only the centre 80% of the TV frame.
 	crt_->set_video_signal(Outputs::CRT::VideoSignal::Composite);
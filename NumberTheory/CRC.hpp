@@ -9,37 +9,124 @@
 #ifndef CRC_hpp
 #define CRC_hpp
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
 namespace CRC {
 
-/*! Provides a class capable of generating a CRC from source data. */
-template <typename T, T reset_value, T xor_output, bool reflect_input, bool reflect_output> class Generator {
+// MARK: - Compile-time table generation.
+
+template <std::size_t... indices> struct IndexSequence {};
+template <std::size_t count, std::size_t... indices> struct MakeIndexSequence: MakeIndexSequence<count - 1, count - 1, indices...> {};
+template <std::size_t... indices> struct MakeIndexSequence<0, indices...> {
+	typedef IndexSequence<indices...> type;
+};
+
+/// @returns @c byte with its bit order reversed.
+constexpr uint8_t reverse_byte(uint8_t byte) {
+	return
+		((byte & 0x80) ? 0x01 : 0x00) |
+		((byte & 0x40) ? 0x02 : 0x00) |
+		((byte & 0x20) ? 0x04 : 0x00) |
+		((byte & 0x10) ? 0x08 : 0x00) |
+		((byte & 0x08) ? 0x10 : 0x00) |
+		((byte & 0x04) ? 0x20 : 0x00) |
+		((byte & 0x02) ? 0x40 : 0x00) |
+		((byte & 0x01) ? 0x80 : 0x00);
+}
+
+/// @returns The result of shifting @c value left by @c bits places through the CRC defined by @c polynomial.
+template <typename T, T polynomial> constexpr T shift(T value, int bits) {
+	return bits ?
+		shift<T, polynomial>(T(T(value << 1) ^ ((value & T(~(T(~0) >> 1))) ? polynomial : 0)), bits - 1) :
+		value;
+}
+
+/*!
+	Contains the eight 256-entry tables used for slicing-by-8 CRC calculation.
+
+	values[n][b] is the effect upon the CRC of the byte @c b followed by @c n zero bytes;
+	values[0] is therefore the usual byte-at-a-time table.
+*/
+template <typename T, T polynomial, typename Indices = typename MakeIndexSequence<256>::type> struct Tables;
+template <typename T, T polynomial, std::size_t... indices> struct Tables<T, polynomial, IndexSequence<indices...>> {
+	static constexpr int multibyte_shift = (sizeof(T) * 8) - 8;
+	static constexpr T values[8][256] = {
+		{shift<T, polynomial>(T(indices << multibyte_shift), 8)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 16)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 24)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 32)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 40)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 48)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 56)...},
+		{shift<T, polynomial>(T(indices << multibyte_shift), 64)...},
+	};
+};
+template <typename T, T polynomial, std::size_t... indices> constexpr T Tables<T, polynomial, IndexSequence<indices...>>::values[8][256];
+
+/// Contains a table mapping each byte to its bit-reversed equivalent.
+template <typename Indices = typename MakeIndexSequence<256>::type> struct ReversedBytes;
+template <std::size_t... indices> struct ReversedBytes<IndexSequence<indices...>> {
+	static constexpr uint8_t values[256] = {reverse_byte(uint8_t(indices))...};
+};
+template <std::size_t... indices> constexpr uint8_t ReversedBytes<IndexSequence<indices...>>::values[256];
+
+// MARK: - Generator.
+
+/*!
+	Provides a class capable of generating a CRC from source data.
+
+	The lookup tables for @c polynomial are built at compile time; buffers supplied
+	via add(const uint8_t *, std::size_t) or compute_crc are processed eight bytes at a time.
+*/
+template <typename T, T polynomial, T reset_value, T xor_output, bool reflect_input, bool reflect_output> class Generator {
 	public:
 		/*!
-			Instantiates a CRC16 that will compute the CRC16 specified by the supplied
+			Instantiates a CRC generator that will compute the CRC specified by the template parameters
 			@c polynomial and @c reset_value.
 		*/
-		Generator(T polynomial): value_(reset_value) {
-			const T top_bit = T(~(T(~0) >> 1));
-			for(int c = 0; c < 256; c++) {
-				T shift_value = static_cast<T>(c << multibyte_shift);
-				for(int b = 0; b < 8; b++) {
-					T exclusive_or = (shift_value&top_bit) ? polynomial : 0;
-					shift_value = static_cast<T>(shift_value << 1) ^ exclusive_or;
-				}
-				xor_table[c] = shift_value;
-			}
-		}
+		Generator(): value_(reset_value) {}
 
 		/// Resets the CRC to the reset value.
 		void reset() { value_ = reset_value; }
 
 		/// Updates the CRC to include @c byte.
 		void add(uint8_t byte) {
-			if(reflect_input) byte = reverse_byte(byte);
-			value_ = static_cast<T>((value_ << 8) ^ xor_table[(value_ >> multibyte_shift) ^ byte]);
+			if(reflect_input) byte = ReversedBytes<>::values[byte];
+			value_ = static_cast<T>((value_ << 8) ^ tables::values[0][(value_ >> multibyte_shift) ^ byte]);
+		}
+
+		/// Updates the CRC to include the @c length bytes at @c data.
+		void add(const uint8_t *data, std::size_t length) {
+			static_assert(sizeof(T) <= 8, "Slicing-by-8 can be applied only to CRCs of 64 bits or fewer");
+
+			while(length >= 8) {
+				uint8_t bytes[8];
+				for(int c = 0; c < 8; ++c) {
+					bytes[c] = reflect_input ? ReversedBytes<>::values[data[c]] : data[c];
+				}
+
+				// The first sizeof(T) bytes combine with the current CRC; all eight then make
+				// independent contributions according to the number of bytes that follow them.
+				T result = 0;
+				for(std::size_t c = 0; c < sizeof(T); ++c) {
+					const int byte_shift = multibyte_shift - int(c * 8);
+					result ^= tables::values[7 - c][uint8_t(value_ >> byte_shift) ^ bytes[c]];
+				}
+				for(std::size_t c = sizeof(T); c < 8; ++c) {
+					result ^= tables::values[7 - c][bytes[c]];
+				}
+				value_ = result;
+
+				data += 8;
+				length -= 8;
+			}
+
+			while(length--) {
+				add(*data);
+				++data;
+			}
 		}
 
 		/// @returns The current value of the CRC.
@@ -48,7 +135,7 @@ template <typename T, T reset_value, T xor_output, bool reflect_input, bool refl
 			if(reflect_output) {
 				T reflected_output = 0;
 				for(std::size_t c = 0; c < sizeof(T); ++c) {
-					reflected_output = T(reflected_output << 8) | T(reverse_byte(result & 0xff));
+					reflected_output = T(reflected_output << 8) | T(ReversedBytes<>::values[result & 0xff]);
 					result >>= 8;
 				}
 				return reflected_output;
@@ -68,42 +155,26 @@ template <typename T, T reset_value, T xor_output, bool reflect_input, bool refl
 		*/
 		T compute_crc(const std::vector<uint8_t> &data) {
 			reset();
-			for(const auto &byte: data) add(byte);
+			add(data.data(), data.size());
 			return get_value();
 		}
 
 	private:
+		typedef Tables<T, polynomial> tables;
 		static constexpr int multibyte_shift = (sizeof(T) * 8) - 8;
-		T xor_table[256];
 		T value_;
-
-		constexpr uint8_t reverse_byte(uint8_t byte) const {
-			return
-				((byte & 0x80) ? 0x01 : 0x00) |
-				((byte & 0x40) ? 0x02 : 0x00) |
-				((byte & 0x20) ? 0x04 : 0x00) |
-				((byte & 0x10) ? 0x08 : 0x00) |
-				((byte & 0x08) ? 0x10 : 0x00) |
-				((byte & 0x04) ? 0x20 : 0x00) |
-				((byte & 0x02) ? 0x40 : 0x00) |
-				((byte & 0x01) ? 0x80 : 0x00);
-		}
 };
 
 /*!
 	Provides a generator of 16-bit CCITT CRCs, which amongst other uses are
 	those used by the FM and MFM disk encodings.
 */
-struct CCITT: public Generator<uint16_t, 0xffff, 0x0000, false, false> {
-	CCITT(): Generator(0x1021) {}
-};
+typedef Generator<uint16_t, 0x1021, 0xffff, 0x0000, false, false> CCITT;
 
 /*!
 	Provides a generator of "standard 32-bit" CRCs.
 */
-struct CRC32: public Generator<uint32_t, 0xffffffff, 0xffffffff, true, true> {
-	CRC32(): Generator(0x04c11db7) {}
-};
+typedef Generator<uint32_t, 0x04c11db7, 0xffffffff, 0xffffffff, true, true> CRC32;
 
 }
 
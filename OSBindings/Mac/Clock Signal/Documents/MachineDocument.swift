@@ -297,6 +297,11 @@ class MachineDocument:
 		machine.inputMode = .joystick
 	}
 
+	// MARK: Fast forwarding
+	@IBAction func toggleFastForward(_ sender: NSMenuItem?) {
+		machine.fastForward = !machine.fastForward
+	}
+
 	override func validateUserInterfaceItem(_ item: NSValidatedUserInterfaceItem) -> Bool {
 		if let menuItem = item as? NSMenuItem {
 			switch item.action {
@@ -318,6 +323,15 @@ class MachineDocument:
 					menuItem.state = machine.inputMode == .joystick ? .on : .off
 					return true
 
+				case #selector(self.toggleFastForward):
+					if machine == nil {
+						menuItem.state = .off
+						return false
+					}
+
+					menuItem.state = machine.fastForward ? .on : .off
+					return true
+
 				case #selector(self.showActivity(_:)):
 					return self.activityPanel != nil
 
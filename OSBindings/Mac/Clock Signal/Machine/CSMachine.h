@@ -71,6 +71,9 @@ typedef NS_ENUM(NSInteger, CSMachineKeyboardInputMode) {
 @property (nonatomic, assign) CSMachineVideoSignal videoSignal;
 @property (nonatomic, assign) BOOL useAutomaticTapeMotorControl;
 
+/// If set, the machine runs at several times real speed and presents only some of the video fields it produces.
+@property (nonatomic, assign) BOOL fastForward;
+
 @property (nonatomic, readonly) BOOL canInsertMedia;
 
 - (bool)supportsVideoSignal:(CSMachineVideoSignal)videoSignal;
@@ -19,6 +19,7 @@
 #include "StandardOptions.hpp"
 #include "Typer.hpp"
 #include "../../../../Activity/Observer.hpp"
+#include "../../../../Outputs/CRT/Internals/Shaders/Shader.hpp"
 
 #import "CSStaticAnalyser+TargetVector.h"
 #import "NSBundle+DataResource.h"
@@ -26,6 +27,13 @@
 
 #include <bitset>
 
+namespace {
+
+// While fast forwarding, the machine is run for this multiple of real time and only one field in this many is presented.
+const unsigned int FastForwardSpeed = 8;
+
+}
+
 @interface CSMachine() <CSFastLoading>
 - (void)speaker:(Outputs::Speaker::Speaker *)speaker didCompleteSamples:(const int16_t *)samples length:(int)length;
 - (void)speakerDidChangeInputClock:(Outputs::Speaker::Speaker *)speaker;
@@ -214,7 +222,11 @@ struct ActivityObserver: public Activity::Observer {
 				}
 			}
 		}
-		_machine->crt_machine()->run_for(interval);
+
+		// Fast forward by running for a multiple of the requested interval, discarding most fields.
+		Outputs::CRT::CRT *const crt = _machine->crt_machine()->get_crt();
+		if(crt) crt->set_field_decimation(_fastForward ? FastForwardSpeed : 1);
+		_machine->crt_machine()->run_for(_fastForward ? interval * FastForwardSpeed : interval);
 	}
 }
 
@@ -226,6 +238,14 @@ struct ActivityObserver: public Activity::Observer {
 }
 
 - (void)setupOutputWithAspectRatio:(float)aspectRatio {
+	// Cache compiled shaders in this application's caches directory.
+	NSURL *cachesURL = [[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].firstObject;
+	NSURL *shaderCacheURL = [cachesURL URLByAppendingPathComponent:[[NSBundle mainBundle] bundleIdentifier] ?: @"ClockSignal"];
+	shaderCacheURL = [shaderCacheURL URLByAppendingPathComponent:@"Shaders"];
+	if([[NSFileManager defaultManager] createDirectoryAtURL:shaderCacheURL withIntermediateDirectories:YES attributes:nil error:nil]) {
+		OpenGL::Shader::set_program_binary_cache_directory(shaderCacheURL.fileSystemRepresentation);
+	}
+
 	_machine->crt_machine()->setup_output(aspectRatio);
 
 	// Since OS X v10.6, Macs have had a gamma of 2.2.
@@ -510,6 +530,12 @@ struct ActivityObserver: public Activity::Observer {
 	}
 }
 
+- (void)setFastForward:(BOOL)fastForward {
+	@synchronized(self) {
+		_fastForward = fastForward;
+	}
+}
+
 - (NSString *)userDefaultsPrefix {
 	// Assumes that the first machine in the targets list is the source of user defaults.
 	std::string name = Machine::ShortNameForTargetMachine(_analyser.targets.front()->machine);
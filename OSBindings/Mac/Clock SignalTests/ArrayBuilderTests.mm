@@ -63,6 +63,7 @@ static void setData(bool is_input, uint8_t *data, size_t size)
 	for(int c = 0; c < 3; c++) output[c] = c + 0x80;
 
 	arrayBuilder.flush(self.emptyFlushFunction);
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	[self assertMonotonicForInputSize:5 outputSize:3];
@@ -87,6 +88,7 @@ static void setData(bool is_input, uint8_t *data, size_t size)
 	for(int c = 0; c < 2; c++) output[c] = c+2 + 0x80;
 
 	arrayBuilder.flush(self.emptyFlushFunction);
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	[self assertMonotonicForInputSize:4 outputSize:4];
@@ -102,12 +104,14 @@ static void setData(bool is_input, uint8_t *data, size_t size)
 	arrayBuilder.get_input_storage(12);
 	arrayBuilder.get_output_storage(3);
 
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	XCTAssert(inputData.length == 0, @"No input data should have been received; %lu bytes were received", (unsigned long)inputData.length);
 	XCTAssert(outputData.length == 0, @"No output data should have been received; %lu bytes were received", (unsigned long)outputData.length);
 
 	arrayBuilder.flush(self.emptyFlushFunction);
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	XCTAssert(inputData.length == 25, @"All input data should have been received; %lu bytes were received", (unsigned long)inputData.length);
@@ -126,15 +130,58 @@ static void setData(bool is_input, uint8_t *data, size_t size)
 	uint8_t *input = arrayBuilder.get_input_storage(5);
 	uint8_t *output = arrayBuilder.get_output_storage(5);
 
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	for(int c = 0; c < 5; c++) input[c] = c;
 	for(int c = 0; c < 5; c++) output[c] = c + 0x80;
 
 	arrayBuilder.flush(self.emptyFlushFunction);
+	arrayBuilder.stage();
 	arrayBuilder.submit();
 
 	[self assertMonotonicForInputSize:5 outputSize:5];
 }
 
+- (void)testContinuityAcrossGenerations
+{
+	// Only the most recent submission is retained by setData, so accumulate everything submitted here.
+	NSMutableData *allInput = [NSMutableData data], *allOutput = [NSMutableData data];
+	Outputs::CRT::ArrayBuilder arrayBuilder(20, 10, [allInput, allOutput] (bool is_input, uint8_t *data, size_t size) {
+		[is_input ? allInput : allOutput appendBytes:data length:size];
+	});
+
+	// Flush many more bytes than either generation can hold, staging only rarely enough that storage is sometimes
+	// exhausted; flush only after confirming that storage was available, as anything allocated while full is lost.
+	int input_value = 0, output_value = 0;
+	for(int c = 0; c < 200; ++c) {
+		uint8_t *input = arrayBuilder.get_input_storage(2);
+		uint8_t *output = arrayBuilder.get_output_storage(1);
+		if(input && output) {
+			input[0] = (uint8_t)input_value++;
+			input[1] = (uint8_t)input_value++;
+			output[0] = (uint8_t)(output_value++ + 0x80);
+			arrayBuilder.flush(self.emptyFlushFunction);
+		} else {
+			XCTAssert(arrayBuilder.is_full());
+		}
+
+		if(!(c % 17)) {
+			arrayBuilder.stage();
+			arrayBuilder.submit();
+		}
+	}
+	arrayBuilder.stage();
+	arrayBuilder.submit();
+
+	XCTAssertGreaterThan(input_value, 20, @"More data should have been flushed than fits in a single generation");
+	XCTAssertEqual(allInput.length, (NSUInteger)input_value);
+	XCTAssertEqual(allOutput.length, (NSUInteger)output_value);
+
+	const uint8_t *input = (const uint8_t *)allInput.bytes;
+	const uint8_t *output = (const uint8_t *)allOutput.bytes;
+	for(int c = 0; c < allInput.length; c++) XCTAssert(input[c] == (uint8_t)c, @"Input item %d should be %d, was %d", c, (uint8_t)c, input[c]);
+	for(int c = 0; c < allOutput.length; c++) XCTAssert(output[c] == (uint8_t)(c + 0x80), @"Output item %d should be %d, was %d", c, (uint8_t)(c + 0x80), output[c]);
+}
+
 @end
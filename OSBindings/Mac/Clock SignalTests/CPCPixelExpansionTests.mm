@@ -0,0 +1,75 @@
+//
+//  CPCPixelExpansionTests.mm
+//  Clock Signal
+//
+//  Created by Thomas Harte on 19/10/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../../../Machines/AmstradCPC/PixelExpansion.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+@interface CPCPixelExpansionTests : XCTestCase
+@end
+
+@implementation CPCPixelExpansionTests
+
+/// Expands a run of random bytes with random pens and palette, comparing the result with a byte-by-byte expansion.
+- (void)checkExpansionWithPixelsPerByte:(const int)pixelsPerByte {
+	if(!AmstradCPC::PixelExpansion::is_available()) return;
+
+	// Use every possible byte, followed by a run that isn't a multiple of sixteen.
+	std::vector<uint8_t> source(256 + 40);
+	for(size_t c = 0; c < source.size(); ++c) source[c] = (c < 256) ? uint8_t(c) : uint8_t(rand());
+
+	uint8_t palette[16];
+	for(int c = 0; c < 16; ++c) palette[c] = uint8_t(rand());
+
+	// Pens are drawn from disjoint bits, per nibble, so that their OR is always a valid index into the palette.
+	uint8_t pens[8][2][16];
+	for(int pixel = 0; pixel < 8; ++pixel) {
+		for(int c = 0; c < 16; ++c) {
+			pens[pixel][0][c] = uint8_t(rand() & 0x3);
+			pens[pixel][1][c] = uint8_t(rand() & 0xc);
+		}
+	}
+
+	std::vector<uint8_t> expected;
+	for(const auto byte: source) {
+		for(int pixel = 0; pixel < pixelsPerByte; ++pixel) {
+			expected.push_back(palette[pens[pixel][0][byte >> 4] | pens[pixel][1][byte & 0xf]]);
+		}
+	}
+
+	std::vector<uint8_t> pixels(expected.size());
+	switch(pixelsPerByte) {
+		case 2:	AmstradCPC::PixelExpansion::expand<2>(source.data(), source.size(), reinterpret_cast<const uint8_t (&)[2][2][16]>(pens), palette, pixels.data());	break;
+		case 4:	AmstradCPC::PixelExpansion::expand<4>(source.data(), source.size(), reinterpret_cast<const uint8_t (&)[4][2][16]>(pens), palette, pixels.data());	break;
+		case 8:	AmstradCPC::PixelExpansion::expand<8>(source.data(), source.size(), pens, palette, pixels.data());	break;
+	}
+
+	for(size_t c = 0; c < pixels.size(); ++c) {
+		if(pixels[c] != expected[c]) {
+			XCTAssertEqual(pixels[c], expected[c], @"Pixel %zu of byte %02x differs", c % size_t(pixelsPerByte), source[c / size_t(pixelsPerByte)]);
+			break;
+		}
+	}
+}
+
+- (void)testTwoPixelsPerByte {
+	[self checkExpansionWithPixelsPerByte:2];
+}
+
+- (void)testFourPixelsPerByte {
+	[self checkExpansionWithPixelsPerByte:4];
+}
+
+- (void)testEightPixelsPerByte {
+	[self checkExpansionWithPixelsPerByte:8];
+}
+
+@end
@@ -8,7 +8,9 @@
 
 #import <XCTest/XCTest.h>
 #include "CRC.hpp"
+#include <cstdlib>
 #include <string>
+#include <vector>
 
 @interface CRCTests : XCTestCase
 @end
@@ -81,4 +83,46 @@
 	XCTAssertEqual(crcGenerator.get_value(), 0xcbf43926);
 }
 
+- (void)testBufferMatchesBytewise {
+	CRC::CCITT ccittGenerator;
+	CRC::CRC32 crc32Generator;
+
+	for(int c = 0; c < 1000; ++c) {
+		std::vector<uint8_t> data(size_t(rand() % 100));
+		for(auto &byte: data) byte = uint8_t(rand());
+
+		ccittGenerator.reset();
+		crc32Generator.reset();
+		for(auto byte: data) {
+			ccittGenerator.add(byte);
+			crc32Generator.add(byte);
+		}
+
+		XCTAssertEqual(ccittGenerator.get_value(), CRC::CCITT().compute_crc(data));
+		XCTAssertEqual(crc32Generator.get_value(), CRC::CRC32().compute_crc(data));
+	}
+}
+
+- (void)testCRC32Throughput {
+	std::vector<uint8_t> data(16*1024*1024);
+	for(auto &byte: data) byte = uint8_t(rand());
+	std::vector<uint8_t> *const source = &data;
+
+	[self measureBlock:^{
+		CRC::CRC32 crcGenerator;
+		crcGenerator.compute_crc(*source);
+	}];
+}
+
+- (void)testCCITTThroughput {
+	std::vector<uint8_t> data(16*1024*1024);
+	for(auto &byte: data) byte = uint8_t(rand());
+	std::vector<uint8_t> *const source = &data;
+
+	[self measureBlock:^{
+		CRC::CCITT crcGenerator;
+		crcGenerator.compute_crc(*source);
+	}];
+}
+
 @end
@@ -0,0 +1,87 @@
+//
+//  ClockDeferrerTests.mm
+//  Clock Signal
+//
+//  Created by Thomas Harte on 19/10/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../../../ClockReceiver/ClockReceiver.hpp"
+#include "../../../ClockReceiver/ClockDeferrer.hpp"
+
+#include <vector>
+
+@interface ClockDeferrerTests : XCTestCase
+@end
+
+@implementation ClockDeferrerTests
+
+/// Schedules one action for each of @c delays, in the order given, and checks that each is performed at the proper
+/// time, with those due at the same time being performed in the order in which they were scheduled.
+- (void)checkDelays:(const std::vector<int> &)delays {
+	int time = 0;
+	ClockDeferrer<Cycles> deferrer([&time] (Cycles length) {
+		time += length.as_int();
+	});
+
+	struct Performance {
+		int time;
+		std::size_t action;
+	};
+	std::vector<Performance> performances;
+	for(std::size_t c = 0; c < delays.size(); ++c) {
+		deferrer.defer(Cycles(delays[c]), [&performances, &time, c] {
+			performances.push_back({time, c});
+		});
+	}
+
+	// Run in uneven steps, to check that actions are performed part way through a run_for.
+	for(int c = 0; c < 20; ++c) {
+		deferrer.run_for(Cycles(3));
+	}
+	XCTAssertEqual(time, 60);
+	XCTAssertEqual(performances.size(), delays.size());
+
+	for(std::size_t c = 0; c < performances.size(); ++c) {
+		XCTAssertEqual(performances[c].time, delays[performances[c].action], @"Action %zu was performed at the wrong time", performances[c].action);
+
+		if(c) {
+			const std::size_t previous = performances[c-1].action;
+			const std::size_t current = performances[c].action;
+			XCTAssert(
+				delays[previous] < delays[current] || (delays[previous] == delays[current] && previous < current),
+				@"Action %zu was performed after action %zu", current, previous);
+		}
+	}
+}
+
+- (void)testFewOutOfOrder {
+	[self checkDelays:std::vector<int>{7, 2, 7, 1}];
+}
+
+- (void)testManyOutOfOrder {
+	[self checkDelays:std::vector<int>{19, 4, 11, 4, 30, 2, 11, 25, 8, 4, 17, 1, 30, 11, 6, 23, 2, 40, 11, 9}];
+}
+
+/// Checks that actions may be scheduled from within other actions, taking effect relative to the time of scheduling.
+- (void)testDeferralFromAction {
+	int time = 0;
+	ClockDeferrer<Cycles> deferrer([&time] (Cycles length) {
+		time += length.as_int();
+	});
+
+	std::vector<int> performances;
+	deferrer.defer(Cycles(5), [&] {
+		performances.push_back(time);
+		deferrer.defer(Cycles(0), [&] { performances.push_back(time); });
+		deferrer.defer(Cycles(3), [&] { performances.push_back(time); });
+	});
+	deferrer.defer(Cycles(7), [&] { performances.push_back(time); });
+	deferrer.run_for(Cycles(10));
+
+	XCTAssert((performances == std::vector<int>{5, 5, 7, 8}));
+}
+
+@end
@@ -0,0 +1,292 @@
+//
+//  FastSectorTransferTests.mm
+//  Clock Signal
+//
+//  Created by Thomas Harte on 28/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../../../Components/1770/1770.hpp"
+#include "../../../Components/8272/i8272.hpp"
+#include "../../../Storage/Disk/Disk.hpp"
+#include "../../../Storage/Disk/Encodings/MFM/Encoder.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int TrackCount = 40;
+const int SectorsPerTrack = 9;
+const int DeletedSector = 5;
+
+/// A single-sided, 40-track disk of nine 512-byte sectors per track, with sector contents derived from their addresses;
+/// sector 5 of each track is marked as deleted.
+class TestDisk: public Storage::Disk::Disk {
+	public:
+		TestDisk() {
+			for(int track = 0; track < TrackCount; ++track) {
+				std::vector<Storage::Encodings::MFM::Sector> sectors;
+				for(int c = 1; c <= SectorsPerTrack; ++c) {
+					Storage::Encodings::MFM::Sector sector;
+					sector.address.track = static_cast<uint8_t>(track);
+					sector.address.sector = static_cast<uint8_t>(c);
+					sector.size = 2;
+					sector.is_deleted = (c == DeletedSector);
+					sector.samples.emplace_back(512);
+					for(std::size_t byte = 0; byte < 512; ++byte) {
+						sector.samples[0][byte] = static_cast<uint8_t>(track*31 + c*7 + byte);
+					}
+					sectors.push_back(std::move(sector));
+				}
+				tracks_.push_back(Storage::Encodings::MFM::GetMFMTrackWithSectors(sectors));
+			}
+		}
+
+		Storage::Disk::HeadPosition get_maximum_head_position() override	{	return Storage::Disk::HeadPosition(TrackCount);	}
+		int get_head_count() override										{	return 1;	}
+		void set_track_at_position(Storage::Disk::Track::Address address, const std::shared_ptr<Storage::Disk::Track> &track) override {}
+		void flush_tracks() override										{}
+		bool get_is_read_only() override									{	return true;	}
+
+		std::shared_ptr<Storage::Disk::Track> get_track_at_position(Storage::Disk::Track::Address address) override {
+			const int track = address.position.as_int();
+			if(address.head || track < 0 || track >= TrackCount) return nullptr;
+			return tracks_[static_cast<std::size_t>(track)];
+		}
+
+	private:
+		std::vector<std::shared_ptr<Storage::Disk::Track>> tracks_;
+};
+
+/// A 1773 with a permanently-spinning drive containing a TestDisk.
+class TestController: public WD::WD1770 {
+	public:
+		TestController() : WD::WD1770(P1773), drive_(new Storage::Disk::Drive(8000000, 300, 1)) {
+			set_drive(drive_);
+			drive_->set_disk(std::shared_ptr<Storage::Disk::Disk>(new TestDisk));
+			drive_->set_motor_on(true);
+			set_is_double_density(true);
+		}
+
+	private:
+		std::shared_ptr<Storage::Disk::Drive> drive_;
+};
+
+/// An 8272 with a single, permanently-spinning drive containing a TestDisk, and a minimal non-DMA host interface.
+class TestFDC: public Intel::i8272::i8272 {
+	public:
+		TestFDC() : i8272(bus_handler_, Cycles(8000000)), drive_(new Storage::Disk::Drive(8000000, 300, 1)) {
+			set_drive(drive_);
+			drive_->set_disk(std::shared_ptr<Storage::Disk::Disk>(new TestDisk));
+			drive_->set_motor_on(true);
+
+			// Allow the drive to become ready, then specify a 1ms step rate and non-DMA operation.
+			run_for(Cycles(8000000));
+			send({0x03, 0xf1, 0x03});
+		}
+
+		void select_drive(int) override {}
+
+		/// Supplies each byte of @c command when the 8272 is ready for it.
+		void send(const std::vector<uint8_t> &command) {
+			for(const auto byte: command) {
+				while((get_register(0) & 0xc0) != 0x80) step();
+				set_register(1, byte);
+			}
+		}
+
+		/// Collects result bytes until the 8272 is ready for its next command.
+		std::vector<uint8_t> results() {
+			std::vector<uint8_t> result;
+			while(true) {
+				while(!(get_register(0) & 0x80)) step();
+				if(!(get_register(0) & 0x40)) return result;
+				result.push_back(get_register(1));
+				step();
+			}
+		}
+
+		/// Moves the head to @c track, waiting for the seek to complete.
+		void seek(int track) {
+			send({0x0f, 0x00, static_cast<uint8_t>(track)});
+			do {
+				run_for(Cycles(16000));
+				send({0x08});
+			} while(!(results()[0] & 0x20));
+		}
+
+		/*!
+			Performs @c command, collecting any bytes supplied during the execution phase in @c data. If @c disable_after
+			is positive then fast sector transfer is disabled once that many bytes have been received.
+
+			@returns The result phase.
+		*/
+		std::vector<uint8_t> perform(const std::vector<uint8_t> &command, std::vector<uint8_t> &data, int disable_after = 0) {
+			send(command);
+			int received = 0;
+			while(true) {
+				step();
+				const uint8_t status = get_register(0);
+				if((status & 0xc0) != 0xc0) continue;
+				if(!(status & 0x20)) return results();
+
+				data.push_back(get_register(1));
+				++received;
+				if(received == disable_after) set_fast_sector_transfer(false);
+			}
+		}
+
+	private:
+		Intel::i8272::BusHandler bus_handler_;
+		std::shared_ptr<Storage::Disk::Drive> drive_;
+
+		void step() {
+			run_for(Cycles(16));
+		}
+};
+
+/// @returns A read data or read deleted data command, per @c command, for MFM sectors @c first to @c last of @c track.
+std::vector<uint8_t> read_command(uint8_t command, int track, int first, int last) {
+	return {command, 0x00, static_cast<uint8_t>(track), 0x00, static_cast<uint8_t>(first), 0x02, static_cast<uint8_t>(last), 0x2a, 0xff};
+}
+
+}
+
+@interface FastSectorTransferTests : XCTestCase
+@end
+
+@implementation FastSectorTransferTests {
+	long _emulatedCycles;
+}
+
+- (void)runController:(TestController &)controller untilIdleCollectingData:(std::vector<uint8_t> *)data {
+	[self runController:controller untilIdleCollectingData:data disablingFastTransferAfter:0];
+}
+
+- (void)runController:(TestController &)controller untilIdleCollectingData:(std::vector<uint8_t> *)data disablingFastTransferAfter:(int)disableAfter {
+	int received = 0;
+	do {
+		controller.run_for(Cycles(16));
+		_emulatedCycles += 16;
+		if(data && controller.get_data_request_line()) {
+			data->push_back(controller.get_register(3));
+			++received;
+			if(received == disableAfter) controller.set_fast_sector_transfer(false);
+		}
+	} while(controller.get_register(0) & 0x01);
+}
+
+/// Reads every sector of every track, in reverse sector order, using a fresh controller with fast transfer enabled or disabled.
+- (std::vector<uint8_t>)readDiskWithFastTransfer:(BOOL)fastTransfer {
+	TestController controller;
+	controller.set_fast_sector_transfer(fastTransfer, 4);
+	controller.run_for(Cycles(8000000));
+	_emulatedCycles = 0;
+
+	std::vector<uint8_t> data;
+	for(int track = 0; track < TrackCount; ++track) {
+		controller.set_register(3, static_cast<uint8_t>(track));
+		controller.set_register(0, 0x10);	// Seek.
+		[self runController:controller untilIdleCollectingData:nullptr];
+
+		for(int sector = SectorsPerTrack; sector > 0; --sector) {
+			controller.set_register(2, static_cast<uint8_t>(sector));
+			controller.set_register(0, 0x80);	// Read sector.
+			[self runController:controller untilIdleCollectingData:&data];
+			XCTAssertEqual(controller.get_register(0) & 0x1c, 0, @"Track %d sector %d should have been read without error", track, sector);
+		}
+	}
+
+	return data;
+}
+
+- (void)testFastTransferMatchesFluxLevel {
+	const std::vector<uint8_t> fluxData = [self readDiskWithFastTransfer:NO];
+	const long fluxCycles = _emulatedCycles;
+	const std::vector<uint8_t> fastData = [self readDiskWithFastTransfer:YES];
+	const long fastCycles = _emulatedCycles;
+
+	XCTAssertEqual(fluxData.size(), static_cast<std::size_t>(TrackCount * SectorsPerTrack * 512));
+	XCTAssert(fluxData == fastData, @"Fast sector transfer should supply the same data as flux-level decoding");
+	XCTAssertLessThan(fastCycles, fluxCycles, @"Fast sector transfer should load in less emulated time");
+}
+
+- (void)testDisablingFastTransferMidSector {
+	// Start a multiple-sector read with and without fast transfer, disabling fast transfer part way through the
+	// first sector; the remainder of that sector and all subsequent sectors should be unaffected.
+	TestController fluxController, fastController;
+	fastController.set_fast_sector_transfer(true, 4);
+
+	std::vector<uint8_t> fluxData, fastData;
+	for(auto controller: {&fluxController, &fastController}) {
+		controller->run_for(Cycles(8000000));
+		controller->set_register(3, 3);
+		controller->set_register(0, 0x10);	// Seek.
+		[self runController:*controller untilIdleCollectingData:nullptr];
+
+		controller->set_register(2, 2);
+		controller->set_register(0, 0x90);	// Read multiple sectors.
+	}
+	[self runController:fluxController untilIdleCollectingData:&fluxData];
+	[self runController:fastController untilIdleCollectingData:&fastData disablingFastTransferAfter:100];
+
+	XCTAssertEqual(fluxData.size(), static_cast<std::size_t>((SectorsPerTrack - 1) * 512));
+	XCTAssert(fluxData == fastData, @"Disabling fast sector transfer mid-command should not affect the data supplied");
+}
+
+/// Performs @c command on @c track with an 8272, with fast sector transfer enabled or disabled, returning the result phase
+/// and populating @c data with the sector contents received.
+- (std::vector<uint8_t>)perform8272Command:(const std::vector<uint8_t> &)command track:(int)track fastTransfer:(BOOL)fastTransfer disablingAfter:(int)disableAfter data:(std::vector<uint8_t> &)data {
+	TestFDC fdc;
+	fdc.set_fast_sector_transfer(fastTransfer, 4);
+	fdc.seek(track);
+	return fdc.perform(command, data, disableAfter);
+}
+
+- (void)test8272MultipleSectorReadMatchesFluxLevel {
+	// Read data from sectors 1 to 9; this should stop after the deleted sector 5, having read it, with the control mark set.
+	const auto command = read_command(0x46, 7, 1, 9);
+	std::vector<uint8_t> fluxData, fastData, disabledData;
+	const auto fluxResults = [self perform8272Command:command track:7 fastTransfer:NO disablingAfter:0 data:fluxData];
+	const auto fastResults = [self perform8272Command:command track:7 fastTransfer:YES disablingAfter:0 data:fastData];
+	const auto disabledResults = [self perform8272Command:command track:7 fastTransfer:YES disablingAfter:700 data:disabledData];
+
+	XCTAssertEqual(fluxData.size(), static_cast<std::size_t>(DeletedSector * 512));
+	XCTAssertEqual(fluxResults.size(), static_cast<std::size_t>(7));
+	XCTAssertEqual(fluxResults[2] & 0x40, 0x40, @"The control mark should be set upon reaching a deleted sector");
+	XCTAssert(fluxData == fastData, @"Fast sector transfer should supply the same data as flux-level decoding");
+	XCTAssert(fluxResults == fastResults, @"Fast sector transfer should produce the same result phase as flux-level decoding");
+	XCTAssert(fluxData == disabledData, @"Disabling fast sector transfer mid-command should not affect the data supplied");
+	XCTAssert(fluxResults == disabledResults, @"Disabling fast sector transfer mid-command should not affect the result phase");
+}
+
+- (void)test8272DeletedDataMismatchMatchesFluxLevel {
+	// Read deleted data from sectors 5 and 6; sector 5 is deleted but sector 6 isn't, so the read should end with
+	// the control mark set after sector 6.
+	const auto command = read_command(0x4c, 12, 5, 6);
+	std::vector<uint8_t> fluxData, fastData;
+	const auto fluxResults = [self perform8272Command:command track:12 fastTransfer:NO disablingAfter:0 data:fluxData];
+	const auto fastResults = [self perform8272Command:command track:12 fastTransfer:YES disablingAfter:0 data:fastData];
+
+	XCTAssertEqual(fluxData.size(), static_cast<std::size_t>(2 * 512));
+	XCTAssertEqual(fluxResults[2] & 0x40, 0x40, @"The control mark should be set upon reaching a non-deleted sector");
+	XCTAssert(fluxData == fastData, @"Fast sector transfer should supply the same data as flux-level decoding");
+	XCTAssert(fluxResults == fastResults, @"Fast sector transfer should produce the same result phase as flux-level decoding");
+}
+
+- (void)testFluxLevelLoadTime {
+	[self measureBlock:^{
+		[self readDiskWithFastTransfer:NO];
+	}];
+}
+
+- (void)testFastTransferLoadTime {
+	[self measureBlock:^{
+		[self readDiskWithFastTransfer:YES];
+	}];
+}
+
+@end
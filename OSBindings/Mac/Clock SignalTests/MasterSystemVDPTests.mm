@@ -11,6 +11,20 @@
 
 #include "9918.hpp"
 
+namespace {
+
+/// Writes @c count bytes to video RAM from @c address, allowing time for each to land.
+void WriteVideoRAM(TI::TMS::TMS9918 &vdp, int address, const uint8_t *values, int count) {
+	vdp.set_register(1, static_cast<uint8_t>(address));
+	vdp.set_register(1, static_cast<uint8_t>(((address >> 8) & 0x3f) | 0x40));
+	for(int c = 0; c < count; ++c) {
+		vdp.set_register(0, values[c]);
+		vdp.run_for(Cycles(64));
+	}
+}
+
+}
+
 @interface MasterSystemVDPTests : XCTestCase
 @end
 
@@ -116,4 +130,64 @@
 	NSAssert(vdp.get_interrupt_line(), @"Interrupt line wasn't set when promised");
 }
 
+/// @returns @c YES if a frame containing two sprites at the supplied x positions sets the sprite collision flag,
+/// with the VDP being run for @c cycles_per_slice at a time.
+- (BOOL)doSpritesCollideAt:(uint8_t)first_x and:(uint8_t)second_x cyclesPerSlice:(int)cycles_per_slice {
+	TI::TMS::TMS9918 vdp(TI::TMS::Personality::SMSVDP);
+
+	// Select mode 4, and put the sprite attribute and generator tables at 0x3f00 and 0x2000.
+	const uint8_t registers[][2] = {{0x06, 0x80}, {0xff, 0x85}, {0x07, 0x86}};
+	for(const auto &reg: registers) {
+		vdp.set_register(1, reg[0]);
+		vdp.set_register(1, reg[1]);
+	}
+
+	// Sprite 0 has a single opaque pixel at either edge of each row; position two copies of it.
+	uint8_t pattern[32] = {0};
+	for(int c = 0; c < 32; c += 4) pattern[c] = 0x81;
+	WriteVideoRAM(vdp, 0x2000, pattern, 32);
+
+	const uint8_t y[] = {50, 50, 0xd0};
+	WriteVideoRAM(vdp, 0x3f00, y, 3);
+	const uint8_t x_and_name[] = {first_x, 0, second_x, 0};
+	WriteVideoRAM(vdp, 0x3f80, x_and_name, 4);
+
+	// Enable the display, clear status and run for a frame.
+	vdp.set_register(1, 0x40);
+	vdp.set_register(1, 0x81);
+	vdp.get_register(1);
+	for(int c = 0; c < 228 * 262; c += cycles_per_slice) {
+		vdp.run_for(Cycles(cycles_per_slice));
+	}
+
+	return !!(vdp.get_register(1) & 0x20);
+}
+
+- (void)testSpriteCollisions {
+	// Test both with whole lines and with lines that are drawn piecemeal.
+	for(int cycles_per_slice: {228 * 262, 57, 1}) {
+		XCTAssert([self doSpritesCollideAt:100 and:100 cyclesPerSlice:cycles_per_slice]);
+		XCTAssert([self doSpritesCollideAt:100 and:107 cyclesPerSlice:cycles_per_slice]);
+		XCTAssert([self doSpritesCollideAt:100 and:93 cyclesPerSlice:cycles_per_slice]);
+		XCTAssertFalse([self doSpritesCollideAt:100 and:108 cyclesPerSlice:cycles_per_slice]);
+		XCTAssertFalse([self doSpritesCollideAt:100 and:200 cyclesPerSlice:cycles_per_slice]);
+	}
+}
+
+- (void)testFrameTime {
+	TI::TMS::TMS9918 vdp(TI::TMS::Personality::SMSVDP);
+
+	// Enable the display.
+	vdp.set_register(1, 0x40);
+	vdp.set_register(1, 0x81);
+
+	// Measure the time taken to generate video for 100 frames, of 262 lines of 228 cycles each.
+	TI::TMS::TMS9918 *const target = &vdp;
+	[self measureBlock:^{
+		for(int c = 0; c < 100; ++c) {
+			target->run_for(Cycles(228 * 262));
+		}
+	}];
+}
+
 @end
@@ -0,0 +1,44 @@
+//
+//  OricVideoTests.mm
+//  Clock Signal
+//
+//  Created by Thomas Harte on 19/10/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../../../Machines/Oric/Video.hpp"
+
+#include <vector>
+
+@interface OricVideoTests : XCTestCase
+@end
+
+@implementation OricVideoTests
+
+/// Checks that a 60Hz attribute placed partway down an otherwise-unchanged screen takes effect from the next frame,
+/// i.e. that lines retained from earlier 50Hz frames don't restore the old rate when they are output again.
+- (void)testMidFrameSixtyHertzAttribute {
+	// Fill the text screen with printable characters.
+	std::vector<uint8_t> ram(65536);
+	for(int c = 0; c < 28*40; ++c) ram[0xbb80 + c] = 'A';
+
+	Outputs::CRT::CRT::set_default_output_backend(Outputs::CRT::OutputBackend::Software);
+	Oric::VideoOutput video(ram.data());
+	Outputs::CRT::CRT::set_default_output_backend(Outputs::CRT::OutputBackend::OpenGL);
+
+	// Run for long enough for every line to have been retained, stopping some way short of the
+	// next change in blink phase, which would cause every line to be regenerated anyway.
+	for(int line = 0; line < 312*66; ++line) video.run_for(Cycles(64));
+	XCTAssertEqual(video.get_frame_length(), 312*64);
+
+	const uint16_t address = 0xbb80 + 5*40;
+	ram[address] = 0x18;
+	video.mark_written(address);
+
+	for(int line = 0; line < 312*4; ++line) video.run_for(Cycles(64));
+	XCTAssertEqual(video.get_frame_length(), 262*64);
+}
+
+@end
@@ -0,0 +1,266 @@
+//
+//  SoftwareCRTTests.mm
+//  Clock Signal
+//
+//  Created by Thomas Harte on 29/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include "../../../Outputs/CRT/CRT.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace {
+
+const unsigned int FrameWidth = 640;
+const unsigned int FrameHeight = 480;
+
+/// Builds a CRT that uses the software backend, with an RGB sampler for one-byte pixels of the form 0bBGR.
+std::unique_ptr<Outputs::CRT::CRT> MakeCRT(Outputs::CRT::VideoSignal signal) {
+	Outputs::CRT::CRT::set_default_output_backend(Outputs::CRT::OutputBackend::Software);
+	std::unique_ptr<Outputs::CRT::CRT> crt(new Outputs::CRT::CRT(1024, 16, Outputs::CRT::DisplayType::PAL50, 1));
+	Outputs::CRT::CRT::set_default_output_backend(Outputs::CRT::OutputBackend::OpenGL);
+
+	crt->set_rgb_sampling_function(
+		"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
+		"{"
+			"uint sample = texture(sampler, coordinate).r;"
+			"return vec3(uvec3(sample) & uvec3(1u, 2u, 4u));"
+		"}",
+		[] (const uint8_t *source, float *rgb) {
+			rgb[0] = (source[0] & 1) ? 1.0f : 0.0f;
+			rgb[1] = (source[0] & 2) ? 1.0f : 0.0f;
+			rgb[2] = (source[0] & 4) ? 1.0f : 0.0f;
+		});
+	crt->set_video_signal(signal);
+	crt->set_visible_area(Outputs::CRT::Rect(0.1072f, 0.1f, 0.842105263157895f, 0.842105263157895f));
+	return crt;
+}
+
+/// Outputs a single PAL frame of eight vertical colour bars, in the order black, red, green, yellow, blue, magenta, cyan, white.
+void OutputColourBars(Outputs::CRT::CRT &crt) {
+	for(int line = 0; line < 312; ++line) {
+		if(line < 3) {
+			crt.output_sync(1024);
+			continue;
+		}
+
+		crt.output_sync(64);
+		crt.output_blank(32);
+		crt.output_default_colour_burst(64);
+		crt.output_blank(96);
+		uint8_t *const pixels = crt.allocate_write_area(48);
+		if(pixels) {
+			for(int c = 0; c < 48; ++c) pixels[c] = static_cast<uint8_t>(c / 6);
+		}
+		crt.output_data(768, 48);
+	}
+}
+
+/// Outputs the same frame as @c OutputColourBars, but as one batch of spans per line.
+void OutputColourBarSpans(Outputs::CRT::CRT &crt) {
+	using Span = Outputs::CRT::CRT::Span;
+	uint8_t pixels[48];
+	for(int c = 0; c < 48; ++c) pixels[c] = static_cast<uint8_t>(c / 6);
+
+	const Span vertical_sync[] = {Span::sync(1024), Span::sync(1024), Span::sync(1024)};
+	const Span line[] = {Span::sync(64), Span::blank(32), Span::default_colour_burst(64), Span::blank(96), Span::data(768, 48, pixels)};
+
+	crt.output_spans(vertical_sync, 3);
+	for(int c = 3; c < 312; ++c) {
+		crt.output_spans(line, 5);
+	}
+}
+
+}
+
+@interface SoftwareCRTTests : XCTestCase
+@end
+
+@implementation SoftwareCRTTests
+
+- (const uint8_t *)drawColourBarsTo:(Outputs::CRT::CRT &)crt {
+	// Allow the flywheels a few frames to lock.
+	for(int c = 0; c < 10; ++c) {
+		OutputColourBars(crt);
+		crt.draw_frame(FrameWidth, FrameHeight, false);
+	}
+	return crt.get_frame_pixels();
+}
+
+- (void)testRGBColourBars {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::RGB);
+	const uint8_t *const frame = [self drawColourBarsTo:*crt];
+	XCTAssert(frame != nullptr);
+
+	// Sample the centre of each of the final seven bars, on the centre line.
+	const uint8_t expected[7][3] = {
+		{255, 0, 0},	{0, 255, 0},	{255, 255, 0},	{0, 0, 255},
+		{255, 0, 255},	{0, 255, 255},	{255, 255, 255}
+	};
+	for(int bar = 0; bar < 7; ++bar) {
+		const unsigned int x = 140 + static_cast<unsigned int>(bar) * 80;
+		const uint8_t *const pixel = &frame[((FrameHeight / 2) * FrameWidth + x) * 4];
+		for(int channel = 0; channel < 3; ++channel) {
+			XCTAssertEqualWithAccuracy(pixel[channel], expected[bar][channel], 8, @"Bar %d, channel %d", bar + 1, channel);
+		}
+	}
+}
+
+- (void)testRGBPaletteColourBars {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::RGB);
+	crt->set_rgb_palette([] (const uint8_t *source, float *rgb) {
+		rgb[0] = (source[0] & 1) ? 1.0f : 0.0f;
+		rgb[1] = (source[0] & 2) ? 1.0f : 0.0f;
+		rgb[2] = (source[0] & 4) ? 1.0f : 0.0f;
+	});
+	const uint8_t *const frame = [self drawColourBarsTo:*crt];
+
+	// The final bar is white, every channel of which should be fully on.
+	const uint8_t *const pixel = &frame[((FrameHeight / 2) * FrameWidth + 620) * 4];
+	for(int channel = 0; channel < 3; ++channel) {
+		XCTAssertEqualWithAccuracy(pixel[channel], 255, 8, @"Channel %d", channel);
+	}
+}
+
+- (void)testCompositeColourBars {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	const uint8_t *const frame = [self drawColourBarsTo:*crt];
+	XCTAssert(frame != nullptr);
+
+	// Composite decoding is imprecise, so test only that each bar is dominated by the proper primaries;
+	// per the test pattern, the primaries of bar n are the set bits of n.
+	for(int bar = 0; bar < 7; ++bar) {
+		const unsigned int x = 140 + static_cast<unsigned int>(bar) * 80;
+		const uint8_t *const pixel = &frame[((FrameHeight / 2) * FrameWidth + x) * 4];
+		int minimum_on = 255, maximum_off = 0;
+		for(int channel = 0; channel < 3; ++channel) {
+			if((bar + 1) & (1 << channel)) minimum_on = std::min(minimum_on, int(pixel[channel]));
+			else maximum_off = std::max(maximum_off, int(pixel[channel]));
+		}
+		XCTAssertGreaterThan(minimum_on, maximum_off, @"Bar %d should be dominated by its primaries", bar + 1);
+	}
+}
+
+- (void)testCompositeFrameTime {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	[self drawColourBarsTo:*crt];
+	Outputs::CRT::CRT *const target = crt.get();
+	[self measureBlock:^{
+		for(int c = 0; c < 10; ++c) {
+			OutputColourBars(*target);
+			target->draw_frame(FrameWidth, FrameHeight, false);
+		}
+	}];
+}
+
+- (void)testSpansMatchIndividualCalls {
+	std::unique_ptr<Outputs::CRT::CRT> calls_crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	std::unique_ptr<Outputs::CRT::CRT> spans_crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	for(int c = 0; c < 10; ++c) {
+		OutputColourBars(*calls_crt);
+		calls_crt->draw_frame(FrameWidth, FrameHeight, false);
+		OutputColourBarSpans(*spans_crt);
+		spans_crt->draw_frame(FrameWidth, FrameHeight, false);
+	}
+	XCTAssert(!memcmp(calls_crt->get_frame_pixels(), spans_crt->get_frame_pixels(), FrameWidth * FrameHeight * 4));
+}
+
+/// Measures feeding, mostly, by individual calls and then by spans, for comparison.
+- (void)testFeedTime {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	[self drawColourBarsTo:*crt];
+	Outputs::CRT::CRT *const target = crt.get();
+	[self measureBlock:^{
+		for(int c = 0; c < 100; ++c) {
+			OutputColourBars(*target);
+			if(!(c % 10)) target->draw_frame(FrameWidth, FrameHeight, false);
+		}
+	}];
+}
+
+- (void)testSpanFeedTime {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::Composite);
+	[self drawColourBarsTo:*crt];
+	Outputs::CRT::CRT *const target = crt.get();
+	[self measureBlock:^{
+		for(int c = 0; c < 100; ++c) {
+			OutputColourBarSpans(*target);
+			if(!(c % 10)) target->draw_frame(FrameWidth, FrameHeight, false);
+		}
+	}];
+}
+
+- (void)testFieldDecimation {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::RGB);
+	[self drawColourBarsTo:*crt];
+	crt->set_field_decimation(4);
+
+	// Of every four fields, three should be discarded.
+	int discarded_fields = 0;
+	for(int c = 0; c < 40; ++c) {
+		OutputColourBars(*crt);
+		if(crt->is_discarding_field()) {
+			++discarded_fields;
+			XCTAssert(crt->allocate_write_area(1) == nullptr, @"No write area should be supplied while discarding a field");
+			crt->output_data(0, 0);
+		}
+	}
+	XCTAssertEqual(discarded_fields, 30);
+
+	// Presented fields should be unaffected, and presentation should resume immediately.
+	crt->set_field_decimation(1);
+	XCTAssertFalse(crt->is_discarding_field());
+	const uint8_t *const frame = [self drawColourBarsTo:*crt];
+	const uint8_t *const pixel = &frame[((FrameHeight / 2) * FrameWidth + 140) * 4];
+	XCTAssertEqualWithAccuracy(pixel[0], 255, 8);
+	XCTAssertEqualWithAccuracy(pixel[1], 0, 8);
+	XCTAssertEqualWithAccuracy(pixel[2], 0, 8);
+}
+
+/// Feeds frames to a CRT while another thread draws continuously, checking that every draw is of a complete image.
+- (void)testFeedWhileDrawing {
+	std::unique_ptr<Outputs::CRT::CRT> crt = MakeCRT(Outputs::CRT::VideoSignal::RGB);
+	[self drawColourBarsTo:*crt];
+
+	// Once established, the final bar should be white on the centre line of every frame drawn.
+	std::atomic<bool> should_stop(false);
+	std::atomic<int> draws(0), incorrect_draws(0);
+	std::thread draw_thread([&crt, &should_stop, &draws, &incorrect_draws] {
+		while(!should_stop) {
+			crt->draw_frame(FrameWidth, FrameHeight, false);
+			const uint8_t *const pixel = &crt->get_frame_pixels()[((FrameHeight / 2) * FrameWidth + 620) * 4];
+			if(pixel[0] < 247 || pixel[1] < 247 || pixel[2] < 247) ++incorrect_draws;
+			++draws;
+		}
+	});
+
+	for(int frame = 0; frame < 500; ++frame) {
+		OutputColourBars(*crt);
+	}
+
+	should_stop = true;
+	draw_thread.join();
+
+	XCTAssertGreaterThan(draws, 0);
+	XCTAssertEqual(incorrect_draws, 0, @"%d of %d draws were incorrect", incorrect_draws.load(), draws.load());
+
+	// Feeding should have continued uninterrupted, leaving the CRT still in sync.
+	const uint8_t *const frame = [self drawColourBarsTo:*crt];
+	for(int bar = 0; bar < 7; ++bar) {
+		const unsigned int x = 140 + static_cast<unsigned int>(bar) * 80;
+		const uint8_t *const pixel = &frame[((FrameHeight / 2) * FrameWidth + x) * 4];
+		for(int channel = 0; channel < 3; ++channel) {
+			XCTAssertEqualWithAccuracy(pixel[channel], ((bar + 1) & (1 << channel)) ? 255 : 0, 8, @"Bar %d, channel %d", bar + 1, channel);
+		}
+	}
+}
+
+@end
@@ -116,4 +116,20 @@ static void receive_line(uint8_t *next_line)
 	XCTAssert(!memcmp(second_expected_line, line, sizeof(second_expected_line)));
 }
 
+- (void)testMidLinePlayfieldChange
+{
+	// fill PF1 then clear it between the left and right halves of the line; also
+	// rewrite the unchanged PF2 to confirm that doing so doesn't disturb output
+	_tia->set_playfield(1, 0xff);
+	_tia->run_for(Cycles(148));
+	_tia->set_playfield(1, 0x00);
+	_tia->set_playfield(2, 0x00);
+	_tia->run_for(Cycles(80));
+	XCTAssert(line != nullptr, @"228 cycles should have ended the line");
+
+	uint8_t expected_line[160] = {0};
+	memset(&expected_line[16], 1, 32);
+	XCTAssert(!memcmp(expected_line, line, sizeof(expected_line)));
+}
+
 @end
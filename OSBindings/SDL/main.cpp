@@ -8,10 +8,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -26,16 +30,133 @@
 #include "../../Concurrency/BestEffortUpdater.hpp"
 
 #include "../../Activity/Observer.hpp"
+#include "../../Outputs/Capture/OpenGLFrameReader.hpp"
+#include "../../Outputs/Capture/Recorder.hpp"
 #include "../../Outputs/CRT/Internals/Rectangle.hpp"
+#include "../../Outputs/CRT/Internals/Shaders/Shader.hpp"
 
 namespace {
 
+// The size and rate at which video is recorded, if requested.
+const unsigned int CaptureWidth = 640;
+const unsigned int CaptureHeight = 480;
+const unsigned int CaptureFrameRate = 60;
+
+// The interval at which the emulation thread prompts the best-effort updater, independently of display refresh.
+const std::chrono::milliseconds EmulationInterval(2);
+
+// While fast forwarding, the emulated machine is run for this multiple of real time and only one field in this many is presented.
+const unsigned int FastForwardSpeed = 8;
+
+/*!
+	Measures the time from the receipt of input to the presentation of the first frame that could reflect it,
+	and the regularity of frame presentation, periodically logging a summary.
+
+	@c update_did_complete is called from the emulation; all other methods from the main thread.
+*/
+class LatencyMonitor {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/// Notes that input, which arrived at @c time, has just been delivered to the machine.
+		void input_received(Clock::time_point time) {
+			if(!has_pending_input_) {
+				has_pending_input_ = true;
+				pending_input_time_ = time;
+				pending_input_delivery_time_ = Clock::now();
+			}
+		}
+
+		/// Notes that an emulation update that began at @c start_time has completed.
+		void update_did_complete(Clock::time_point start_time) {
+			latest_completed_update_ = start_time.time_since_epoch().count();
+		}
+
+		/// Notes that a frame is about to be drawn; it will reflect all updates that have completed so far.
+		void frame_will_draw() {
+			drawn_update_ = Clock::time_point(Clock::duration(latest_completed_update_.load()));
+		}
+
+		/// Notes that the most-recently drawn frame has been presented.
+		void frame_did_present() {
+			const Clock::time_point now = Clock::now();
+			if(has_previous_presentation_) frame_intervals_.add(now - previous_presentation_);
+			else previous_report_ = now;
+			has_previous_presentation_ = true;
+			previous_presentation_ = now;
+
+			// Input is reflected if the machine began an update after it was delivered, and completed that
+			// update before this frame was drawn.
+			if(has_pending_input_ && drawn_update_ >= pending_input_delivery_time_) {
+				latencies_.add(now - pending_input_time_);
+				has_pending_input_ = false;
+			}
+
+			if(now - previous_report_ >= std::chrono::seconds(5)) {
+				previous_report_ = now;
+				std::cout << "Frame interval: " << frame_intervals_.mean() << "ms mean, " << frame_intervals_.deviation() << "ms jitter";
+				if(latencies_.count) {
+					std::cout << "; input latency: " << latencies_.mean() << "ms mean, " << latencies_.deviation() << "ms jitter, " << latencies_.maximum << "ms worst over " << latencies_.count << " inputs";
+				}
+				std::cout << std::endl;
+				frame_intervals_ = Statistics();
+				latencies_ = Statistics();
+			}
+		}
+
+	private:
+		struct Statistics {
+			int count = 0;
+			double total = 0.0, total_of_squares = 0.0, maximum = 0.0;
+
+			void add(Clock::duration duration) {
+				const double milliseconds = std::chrono::duration<double, std::milli>(duration).count();
+				++count;
+				total += milliseconds;
+				total_of_squares += milliseconds * milliseconds;
+				maximum = std::max(maximum, milliseconds);
+			}
+			double mean() const {
+				return count ? total / count : 0.0;
+			}
+			double deviation() const {
+				return count ? std::sqrt(std::max(total_of_squares / count - mean() * mean(), 0.0)) : 0.0;
+			}
+		} frame_intervals_, latencies_;
+
+		std::atomic<Clock::rep> latest_completed_update_{0};
+		Clock::time_point drawn_update_;
+
+		bool has_pending_input_ = false;
+		Clock::time_point pending_input_time_, pending_input_delivery_time_;
+
+		bool has_previous_presentation_ = false;
+		Clock::time_point previous_presentation_, previous_report_;
+};
+
 struct BestEffortUpdaterDelegate: public Concurrency::BestEffortUpdater::Delegate {
 	void update(Concurrency::BestEffortUpdater *updater, Time::Seconds duration, bool did_skip_previous_update) override {
-		machine->crt_machine()->run_for(duration);
+		const LatencyMonitor::Clock::time_point start_time = LatencyMonitor::Clock::now();
+
+		// Apply any change in fast-forward state here, on the emulation thread, so that the CRT needn't be thread safe.
+		const bool fast_forward = is_fast_forwarding;
+		Outputs::CRT::CRT *const crt = machine->crt_machine()->get_crt();
+		if(crt) crt->set_field_decimation(fast_forward ? FastForwardSpeed : 1);
+
+		const Time::Seconds emulated_duration = fast_forward ? duration * FastForwardSpeed : duration;
+		machine->crt_machine()->run_for(emulated_duration);
+		emulated_time = emulated_time + emulated_duration;
+		if(latency_monitor) latency_monitor->update_did_complete(start_time);
 	}
 
 	Machine::DynamicMachine *machine;
+	LatencyMonitor *latency_monitor = nullptr;
+
+	// The total amount of time emulated so far; this is used to timestamp captured frames.
+	std::atomic<Time::Seconds> emulated_time{0.0};
+
+	// Set to run the machine at FastForwardSpeed times real time, presenting only some of its fields.
+	std::atomic<bool> is_fast_forwarding{false};
 };
 
 struct SpeakerDelegate: public Outputs::Speaker::Speaker::Delegate {
@@ -43,6 +164,8 @@ struct SpeakerDelegate: public Outputs::Speaker::Speaker::Delegate {
 	static const int buffer_size = 1024;
 
 	void speaker_did_complete_samples(Outputs::Speaker::Speaker *speaker, const std::vector<int16_t> &buffer) override {
+		if(recorder) recorder->add_samples(buffer);
+
 		std::lock_guard<std::mutex> lock_guard(audio_buffer_mutex_);
 		if(audio_buffer_.size() > buffer_size) {
 			audio_buffer_.erase(audio_buffer_.begin(), audio_buffer_.end() - buffer_size);
@@ -71,6 +194,7 @@ struct SpeakerDelegate: public Outputs::Speaker::Speaker::Delegate {
 
 	SDL_AudioDeviceID audio_device;
 	Concurrency::BestEffortUpdater *updater;
+	Outputs::Capture::Recorder *recorder = nullptr;
 
 	std::mutex audio_buffer_mutex_;
 	std::vector<int16_t> audio_buffer_;
@@ -308,12 +432,14 @@ int main(int argc, char *argv[]) {
 	ParsedArguments arguments = parse_arguments(argc, argv);
 
 	// This may be printed either as
-	const std::string usage_suffix = " [file] [OPTIONS] [--rompath={path to ROMs}]";
+	const std::string usage_suffix = " [file] [OPTIONS] [--rompath={path to ROMs}] [--capture={path to recording}] [--latency]";
 
 	// Print a help message if requested.
 	if(arguments.selections.find("help") != arguments.selections.end() || arguments.selections.find("h") != arguments.selections.end()) {
 		std::cout << "Usage: " << final_path_component(argv[0]) << usage_suffix << std::endl;
-		std::cout << "Use alt+enter to toggle full screen display. Use control+shift+V to paste text." << std::endl;
+		std::cout << "Use alt+enter to toggle full screen display. Use control+shift+V to paste text. Use control+shift+F to toggle fast forwarding." << std::endl;
+		std::cout << "Use --capture to record video as {path}.y4m and audio as {path}.wav; add --capture-rgb to record raw RGB video as {path}.rgb instead." << std::endl;
+		std::cout << "Use --latency to log input-to-display latency and frame timing periodically." << std::endl;
 		std::cout << "Required machine type and configuration is determined from the file. Machines with further options:" << std::endl << std::endl;
 
 		auto all_options = Machine::AllOptionsByMachineName();
@@ -433,6 +559,11 @@ int main(int argc, char *argv[]) {
 	}
 
 	best_effort_updater_delegate.machine = machine.get();
+	std::unique_ptr<LatencyMonitor> latency_monitor;
+	if(arguments.selections.find("latency") != arguments.selections.end()) {
+		latency_monitor.reset(new LatencyMonitor);
+		best_effort_updater_delegate.latency_monitor = latency_monitor.get();
+	}
 	speaker_delegate.updater = &updater;
 	updater.set_delegate(&best_effort_updater_delegate);
 
@@ -466,6 +597,17 @@ int main(int argc, char *argv[]) {
 	GLint target_framebuffer = 0;
 	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target_framebuffer);
 
+	// Cache compiled shaders in $XDG_CACHE_HOME/CLK, falling back on ~/.cache/CLK.
+	const char *const cache_home = getenv("XDG_CACHE_HOME");
+	const char *const home = getenv("HOME");
+	if(cache_home || home) {
+		const std::string cache_directory = cache_home ? std::string(cache_home) : std::string(home) + "/.cache";
+		mkdir(cache_directory.c_str(), 0700);
+		const std::string shader_cache_directory = cache_directory + "/CLK";
+		mkdir(shader_cache_directory.c_str(), 0700);
+		OpenGL::Shader::set_program_binary_cache_directory(shader_cache_directory);
+	}
+
 	// Setup output, assuming a CRT machine for now, and prepare a best-effort updater.
 	machine->crt_machine()->setup_output(4.0 / 3.0);
 	machine->crt_machine()->get_crt()->set_output_gamma(2.2f);
@@ -473,10 +615,10 @@ int main(int argc, char *argv[]) {
 
 	// For now, lie about audio output intentions.
 	auto speaker = machine->crt_machine()->get_speaker();
+	SDL_AudioSpec obtained_audio_spec;
 	if(speaker) {
 		// Create an audio pipe.
 		SDL_AudioSpec desired_audio_spec;
-		SDL_AudioSpec obtained_audio_spec;
 
 		SDL_zero(desired_audio_spec);
 		desired_audio_spec.freq = 48000;	// TODO: how can I get SDL to reveal the output rate of this machine?
@@ -490,6 +632,31 @@ int main(int argc, char *argv[]) {
 
 		speaker->set_output_rate(obtained_audio_spec.freq, desired_audio_spec.samples);
 		speaker->set_delegate(&speaker_delegate);
+	}
+
+	// If requested, start recording. This needs to happen before emulation begins, so that emulated
+	// time and the audio stream both begin with the recording.
+	std::unique_ptr<Outputs::Capture::Recorder> recorder;
+	std::unique_ptr<Outputs::Capture::OpenGLFrameReader> frame_reader;
+	if(arguments.selections.find("capture") != arguments.selections.end()) {
+		const std::string capture_path = arguments.selections["capture"]->list_selection()->value;
+		const bool is_rgb = arguments.selections.find("capture-rgb") != arguments.selections.end();
+		try {
+			recorder.reset(new Outputs::Capture::Recorder(
+				capture_path + (is_rgb ? ".rgb" : ".y4m"),
+				is_rgb ? Outputs::Capture::Recorder::VideoFormat::RGB : Outputs::Capture::Recorder::VideoFormat::Y4M,
+				CaptureWidth, CaptureHeight, CaptureFrameRate,
+				speaker ? capture_path + ".wav" : "",
+				speaker ? static_cast<unsigned int>(obtained_audio_spec.freq) : 0));
+		} catch(Storage::FileHolder::Error) {
+			std::cerr << "Could not open " << capture_path << " for recording" << std::endl;
+			return -1;
+		}
+		frame_reader.reset(new Outputs::Capture::OpenGLFrameReader);
+		speaker_delegate.recorder = recorder.get();
+	}
+
+	if(speaker) {
 		SDL_PauseAudioDevice(speaker_delegate.audio_device, 0);
 	}
 
@@ -578,6 +745,16 @@ int main(int argc, char *argv[]) {
 		activity_observer.reset(new ActivityObserver(activity_source, 4.0f / 3.0f));
 	}
 
+	// Run the emulation on a thread of its own, so that its pacing is independent of display refresh; the CRT
+	// accepts output asynchronously and each call to draw_frame presents the newest available.
+	std::atomic<bool> emulation_should_run(true);
+	std::thread emulation_thread([&updater, &emulation_should_run] {
+		while(emulation_should_run) {
+			updater.update();
+			std::this_thread::sleep_for(EmulationInterval);
+		}
+	});
+
 	// Run the main event loop until the OS tells us to quit.
 	bool should_quit = false;
 	Uint32 fullscreen_mode = 0;
@@ -617,6 +794,13 @@ int main(int argc, char *argv[]) {
 						}
 					}
 
+					// Capture ctrl+shift+f as a toggle-fast-forwarding command.
+					if(event.key.keysym.sym == SDLK_f && (SDL_GetModState()&KMOD_CTRL) && (SDL_GetModState()&KMOD_SHIFT)) {
+						if(!event.key.repeat)
+							best_effort_updater_delegate.is_fast_forwarding = !best_effort_updater_delegate.is_fast_forwarding;
+						break;
+					}
+
 					// Capture ctrl+shift+d as a take-a-screenshot command.
 					if(event.key.keysym.sym == SDLK_d && (SDL_GetModState()&KMOD_CTRL) && (SDL_GetModState()&KMOD_SHIFT)) {
 						// Pick a width to capture that will preserve a 4:3 output aspect ratio.
@@ -731,6 +915,12 @@ int main(int argc, char *argv[]) {
 
 				default: break;
 			}
+
+			// Note the time at which any input occurred, allowing for its time in the event queue.
+			if(latency_monitor && (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)) {
+				latency_monitor->input_received(
+					LatencyMonitor::Clock::now() - std::chrono::milliseconds(SDL_GetTicks() - event.key.timestamp));
+			}
 		}
 
 		// Push new joystick state, if any.
@@ -782,10 +972,28 @@ int main(int argc, char *argv[]) {
 		}
 
 		// Display a new frame and wait for vsync.
-		updater.update();
+		if(latency_monitor) latency_monitor->frame_will_draw();
 		machine->crt_machine()->get_crt()->draw_frame(static_cast<unsigned int>(window_width), static_cast<unsigned int>(window_height), false);
+		if(frame_reader) {
+			// Capture the 4:3 portion of the display, prior to the addition of activity indicators.
+			const int proportional_width = (window_height * 4) / 3;
+			frame_reader->read(*recorder, (window_width - proportional_width) >> 1, 0, proportional_width, window_height, best_effort_updater_delegate.emulated_time);
+		}
 		if(activity_observer) activity_observer->draw();
 		SDL_GL_SwapWindow(window);
+		if(latency_monitor) latency_monitor->frame_did_present();
+	}
+
+	// Stop emulation, then complete any recording.
+	emulation_should_run = false;
+	emulation_thread.join();
+	if(speaker) SDL_PauseAudioDevice(speaker_delegate.audio_device, 1);
+	updater.flush();
+	if(frame_reader) {
+		speaker_delegate.recorder = nullptr;
+		frame_reader->flush(*recorder);
+		frame_reader.reset();
+		recorder.reset();
 	}
 
 	// Clean up.
@@ -8,15 +8,23 @@
 
 #include "CRT.hpp"
 #include "Internals/CRTOpenGL.hpp"
+#include "Internals/SoftwareOutputBuilder.hpp"
 #include <cstdarg>
 #include <cmath>
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 using namespace Outputs::CRT;
 
+OutputBackend CRT::default_output_backend_ = OutputBackend::OpenGL;
+
+void CRT::set_default_output_backend(OutputBackend backend) {
+	default_output_backend_ = backend;
+}
+
 void CRT::set_new_timing(unsigned int cycles_per_line, unsigned int height_of_display, ColourSpace colour_space, unsigned int colour_cycle_numerator, unsigned int colour_cycle_denominator, unsigned int vertical_sync_half_lines, bool should_alternate) {
-	openGL_output_builder_.set_colour_format(colour_space, colour_cycle_numerator, colour_cycle_denominator);
+	output_builder_->set_colour_format(colour_space, colour_cycle_numerator, colour_cycle_denominator);
 
 	const unsigned int millisecondsHorizontalRetraceTime = 7;	// source: Dictionary of Video and Television Technology, p. 234
 	const unsigned int scanlinesVerticalRetraceTime = 8;		// source: ibid
@@ -58,7 +66,7 @@ void CRT::set_new_timing(unsigned int cycles_per_line, unsigned int height_of_di
 	unsigned int real_clock_scan_period = (multiplied_cycles_per_line * height_of_display) / (time_multiplier_ * common_output_divisor_);
 	vertical_flywheel_output_divider_ = static_cast<uint16_t>(ceilf(real_clock_scan_period / 65536.0f) * (time_multiplier_ * common_output_divisor_));
 
-	openGL_output_builder_.set_timing(cycles_per_line, multiplied_cycles_per_line, height_of_display, horizontal_flywheel_->get_scan_period(), vertical_flywheel_->get_scan_period(), vertical_flywheel_output_divider_);
+	output_builder_->set_timing(cycles_per_line, multiplied_cycles_per_line, height_of_display, horizontal_flywheel_->get_scan_period(), vertical_flywheel_->get_scan_period(), vertical_flywheel_output_divider_);
 }
 
 void CRT::set_new_display_type(unsigned int cycles_per_line, DisplayType displayType) {
@@ -95,12 +103,17 @@ void CRT::set_output_gamma(float gamma) {
 
 void CRT::update_gamma() {
 	float gamma_ratio = input_gamma_ / output_gamma_;
-	openGL_output_builder_.set_gamma(gamma_ratio);
+	output_builder_->set_gamma(gamma_ratio);
 }
 
 CRT::CRT(unsigned int common_output_divisor, unsigned int buffer_depth) :
 	common_output_divisor_(common_output_divisor),
-	openGL_output_builder_(buffer_depth) {}
+	pending_commands_(nullptr) {
+	switch(default_output_backend_) {
+		case OutputBackend::OpenGL:		output_builder_.reset(new OpenGLOutputBuilder(buffer_depth));	break;
+		case OutputBackend::Software:	output_builder_.reset(new SoftwareOutputBuilder(buffer_depth));	break;
+	}
+}
 
 CRT::CRT(	unsigned int cycles_per_line,
 			unsigned int common_output_divisor,
@@ -119,6 +132,102 @@ CRT::CRT(unsigned int cycles_per_line, unsigned int common_output_divisor, Displ
 	set_new_display_type(cycles_per_line, displayType);
 }
 
+CRT::~CRT() {
+	Command *command = pending_commands_.exchange(nullptr);
+	while(command) {
+		Command *const next = command->next;
+		delete command;
+		command = next;
+	}
+}
+
+// MARK: - Output builder commands
+
+void CRT::enqueue_command(std::unique_ptr<Command> command) {
+	Command *const new_head = command.release();
+	new_head->next = pending_commands_.load(std::memory_order_relaxed);
+	while(!pending_commands_.compare_exchange_weak(new_head->next, new_head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void CRT::perform_commands() {
+	// Take all pending commands, and reverse them into the order in which they were enqueued.
+	Command *command = pending_commands_.exchange(nullptr, std::memory_order_acquire);
+	Command *ordered_commands = nullptr;
+	while(command) {
+		Command *const next = command->next;
+		command->next = ordered_commands;
+		ordered_commands = command;
+		command = next;
+	}
+
+	while(ordered_commands) {
+		std::unique_ptr<Command> command(ordered_commands);
+		ordered_commands = command->next;
+
+		switch(command->type) {
+			case Command::Type::SetTargetFramebuffer:
+				output_builder_->set_target_framebuffer(command->framebuffer);
+			break;
+			case Command::Type::SetOpenGLContextWillChange:
+				output_builder_->set_openGL_context_will_change(command->should_delete_resources);
+			break;
+			case Command::Type::SetCompositeSamplingFunction:
+				output_builder_->set_composite_sampling_function(command->shader, command->composite_sampler);
+			break;
+			case Command::Type::SetSVideoSamplingFunction:
+				output_builder_->set_svideo_sampling_function(command->shader, command->svideo_sampler);
+			break;
+			case Command::Type::SetRGBSamplingFunction:
+				output_builder_->set_rgb_sampling_function(command->shader, command->rgb_sampler);
+				output_builder_->set_rgb_palette(std::vector<uint8_t>());
+			break;
+			case Command::Type::SetRGBPalette:
+				output_builder_->set_rgb_sampling_function(command->shader, command->rgb_sampler);
+				output_builder_->set_rgb_palette(command->palette);
+			break;
+			case Command::Type::SetVideoSignal:
+				output_builder_->set_video_signal(command->video_signal);
+			break;
+			case Command::Type::SetVisibleArea:
+				output_builder_->set_visible_area(command->visible_area);
+			break;
+		}
+	}
+}
+
+void CRT::set_rgb_palette(const RGBSampler &palette) {
+	// Evaluate the palette for every possible byte, both as floats for the software backend's sampler
+	// and as bytes for upload to the GPU.
+	std::shared_ptr<std::vector<float>> table(new std::vector<float>(256 * 3));
+	std::unique_ptr<Command> command(new Command(Command::Type::SetRGBPalette));
+	command->palette.resize(256 * 4);
+	for(int c = 0; c < 256; ++c) {
+		const uint8_t source = static_cast<uint8_t>(c);
+		float *const rgb = &(*table)[c * 3];
+		palette(&source, rgb);
+
+		for(int channel = 0; channel < 3; ++channel) {
+			rgb[channel] = std::max(0.0f, std::min(1.0f, rgb[channel]));
+			command->palette[c * 4 + channel] = static_cast<uint8_t>(rgb[channel] * 255.0f + 0.5f);
+		}
+		command->palette[c * 4 + 3] = 0xff;
+	}
+
+	command->shader =
+		"uniform sampler2D rgbPalette;"
+		"vec3 rgb_sample(usampler2D sampler, vec2 coordinate)"
+		"{"
+			"return texelFetch(rgbPalette, ivec2(int(texture(sampler, coordinate).r), 0), 0).rgb;"
+		"}";
+	command->rgb_sampler = [table] (const uint8_t *source, float *rgb) {
+		const float *const entry = &(*table)[source[0] * 3];
+		rgb[0] = entry[0];
+		rgb[1] = entry[1];
+		rgb[2] = entry[2];
+	};
+	enqueue_command(std::move(command));
+}
+
 // MARK: - Sync loop
 
 Flywheel::SyncEvent CRT::get_next_vertical_sync_event(bool vsync_is_requested, unsigned int cycles_to_run_for, unsigned int *cycles_advanced) {
@@ -141,7 +250,6 @@ Flywheel::SyncEvent CRT::get_next_horizontal_sync_event(bool hsync_is_requested,
 #define source_amplitude()			next_run[SourceVertexOffsetOfPhaseTimeAndAmplitude + 1]
 
 void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bool vsync_requested, const Scan::Type type) {
-	std::unique_lock<std::mutex> output_lock = openGL_output_builder_.get_output_lock();
 	number_of_cycles *= time_multiplier_;
 
 	bool is_output_run = ((type == Scan::Type::Level) || (type == Scan::Type::Data));
@@ -163,12 +271,12 @@ void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bo
 
 		bool is_output_segment = ((is_output_run && next_run_length) && !horizontal_flywheel_->is_in_retrace() && !vertical_flywheel_->is_in_retrace());
 		uint8_t *next_run = nullptr;
-		if(is_output_segment && !openGL_output_builder_.composite_output_buffer_is_full()) {
-			bool did_retain_source_data = openGL_output_builder_.texture_builder.retain_latest();
+		if(is_output_segment && !is_discarding_field_ && !discarded_latest_allocation_ && !output_builder_->composite_output_buffer_is_full()) {
+			bool did_retain_source_data = output_builder_->texture_builder.retain_latest();
 			if(did_retain_source_data) {
-				next_run = openGL_output_builder_.array_builder.get_input_storage(SourceVertexSize);
+				next_run = output_builder_->array_builder.get_input_storage(SourceVertexSize);
 				if(!next_run) {
-					openGL_output_builder_.texture_builder.discard_latest();
+					output_builder_->texture_builder.discard_latest();
 				}
 			}
 		}
@@ -205,20 +313,30 @@ void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bo
 
 		if(next_run_length == time_until_horizontal_sync_event && next_horizontal_sync_event == Flywheel::SyncEvent::StartRetrace) is_alernate_line_ ^= phase_alternates_;
 
+		// at the end of vertical retrace, a new field begins; determine whether it will be presented
+		if(next_run_length == time_until_vertical_sync_event && next_vertical_sync_event == Flywheel::SyncEvent::EndRetrace) {
+			fields_since_presentation_ = (fields_since_presentation_ + 1) % field_decimation_;
+			is_discarding_field_ = fields_since_presentation_ != 0;
+		}
+
 		if(needs_endpoint) {
-			if(
-				!openGL_output_builder_.array_builder.is_full() &&
-				!openGL_output_builder_.composite_output_buffer_is_full()) {
+			if(is_discarding_field_) {
+				// no scans are recorded for discarded fields, but runs are otherwise tracked as usual
+				if(is_writing_composite_run_) colour_burst_amplitude_ = 0;
+				is_writing_composite_run_ ^= true;
+			} else if(
+				!output_builder_->array_builder.is_full() &&
+				!output_builder_->composite_output_buffer_is_full()) {
 
 				if(!is_writing_composite_run_) {
 					output_run_.x1 = static_cast<uint16_t>(horizontal_flywheel_->get_current_output_position());
 					output_run_.y = static_cast<uint16_t>(vertical_flywheel_->get_current_output_position() / vertical_flywheel_output_divider_);
 				} else {
 					// Get and write all those previously unwritten output ys
-					const uint16_t output_y = openGL_output_builder_.get_composite_output_y();
+					const uint16_t output_y = output_builder_->get_composite_output_y();
 
 					// Construct the output run
-					uint8_t *next_output_run = openGL_output_builder_.array_builder.get_output_storage(OutputVertexSize);
+					uint8_t *next_output_run = output_builder_->array_builder.get_output_storage(OutputVertexSize);
 					if(next_output_run) {
 						output_x1() = output_run_.x1;
 						output_position_y() = output_run_.y;
@@ -228,9 +346,9 @@ void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bo
 
 					// TODO: below I've assumed a one-to-one correspondance with output runs and input data; that's
 					// obviously not completely sustainable. It's a latent bug.
-					openGL_output_builder_.array_builder.flush(
+					output_builder_->array_builder.flush(
 						[=] (uint8_t *input_buffer, std::size_t input_size, uint8_t *output_buffer, std::size_t output_size) {
-							openGL_output_builder_.texture_builder.flush(
+							output_builder_->texture_builder.flush(
 								[=] (const std::vector<TextureBuilder::WriteArea> &write_areas, std::size_t number_of_write_areas) {
 //									assert(number_of_write_areas * SourceVertexSize == input_size);
 									if(number_of_write_areas * SourceVertexSize == input_size) {
@@ -251,8 +369,8 @@ void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bo
 			}
 		}
 
-		if(next_run_length == time_until_horizontal_sync_event && next_horizontal_sync_event == Flywheel::SyncEvent::StartRetrace) {
-			openGL_output_builder_.increment_composite_output_y();
+		if(next_run_length == time_until_horizontal_sync_event && next_horizontal_sync_event == Flywheel::SyncEvent::StartRetrace && !is_discarding_field_) {
+			output_builder_->increment_composite_output_y();
 		}
 
 		// if this is vertical retrace then adcance a field
@@ -260,9 +378,7 @@ void CRT::advance_cycles(unsigned int number_of_cycles, bool hsync_requested, bo
 			if(delegate_) {
 				frames_since_last_delegate_call_++;
 				if(frames_since_last_delegate_call_ == 20) {
-					output_lock.unlock();
 					delegate_->crt_did_end_batch_of_frames(this, frames_since_last_delegate_call_, vertical_flywheel_->get_and_reset_number_of_surprises());
-					output_lock.lock();
 					frames_since_last_delegate_call_ = 0;
 				}
 			}
@@ -366,7 +482,7 @@ void CRT::output_blank(unsigned int number_of_cycles) {
 }
 
 void CRT::output_level(unsigned int number_of_cycles) {
-	openGL_output_builder_.texture_builder.reduce_previous_allocation_to(1);
+	if(!discarded_latest_allocation_) output_builder_->texture_builder.reduce_previous_allocation_to(1);
 	Scan scan;
 	scan.type = Scan::Type::Level;
 	scan.number_of_cycles = number_of_cycles;
@@ -386,13 +502,58 @@ void CRT::output_default_colour_burst(unsigned int number_of_cycles) {
 	output_colour_burst(number_of_cycles, static_cast<uint8_t>((phase_numerator_ * 256) / phase_denominator_));
 }
 
+void CRT::output_spans(const Span *spans, std::size_t number_of_spans) {
+	TextureBuilder &texture_builder = output_builder_->texture_builder;
+
+	Scan scan;
+	for(std::size_t c = 0; c < number_of_spans; ++c) {
+		const Span &span = spans[c];
+		scan.number_of_cycles = span.number_of_cycles;
+
+		switch(span.type) {
+			case Span::Type::Sync:	scan.type = Scan::Type::Sync;	break;
+			case Span::Type::Blank:	scan.type = Scan::Type::Blank;	break;
+
+			case Span::Type::ColourBurst:
+			case Span::Type::DefaultColourBurst:
+				scan.type = Scan::Type::ColourBurst;
+				scan.phase = (span.type == Span::Type::ColourBurst) ? span.phase : static_cast<uint8_t>((phase_numerator_ * 256) / phase_denominator_);
+				scan.amplitude = ((span.type == Span::Type::ColourBurst) ? span.amplitude : 102) >> 1;
+			break;
+
+			case Span::Type::Level:
+			case Span::Type::Data:
+				scan.type = (span.type == Span::Type::Level) ? Scan::Type::Level : Scan::Type::Data;
+
+				// Supplied samples are copied to a new write area, exactly as if the caller had allocated it.
+				if(span.source) {
+					discarded_latest_allocation_ = is_discarding_field_;
+					if(!discarded_latest_allocation_) {
+						uint8_t *const target = texture_builder.allocate_write_area(span.number_of_samples);
+						if(target) std::memcpy(target, span.source, span.number_of_samples * texture_builder.get_bytes_per_pixel());
+					}
+				}
+				if(!discarded_latest_allocation_) texture_builder.reduce_previous_allocation_to(span.number_of_samples);
+			break;
+		}
+
+		output_scan(&scan);
+	}
+}
+
+void CRT::set_field_decimation(unsigned int field_interval) {
+	field_decimation_ = std::max(field_interval, 1u);
+	fields_since_presentation_ %= field_decimation_;
+	is_discarding_field_ = fields_since_presentation_ != 0;
+}
+
 void CRT::set_immediate_default_phase(float phase) {
 	phase = fmodf(phase, 1.0f);
 	phase_numerator_ = static_cast<unsigned int>(phase * static_cast<float>(phase_denominator_));
 }
 
 void CRT::output_data(unsigned int number_of_cycles, unsigned int number_of_samples) {
-	openGL_output_builder_.texture_builder.reduce_previous_allocation_to(number_of_samples);
+	if(!discarded_latest_allocation_) output_builder_->texture_builder.reduce_previous_allocation_to(number_of_samples);
 	Scan scan;
 	scan.type = Scan::Type::Data;
 	scan.number_of_cycles = number_of_cycles;
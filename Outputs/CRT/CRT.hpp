@@ -9,13 +9,13 @@
 #ifndef CRT_hpp
 #define CRT_hpp
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 
 #include "CRTTypes.hpp"
 #include "Internals/Flywheel.hpp"
-#include "Internals/CRTOpenGL.hpp"
-#include "Internals/ArrayBuilder.hpp"
-#include "Internals/TextureBuilder.hpp"
+#include "Internals/OutputBuilder.hpp"
 
 namespace Outputs {
 namespace CRT {
@@ -67,8 +67,9 @@ class CRT {
 		Flywheel::SyncEvent get_next_vertical_sync_event(bool vsync_is_requested, unsigned int cycles_to_run_for, unsigned int *cycles_advanced);
 		Flywheel::SyncEvent get_next_horizontal_sync_event(bool hsync_is_requested, unsigned int cycles_to_run_for, unsigned int *cycles_advanced);
 
-		// OpenGL state
-		OpenGLOutputBuilder openGL_output_builder_;
+		// The output builder, which determines how scans become pixels.
+		std::unique_ptr<OutputBuilder> output_builder_;
+		static OutputBackend default_output_backend_;
 
 		// temporary storage used during the construction of output runs
 		struct {
@@ -79,13 +80,38 @@ class CRT {
 		Delegate *delegate_ = nullptr;
 		unsigned int frames_since_last_delegate_call_ = 0;
 
-		// queued tasks for the OpenGL queue; performed before the next draw
-		std::mutex function_mutex_;
-		std::vector<std::function<void(void)>> enqueued_openGL_functions_;
-		inline void enqueue_openGL_function(const std::function<void(void)> &function) {
-			std::lock_guard<std::mutex> function_guard(function_mutex_);
-			enqueued_openGL_functions_.push_back(function);
-		}
+		// Changes to the output builder, as requested from the emulation thread; performed before the next draw.
+		struct Command {
+			enum class Type {
+				SetTargetFramebuffer,
+				SetOpenGLContextWillChange,
+				SetCompositeSamplingFunction,
+				SetSVideoSamplingFunction,
+				SetRGBSamplingFunction,
+				SetRGBPalette,
+				SetVideoSignal,
+				SetVisibleArea
+			} type;
+			Command(Type type) : type(type) {}
+
+			GLint framebuffer = 0;
+			bool should_delete_resources = false;
+			std::string shader;
+			CompositeSampler composite_sampler;
+			SVideoSampler svideo_sampler;
+			RGBSampler rgb_sampler;
+			std::vector<uint8_t> palette;
+			VideoSignal video_signal = VideoSignal::Composite;
+			Rect visible_area;
+
+			Command *next = nullptr;
+		};
+
+		// Commands are pushed onto a lock-free stack, which the drawing thread takes in its entirety and
+		// reverses; so whenever there are no commands, which is almost always, drawing involves no locking.
+		std::atomic<Command *> pending_commands_;
+		void enqueue_command(std::unique_ptr<Command> command);
+		void perform_commands();
 
 		// sync counter, for determining vertical sync
 		bool is_receiving_sync_ = false;					// true if the CRT is currently receiving sync (i.e. this is for edge triggering of horizontal sync)
@@ -97,6 +123,12 @@ class CRT {
 
 		unsigned int cycles_per_line_ = 1;
 
+		// field decimation, for fast-forwarding
+		unsigned int field_decimation_ = 1;
+		unsigned int fields_since_presentation_ = 0;
+		bool is_discarding_field_ = false;
+		bool discarded_latest_allocation_ = false;
+
 		float input_gamma_ = 1.0f, output_gamma_ = 1.0f;
 		void update_gamma();
 
@@ -153,6 +185,14 @@ class CRT {
 			DisplayType displayType,
 			unsigned int buffer_depth);
 
+		~CRT();
+
+		/*!	Sets the backend that CRTs constructed from now on will use to turn scans into pixels. CRTs use
+			OpenGL by default; a process that has no OpenGL context should select @c OutputBackend::Software
+			before any machine creates its CRT.
+		*/
+		static void set_default_output_backend(OutputBackend backend);
+
 		/*!	Resets the CRT with new timing information. The CRT then continues as though the new timing had
 			been provided at construction. */
 		void set_new_timing(unsigned int cycles_per_line, unsigned int height_of_display, ColourSpace colour_space, unsigned int colour_cycle_numerator, unsigned int colour_cycle_denominator, unsigned int vertical_sync_half_lines, bool should_alternate);
@@ -221,6 +261,52 @@ class CRT {
 		*/
 		void set_immediate_default_phase(float phase);
 
+		/*!	Describes one component of a sequence of output to be passed to @c output_spans; each corresponds
+			to a call to one of the individual output methods above.
+		*/
+		struct Span {
+			enum class Type: uint8_t {
+				Sync, Blank, Level, Data, ColourBurst, DefaultColourBurst
+			} type;
+			uint8_t phase = 0, amplitude = 0;	// ColourBurst only.
+			unsigned int number_of_cycles;
+			unsigned int number_of_samples = 0;	// Data only.
+
+			/// For Level and Data spans: if non-null, the samples to output, which will be copied;
+			/// if null, the samples are those written to the area most recently obtained via @c allocate_write_area.
+			const uint8_t *source = nullptr;
+
+			Span(Type type, unsigned int number_of_cycles) : type(type), number_of_cycles(number_of_cycles) {}
+
+			static Span sync(unsigned int number_of_cycles)		{	return Span(Type::Sync, number_of_cycles);	}
+			static Span blank(unsigned int number_of_cycles)	{	return Span(Type::Blank, number_of_cycles);	}
+			static Span default_colour_burst(unsigned int number_of_cycles)	{	return Span(Type::DefaultColourBurst, number_of_cycles);	}
+			static Span colour_burst(unsigned int number_of_cycles, uint8_t phase, uint8_t amplitude = 102) {
+				Span span(Type::ColourBurst, number_of_cycles);
+				span.phase = phase;
+				span.amplitude = amplitude;
+				return span;
+			}
+			static Span level(unsigned int number_of_cycles, const uint8_t *source = nullptr) {
+				Span span(Type::Level, number_of_cycles);
+				span.number_of_samples = 1;
+				span.source = source;
+				return span;
+			}
+			static Span data(unsigned int number_of_cycles, unsigned int number_of_samples, const uint8_t *source = nullptr) {
+				Span span(Type::Data, number_of_cycles);
+				span.number_of_samples = number_of_samples;
+				span.source = source;
+				return span;
+			}
+		};
+
+		/*!	Outputs each of @c number_of_spans @c spans in turn, exactly as if each had been supplied via
+			the individual output methods, but with the overhead of only a single call. This is the cheaper
+			option for machines that can describe a whole line, or fixed run of lines, at a time.
+		*/
+		void output_spans(const Span *spans, std::size_t number_of_spans);
+
 		/*!	Attempts to allocate the given number of output samples for writing.
 
 			The beginning of the most recently allocated area is used as the start
@@ -233,29 +319,45 @@ class CRT {
 			@returns A pointer to the allocated area if room is available; @c nullptr otherwise.
 		*/
 		inline uint8_t *allocate_write_area(std::size_t required_length, std::size_t required_alignment = 1) {
-			std::unique_lock<std::mutex> output_lock = openGL_output_builder_.get_output_lock();
-			return openGL_output_builder_.texture_builder.allocate_write_area(required_length, required_alignment);
+			discarded_latest_allocation_ = is_discarding_field_;
+			if(discarded_latest_allocation_) return nullptr;
+			return output_builder_->texture_builder.allocate_write_area(required_length, required_alignment);
+		}
+
+		/*!	Sets the CRT to present only one in every @c field_interval fields, e.g. to allow faster emulation
+			while fast-forwarding. Synchronisation, timing and delegate calls are unaffected; the CRT merely declines
+			to record scans for discarded fields. An interval of 1 presents every field.
+		*/
+		void set_field_decimation(unsigned int field_interval);
+
+		/*!	@returns @c true if the current field will not be presented; @c false otherwise. While a field is being
+			discarded @c allocate_write_area will return @c nullptr, and machines may skip pixel generation entirely.
+		*/
+		inline bool is_discarding_field() const {
+			return is_discarding_field_;
 		}
 
-		/*!	Causes appropriate OpenGL or OpenGL ES calls to be issued in order to draw the current CRT state.
-			The caller is responsible for ensuring that a valid OpenGL context exists for the duration of this call.
+		/*!	Draws the current CRT state. If this CRT is using OpenGL then appropriate OpenGL or OpenGL ES calls
+			are issued and the caller is responsible for ensuring that a valid OpenGL context exists for the duration
+			of this call. Otherwise the frame is drawn to memory, for collection via @c get_frame_pixels.
 		*/
 		inline void draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty) {
-			{
-				std::lock_guard<std::mutex> function_guard(function_mutex_);
-				for(std::function<void(void)> function : enqueued_openGL_functions_) {
-					function();
-				}
-				enqueued_openGL_functions_.clear();
-			}
-			openGL_output_builder_.draw_frame(output_width, output_height, only_if_dirty);
+			if(pending_commands_.load(std::memory_order_relaxed)) perform_commands();
+			output_builder_->draw_frame(output_width, output_height, only_if_dirty);
+		}
+
+		/*!	@returns The frame most recently drawn by @c draw_frame as rows of 8-bit RGBA pixels, top row first,
+			if this CRT is using the software backend; @c nullptr otherwise.
+		*/
+		inline const uint8_t *get_frame_pixels() {
+			return output_builder_->get_frame_pixels();
 		}
 
 		/*! Sets the OpenGL framebuffer to which output is drawn. */
 		inline void set_target_framebuffer(GLint framebuffer) {
-			enqueue_openGL_function( [framebuffer, this] {
-				openGL_output_builder_.set_target_framebuffer(framebuffer);
-			});
+			std::unique_ptr<Command> command(new Command(Command::Type::SetTargetFramebuffer));
+			command->framebuffer = framebuffer;
+			enqueue_command(std::move(command));
 		}
 
 		/*!	Sets the gamma exponent for the simulated screen. */
@@ -272,9 +374,9 @@ class CRT {
 			@c false then the references are simply marked as invalid.
 		*/
 		inline void set_openGL_context_will_change(bool should_delete_resources) {
-			enqueue_openGL_function([should_delete_resources, this] {
-				openGL_output_builder_.set_openGL_context_will_change(should_delete_resources);
-			});
+			std::unique_ptr<Command> command(new Command(Command::Type::SetOpenGLContextWillChange));
+			command->should_delete_resources = should_delete_resources;
+			enqueue_command(std::move(command));
 		}
 
 		/*!	Sets a function that will map from whatever data the machine provided to a composite signal.
@@ -283,11 +385,15 @@ class CRT {
 			`float composite_sample(usampler2D texID, vec2 coordinate, float phase, float amplitude)`
 			that evaluates to the composite signal level as a function of a source buffer, sampling location, colour
 			carrier phase and amplitude.
+
+			@param sampler A C++ equivalent of @c shader, for use by the software backend; if omitted then the
+			software backend will not be able to sample composite data.
 		*/
-		inline void set_composite_sampling_function(const std::string &shader) {
-			enqueue_openGL_function([shader, this] {
-				openGL_output_builder_.set_composite_sampling_function(shader);
-			});
+		inline void set_composite_sampling_function(const std::string &shader, const CompositeSampler &sampler = nullptr) {
+			std::unique_ptr<Command> command(new Command(Command::Type::SetCompositeSamplingFunction));
+			command->shader = shader;
+			command->composite_sampler = sampler;
+			enqueue_command(std::move(command));
 		}
 
 		enum CompositeSourceType {
@@ -320,11 +426,15 @@ class CRT {
 			that evaluates to the s-video signal level, luminance as the first component and chrominance
 			as the second, as a function of a source buffer, sampling location and colour
 			carrier phase; amplitude is supplied for its sign.
+
+			@param sampler A C++ equivalent of @c shader, for use by the software backend, which should write
+			luminance and then chrominance to the supplied array.
 		*/
-		inline void set_svideo_sampling_function(const std::string &shader) {
-			enqueue_openGL_function([shader, this] {
-				openGL_output_builder_.set_svideo_sampling_function(shader);
-			});
+		inline void set_svideo_sampling_function(const std::string &shader, const SVideoSampler &sampler = nullptr) {
+			std::unique_ptr<Command> command(new Command(Command::Type::SetSVideoSamplingFunction));
+			command->shader = shader;
+			command->svideo_sampler = sampler;
+			enqueue_command(std::move(command));
 		}
 
 		/*!	Sets a function that will map from whatever data the machine provided to an RGB signal.
@@ -338,23 +448,39 @@ class CRT {
 
 			* `usampler2D sampler` representing the source buffer; and
 			* `vec2 coordinate` representing the source buffer location to sample from in the range [0, 1).
+
+			@param sampler A C++ equivalent of @c shader, for use by the software backend, which should write
+			red, green and blue to the supplied array.
 		*/
-		inline void set_rgb_sampling_function(const std::string &shader) {
-			enqueue_openGL_function([shader, this] {
-				openGL_output_builder_.set_rgb_sampling_function(shader);
-			});
+		inline void set_rgb_sampling_function(const std::string &shader, const RGBSampler &sampler = nullptr) {
+			std::unique_ptr<Command> command(new Command(Command::Type::SetRGBSamplingFunction));
+			command->shader = shader;
+			command->rgb_sampler = sampler;
+			enqueue_command(std::move(command));
 		}
 
+		/*!
+			Declares that the colour of each source pixel is determined entirely by its first byte, as per @c palette.
+			The CRT evaluates @c palette once for each of the 256 possible values and thereafter, both on the GPU and
+			in the software backend, samples from the resulting lookup table rather than evaluating a sampling function
+			per pixel. The table used on the GPU is quantised to eight bits per channel, so levels other than 0 and 1 are
+			reproduced only to within 1/255; the software backend retains them exactly.
+
+			This replaces any RGB sampling function previously supplied; as with those, a default mapping from RGB will
+			be applied if the output mode is composite or svideo.
+		*/
+		void set_rgb_palette(const RGBSampler &palette);
+
 		inline void set_video_signal(VideoSignal video_signal) {
-			enqueue_openGL_function([video_signal, this] {
-				openGL_output_builder_.set_video_signal(video_signal);
-			});
+			std::unique_ptr<Command> command(new Command(Command::Type::SetVideoSignal));
+			command->video_signal = video_signal;
+			enqueue_command(std::move(command));
 		}
 
 		inline void set_visible_area(Rect visible_area) {
-			enqueue_openGL_function([visible_area, this] {
-				openGL_output_builder_.set_visible_area(visible_area);
-			});
+			std::unique_ptr<Command> command(new Command(Command::Type::SetVisibleArea));
+			command->visible_area = visible_area;
+			enqueue_command(std::move(command));
 		}
 
 		Rect get_rect_for_area(int first_line_after_sync, int number_of_lines, int first_cycle_after_sync, int number_of_cycles, float aspect_ratio);
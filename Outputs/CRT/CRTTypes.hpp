@@ -42,6 +42,11 @@ enum class VideoSignal {
 	Composite
 };
 
+enum class OutputBackend {
+	OpenGL,
+	Software
+};
+
 }
 }
 
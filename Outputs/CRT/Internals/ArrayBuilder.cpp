@@ -12,40 +12,102 @@
 
 using namespace Outputs::CRT;
 
+namespace {
+
+// The layout of ArrayBuilder::published_: the output size occupies the low bits, the input size sits above
+// it and the generation is the top bit.
+const int PublishedInputShift = 31;
+const int PublishedGenerationShift = 63;
+const uint64_t PublishedSizeMask = (uint64_t(1) << PublishedInputShift) - 1;
+
+}
+
 ArrayBuilder::ArrayBuilder(std::size_t input_size, std::size_t output_size) :
-		output_(output_size, nullptr),
-		input_(input_size, nullptr) {}
+	ArrayBuilder(input_size, output_size, nullptr) {}
 
 ArrayBuilder::ArrayBuilder(std::size_t input_size, std::size_t output_size, std::function<void(bool is_input, uint8_t *, std::size_t)> submission_function) :
 		output_(output_size, submission_function),
-		input_(input_size, submission_function) {}
+		input_(input_size, submission_function),
+		published_(0),
+		read_generation_(0) {
+	for(auto &generation: generations_) {
+		generation.input.resize(input_size);
+		generation.output.resize(output_size);
+	}
+}
 
 bool ArrayBuilder::is_full() {
-	bool was_full;
-	was_full = is_full_;
-	return was_full;
+	return is_full_;
 }
 
 uint8_t *ArrayBuilder::get_input_storage(std::size_t size) {
-	return get_storage(size, input_);
+	return get_storage(size, true);
 }
 
 uint8_t *ArrayBuilder::get_output_storage(std::size_t size) {
-	return get_storage(size, output_);
+	return get_storage(size, false);
+}
+
+uint8_t *ArrayBuilder::get_storage(std::size_t size, bool is_input) {
+	// If storage was exhausted, resume in the other generation once stage has caught up with
+	// this one, abandoning everything unflushed.
+	if(is_full_ && can_swap_generations()) {
+		swap_generations();
+	}
+
+	std::vector<uint8_t> &storage = is_input ? generations_[write_generation_].input : generations_[write_generation_].output;
+	std::size_t &allocated = is_input ? allocated_input_ : allocated_output_;
+	if(is_full_ || allocated + size > storage.size()) {
+		is_full_ = true;
+		return nullptr;
+	}
+	uint8_t *pointer = &storage[allocated];
+	allocated += size;
+	return pointer;
 }
 
 void ArrayBuilder::flush(const std::function<void(uint8_t *input, std::size_t input_size, uint8_t *output, std::size_t output_size)> &function) {
-	if(!is_full_) {
-		std::size_t input_size = 0, output_size = 0;
-		uint8_t *input = input_.get_unflushed(input_size);
-		uint8_t *output = output_.get_unflushed(output_size);
-		function(input, input_size, output, output_size);
-
-		input_.flush();
-		output_.flush();
+	if(is_full_) return;
+
+	Generation &generation = generations_[write_generation_];
+	function(
+		generation.input.data() + flushed_input_, allocated_input_ - flushed_input_,
+		generation.output.data() + flushed_output_, allocated_output_ - flushed_output_);
+
+	flushed_input_ = allocated_input_;
+	flushed_output_ = allocated_output_;
+	publish();
+
+	if(can_swap_generations()) {
+		swap_generations();
 	}
 }
 
+bool ArrayBuilder::can_swap_generations() {
+	// Once stage has caught up with the generation being written, it has finished with the other.
+	return read_generation_.load(std::memory_order_acquire) == write_generation_;
+}
+
+void ArrayBuilder::swap_generations() {
+	Generation &generation = generations_[write_generation_];
+	generation.final_input_size = flushed_input_;
+	generation.final_output_size = flushed_output_;
+
+	write_generation_ ^= 1;
+	allocated_input_ = flushed_input_ = 0;
+	allocated_output_ = flushed_output_ = 0;
+	is_full_ = false;
+	publish();
+}
+
+void ArrayBuilder::publish() {
+	published_.store(
+		(uint64_t(write_generation_) << PublishedGenerationShift) |
+		(uint64_t(flushed_input_) << PublishedInputShift) |
+		uint64_t(flushed_output_),
+		std::memory_order_release);
+}
+
 void ArrayBuilder::bind_input() {
 	input_.bind();
 }
@@ -54,16 +116,43 @@ void ArrayBuilder::bind_output() {
 	output_.bind();
 }
 
+void ArrayBuilder::stage() {
+	const uint64_t published = published_.load(std::memory_order_acquire);
+	const std::size_t generation = static_cast<std::size_t>(published >> PublishedGenerationShift);
+	const std::size_t input_size = static_cast<std::size_t>((published >> PublishedInputShift) & PublishedSizeMask);
+	const std::size_t output_size = static_cast<std::size_t>(published & PublishedSizeMask);
+
+	// If the writer has swapped generations since the last stage, collect the remainder of the old one first.
+	std::size_t read_generation = read_generation_.load(std::memory_order_relaxed);
+	if(generation != read_generation) {
+		const Generation &previous = generations_[read_generation];
+		input_.stage(previous.input.data() + read_input_, previous.final_input_size - read_input_);
+		output_.stage(previous.output.data() + read_output_, previous.final_output_size - read_output_);
+
+		read_generation = generation;
+		read_input_ = read_output_ = 0;
+	}
+
+	const Generation &current = generations_[generation];
+	input_.stage(current.input.data() + read_input_, input_size - read_input_);
+	output_.stage(current.output.data() + read_output_, output_size - read_output_);
+	read_input_ = input_size;
+	read_output_ = output_size;
+
+	// Allow the writer to reuse the other generation.
+	read_generation_.store(read_generation, std::memory_order_release);
+}
+
+const uint8_t *ArrayBuilder::get_staged_output(std::size_t &size) const {
+	size = output_.staged_data.size();
+	return output_.staged_data.data();
+}
+
 ArrayBuilder::Submission ArrayBuilder::submit() {
 	ArrayBuilder::Submission submission;
 
 	submission.input_size = input_.submit(true);
 	submission.output_size = output_.submit(false);
-	if(is_full_) {
-		is_full_ = false;
-		input_.reset();
-		output_.reset();
-	}
 
 	return submission;
 }
@@ -73,9 +162,11 @@ ArrayBuilder::Buffer::Buffer(std::size_t size, std::function<void(bool is_input,
 	if(!submission_function_) {
 		glGenBuffers(1, &buffer);
 		glBindBuffer(GL_ARRAY_BUFFER, buffer);
-		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(size * 2), NULL, GL_STREAM_DRAW);
 	}
-	data.resize(size);
+
+	// A single stage may collect the tail of one generation plus the whole of the other.
+	staged_data.reserve(size * 2);
 }
 
 ArrayBuilder::Buffer::~Buffer() {
@@ -83,67 +174,29 @@ ArrayBuilder::Buffer::~Buffer() {
 		glDeleteBuffers(1, &buffer);
 }
 
-uint8_t *ArrayBuilder::get_storage(std::size_t size, Buffer &buffer) {
-	uint8_t *pointer = buffer.get_storage(size);
-	if(!pointer) is_full_ = true;
-	return pointer;
-}
-
-uint8_t *ArrayBuilder::Buffer::get_storage(std::size_t size) {
-	if(is_full || allocated_data + size > data.size()) {
-		is_full = true;
-		return nullptr;
-	}
-	uint8_t *pointer = &data[allocated_data];
-	allocated_data += size;
-	return pointer;
-}
-
-uint8_t *ArrayBuilder::Buffer::get_unflushed(std::size_t &size) {
-	if(is_full) {
-		return nullptr;
-	}
-	size = allocated_data - flushed_data;
-	return &data[flushed_data];
-}
-
-void ArrayBuilder::Buffer::flush() {
-	if(submitted_data) {
-		memmove(data.data(), &data[submitted_data], allocated_data - submitted_data);
-		allocated_data -= submitted_data;
-		flushed_data -= submitted_data;
-		submitted_data = 0;
-	}
-
-	flushed_data = allocated_data;
+void ArrayBuilder::Buffer::stage(const uint8_t *data, std::size_t size) {
+	staged_data.insert(staged_data.end(), data, data + size);
 }
 
 std::size_t ArrayBuilder::Buffer::submit(bool is_input) {
-	std::size_t length = flushed_data;
+	const std::size_t length = staged_data.size();
 	if(submission_function_) {
-		submission_function_(is_input, data.data(), length);
+		submission_function_(is_input, staged_data.data(), length);
 	} else {
 		glBindBuffer(GL_ARRAY_BUFFER, buffer);
 		uint8_t *destination = static_cast<uint8_t *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)length, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
 		if(!glGetError() && destination) {
-			std::memcpy(destination, data.data(), length);
+			std::memcpy(destination, staged_data.data(), length);
 			glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)length);
 			glUnmapBuffer(GL_ARRAY_BUFFER);
 		} else {
-			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)length, data.data(), GL_STREAM_DRAW);
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)length, staged_data.data(), GL_STREAM_DRAW);
 		}
 	}
-	submitted_data = flushed_data;
+	staged_data.clear();
 	return length;
 }
 
 void ArrayBuilder::Buffer::bind() {
 	glBindBuffer(GL_ARRAY_BUFFER, buffer);
 }
-
-void ArrayBuilder::Buffer::reset() {
-	is_full = false;
-	allocated_data = 0;
-	flushed_data = 0;
-	submitted_data = 0;
-}
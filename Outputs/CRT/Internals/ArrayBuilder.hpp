@@ -9,6 +9,8 @@
 #ifndef ArrayBuilder_hpp
 #define ArrayBuilder_hpp
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -20,11 +22,14 @@ namespace CRT {
 
 /*!
 	Owns two array buffers, an 'input' and an 'output' and vends pointers to allow an owner to write provisional data into those
-	plus a flush function to lock provisional data into place. Also supplies a submit method to transfer all currently locked
-	data to the GPU and bind_input/output methods to bind the internal buffers.
-
-	It is safe for one thread to communicate via the get_*_storage and flush inputs asynchronously from another that is making
-	use of the bind and submit outputs.
+	plus a flush function to lock provisional data into place. Also supplies a stage method to set aside all currently locked
+	data, a submit method to transfer staged data to the GPU and bind_input/output methods to bind the internal buffers.
+
+	One thread may use the get_*_storage, is_full and flush inputs while another uses the stage, submit and bind outputs,
+	without any locking. Data is written into one of two generations of storage, ping-ponging between them: each flush
+	atomically publishes the flushed sizes of the generation being written, and @c stage copies out whatever has been
+	published since it last looked. Having done so, staging authorises the writer to swap generations, which it does at
+	its next flush; a generation is reused only once staging has collected everything that was flushed into it.
 */
 class ArrayBuilder {
 	public:
@@ -49,8 +54,9 @@ class ArrayBuilder {
 		bool is_full();
 
 		/// If neither input nor output was exhausted since the last flush, atomically commits both input and output
-		/// up to the currently allocated size for use upon the next @c submit, giving the supplied function a
-		/// chance to perform last-minute processing. Otherwise acts as a no-op.
+		/// up to the currently allocated size for use upon the next @c stage, giving the supplied function a
+		/// chance to perform last-minute processing. Otherwise acts as a no-op; once @c stage has caught up,
+		/// the next request for storage will discard everything unflushed and resume.
 		void flush(const std::function<void(uint8_t *input, std::size_t input_size, uint8_t *output, std::size_t output_size)> &);
 
 		/// Binds the input array to GL_ARRAY_BUFFER.
@@ -59,40 +65,66 @@ class ArrayBuilder {
 		/// Binds the output array to GL_ARRAY_BUFFER.
 		void bind_output();
 
+		/// Sets aside all input and output data flushed since the last @c stage for the next @c submit.
+		void stage();
+
+		/// @returns A pointer to the output data set aside by @c stage and not yet submitted, storing its length to @c size.
+		const uint8_t *get_staged_output(std::size_t &size) const;
+
 		struct Submission {
 			std::size_t input_size, output_size;
 		};
 
-		/// Submits all flushed input and output data to the corresponding arrays.
+		/// Submits all staged input and output data to the corresponding arrays.
 		/// @returns A @c Submission record, indicating how much data of each type was submitted.
 		Submission submit();
 
 	private:
+		// The destination for staged data, being a GPU buffer and a CPU-side copy of data yet to be uploaded to it.
 		class Buffer {
 			public:
 				Buffer(std::size_t size, std::function<void(bool is_input, uint8_t *, std::size_t)> submission_function);
 				~Buffer();
 
-				uint8_t *get_storage(std::size_t size);
-				uint8_t *get_unflushed(std::size_t &size);
-
-				void flush();
+				void stage(const uint8_t *data, std::size_t size);
 				std::size_t submit(bool is_input);
 				void bind();
-				void reset();
+
+				std::vector<uint8_t> staged_data;
 
 			private:
-				bool is_full = false;
 				GLuint buffer = 0;
 				std::function<void(bool is_input, uint8_t *, std::size_t)> submission_function_;
-				std::vector<uint8_t> data;
-				std::size_t allocated_data = 0;
-				std::size_t flushed_data = 0;
-				std::size_t submitted_data = 0;
 		} output_, input_;
-		uint8_t *get_storage(std::size_t size, Buffer &buffer);
 
+		// The two generations of storage.
+		struct Generation {
+			std::vector<uint8_t> input, output;
+
+			// The total amounts flushed to this generation before the writer swapped away from it.
+			std::size_t final_input_size = 0, final_output_size = 0;
+		} generations_[2];
+
+		// Writer state.
+		std::size_t write_generation_ = 0;
+		std::size_t allocated_input_ = 0, allocated_output_ = 0;
+		std::size_t flushed_input_ = 0, flushed_output_ = 0;
 		bool is_full_ = false;
+		uint8_t *get_storage(std::size_t size, bool is_input);
+		bool can_swap_generations();
+		void swap_generations();
+		void publish();
+
+		// The generation currently being written and the amounts flushed to it, packed into a single word
+		// so that the reader always sees a consistent set.
+		std::atomic<uint64_t> published_;
+
+		// The generation from which stage most recently collected data; the writer may swap generations only
+		// once this matches the one it is writing.
+		std::atomic<std::size_t> read_generation_;
+
+		// Reader state: the amounts of the read generation that have been staged.
+		std::size_t read_input_ = 0, read_output_ = 0;
 };
 
 }
@@ -24,18 +24,16 @@ namespace {
 	static const GLenum composite_texture_unit			= GL_TEXTURE2;
 	static const GLenum separated_texture_unit			= GL_TEXTURE3;
 	static const GLenum filtered_texture_unit			= GL_TEXTURE4;
+	static const GLenum palette_texture_unit			= GL_TEXTURE5;
 
 	static const GLenum work_texture_unit				= GL_TEXTURE2;
 }
 
 OpenGLOutputBuilder::OpenGLOutputBuilder(std::size_t bytes_per_pixel) :
-		visible_area_(Rect(0, 0, 1, 1)),
-		composite_src_output_y_(0),
+		OutputBuilder(bytes_per_pixel, source_data_texture_unit),
 		last_output_width_(0),
 		last_output_height_(0),
-		fence_(nullptr),
-		texture_builder(bytes_per_pixel, source_data_texture_unit),
-		array_builder(SourceVertexBufferDataSize, OutputVertexBufferDataSize) {
+		fence_(nullptr) {
 	glBlendFunc(GL_SRC_ALPHA, GL_CONSTANT_COLOR);
 	glBlendColor(0.4f, 0.4f, 0.4f, 1.0f);
 
@@ -69,6 +67,7 @@ OpenGLOutputBuilder::OpenGLOutputBuilder(std::size_t bytes_per_pixel) :
 
 OpenGLOutputBuilder::~OpenGLOutputBuilder() {
 	glDeleteVertexArrays(1, &output_vertex_array_);
+	if(palette_texture_) glDeleteTextures(1, &palette_texture_);
 }
 
 void OpenGLOutputBuilder::set_target_framebuffer(GLint target_framebuffer) {
@@ -85,6 +84,7 @@ void OpenGLOutputBuilder::draw_frame(unsigned int output_width, unsigned int out
 		prepare_svideo_input_shaders();
 		prepare_rgb_input_shaders();
 		prepare_source_vertex_array();
+		prepare_palette_texture();
 
 		prepare_output_shader();
 		prepare_output_vertex_array();
@@ -126,23 +126,13 @@ void OpenGLOutputBuilder::draw_frame(unsigned int output_width, unsigned int out
 		framebuffer_ = std::move(new_framebuffer);
 	}
 
-	// lock out the machine emulation until data is copied
-	output_mutex_.lock();
-
-	// release the mapping, giving up on trying to draw if data has been lost
+	// set aside everything provided so far, then upload the staged runs and any new source pixels
+	stage();
 	ArrayBuilder::Submission array_submission = array_builder.submit();
-
-	// upload new source pixels, if any
 	glActiveTexture(source_data_texture_unit);
 	texture_builder.bind();
 	texture_builder.submit();
 
-	// buffer usage restart from 0 for the next time around
-	composite_src_output_y_ = 0;
-
-	// data having been grabbed, allow the machine to continue
-	output_mutex_.unlock();
-
 	struct RenderStage {
 		OpenGL::Shader *const shader;
 		OpenGL::TextureTarget *const target;
@@ -276,24 +266,28 @@ void OpenGLOutputBuilder::reset_all_OpenGL_state() {
 void OpenGLOutputBuilder::set_openGL_context_will_change(bool should_delete_resources) {
 	output_mutex_.lock();
 	reset_all_OpenGL_state();
+	if(should_delete_resources && palette_texture_) glDeleteTextures(1, &palette_texture_);
+	palette_texture_ = 0;
 	output_mutex_.unlock();
 }
 
-void OpenGLOutputBuilder::set_composite_sampling_function(const std::string &shader) {
-	std::lock_guard<std::mutex> lock_guard(output_mutex_);
-	composite_shader_ = shader;
+void OpenGLOutputBuilder::set_composite_sampling_function(const std::string &shader, const CompositeSampler &sampler) {
+	OutputBuilder::set_composite_sampling_function(shader, sampler);
 	reset_all_OpenGL_state();
 }
 
-void OpenGLOutputBuilder::set_svideo_sampling_function(const std::string &shader) {
-	std::lock_guard<std::mutex> lock_guard(output_mutex_);
-	svideo_shader_ = shader;
+void OpenGLOutputBuilder::set_svideo_sampling_function(const std::string &shader, const SVideoSampler &sampler) {
+	OutputBuilder::set_svideo_sampling_function(shader, sampler);
 	reset_all_OpenGL_state();
 }
 
-void OpenGLOutputBuilder::set_rgb_sampling_function(const std::string &shader) {
-	std::lock_guard<std::mutex> lock_guard(output_mutex_);
-	rgb_shader_ = shader;
+void OpenGLOutputBuilder::set_rgb_sampling_function(const std::string &shader, const RGBSampler &sampler) {
+	OutputBuilder::set_rgb_sampling_function(shader, sampler);
+	reset_all_OpenGL_state();
+}
+
+void OpenGLOutputBuilder::set_rgb_palette(const std::vector<uint8_t> &palette) {
+	palette_ = palette;
 	reset_all_OpenGL_state();
 }
 
@@ -387,6 +381,27 @@ void OpenGLOutputBuilder::prepare_source_vertex_array() {
 	}
 }
 
+void OpenGLOutputBuilder::prepare_palette_texture() {
+	if(palette_.empty()) return;
+
+	if(!palette_texture_) glGenTextures(1, &palette_texture_);
+	glActiveTexture(palette_texture_unit);
+	glBindTexture(GL_TEXTURE_2D, palette_texture_);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(palette_.size() / 4), 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, palette_.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// Any of the input shaders may have been built from the palette-sampling function.
+	OpenGL::IntermediateShader *const shaders[] = {
+		composite_input_shader_program_.get(),
+		svideo_input_shader_program_.get(),
+		rgb_input_shader_program_.get()
+	};
+	for(auto shader: shaders) {
+		if(shader) shader->set_uniform("rgbPalette", static_cast<GLint>(palette_texture_unit - GL_TEXTURE0));
+	}
+}
+
 void OpenGLOutputBuilder::prepare_output_shader() {
 	output_shader_program_ = OpenGL::OutputShader::make_shader("", "texture(texID, srcCoordinatesVarying).rgb", false);
 	output_shader_program_->set_source_texture_unit(work_texture_ ? work_texture_unit : filtered_texture_unit);
@@ -416,27 +431,26 @@ void OpenGLOutputBuilder::prepare_output_vertex_array() {
 
 void OpenGLOutputBuilder::set_video_signal(VideoSignal video_signal) {
 	if(video_signal_ != video_signal) {
-		video_signal_ = video_signal;
-		composite_src_output_y_ = 0;
+		OutputBuilder::set_video_signal(video_signal);
 		last_output_width_ = 0;
 		last_output_height_ = 0;
 		set_output_shader_width();
 	}
 }
 
-void OpenGLOutputBuilder::set_timing(unsigned int input_frequency, unsigned int cycles_per_line, unsigned int height_of_display, unsigned int horizontal_scan_period, unsigned int vertical_scan_period, unsigned int vertical_period_divider) {
-	std::lock_guard<std::mutex> lock_guard(output_mutex_);
-	input_frequency_ = input_frequency;
-	cycles_per_line_ = cycles_per_line;
-	height_of_display_ = height_of_display;
-	horizontal_scan_period_ = horizontal_scan_period;
-	vertical_scan_period_ = vertical_scan_period;
-	vertical_period_divider_ = vertical_period_divider;
+// MARK: - Internal Configuration
 
-	set_timing_uniforms();
+void OpenGLOutputBuilder::did_set_colour_format() {
+	set_colour_space_uniforms();
 }
 
-// MARK: - Internal Configuration
+void OpenGLOutputBuilder::did_set_gamma() {
+	set_gamma();
+}
+
+void OpenGLOutputBuilder::did_set_timing() {
+	set_timing_uniforms();
+}
 
 void OpenGLOutputBuilder::set_colour_space_uniforms() {
 	GLfloat rgbToYUV[] = {0.299f, -0.14713f, 0.615f, 0.587f, -0.28886f, -0.51499f, 0.114f, 0.436f, -0.10001f};
@@ -471,18 +485,6 @@ void OpenGLOutputBuilder::set_gamma() {
 	if(output_shader_program_) output_shader_program_->set_gamma_ratio(gamma_);
 }
 
-/*!
-	@returns The multiplier to apply to x positions received at the shader in order to produce locations in the intermediate
-		texture. Intermediate textures are in phase with the composite signal, so this is a function of (i) composite frequency
-		(determining how much of the texture adds up to a single line); and (ii) input frequency (determining what the input
-		positions mean as a fraction of a line).
-*/
-float OpenGLOutputBuilder::get_composite_output_width() const {
-	return
-		(static_cast<float>(colour_cycle_numerator_ * 4) / static_cast<float>(colour_cycle_denominator_ * IntermediateBufferWidth)) *
-		(static_cast<float>(IntermediateBufferWidth) / static_cast<float>(cycles_per_line_));
-}
-
 void OpenGLOutputBuilder::set_output_shader_width() {
 	if(output_shader_program_) {
 		// For anything that isn't RGB, scale so that sampling is in-phase with the colour subcarrier.
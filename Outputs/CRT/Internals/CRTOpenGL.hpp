@@ -15,8 +15,7 @@
 #include "TextureTarget.hpp"
 #include "Shaders/Shader.hpp"
 
-#include "ArrayBuilder.hpp"
-#include "TextureBuilder.hpp"
+#include "OutputBuilder.hpp"
 
 #include "Shaders/OutputShader.hpp"
 #include "Shaders/IntermediateShader.hpp"
@@ -28,30 +27,13 @@
 namespace Outputs {
 namespace CRT {
 
-class OpenGLOutputBuilder {
+/*!
+	An OutputBuilder that draws using OpenGL 3.2, decoding the video signal and applying the sampling functions
+	on the GPU.
+*/
+class OpenGLOutputBuilder: public OutputBuilder {
 	private:
-		// colour information
-		ColourSpace colour_space_;
-		unsigned int colour_cycle_numerator_;
-		unsigned int colour_cycle_denominator_;
-		VideoSignal video_signal_;
-		float gamma_;
-
-		// timing information to allow reasoning about input information
-		unsigned int input_frequency_;
-		unsigned int cycles_per_line_;
-		unsigned int height_of_display_;
-		unsigned int horizontal_scan_period_;
-		unsigned int vertical_scan_period_;
-		unsigned int vertical_period_divider_;
-
-		// The user-supplied visible area
-		Rect visible_area_;
-
 		// Other things the caller may have provided.
-		std::string composite_shader_;
-		std::string svideo_shader_;
-		std::string rgb_shader_;
 		GLint target_framebuffer_ = 0;
 
 		// Methods used by the OpenGL code
@@ -62,14 +44,10 @@ class OpenGLOutputBuilder {
 
 		void prepare_output_vertex_array();
 		void prepare_source_vertex_array();
+		void prepare_palette_texture();
 
-		// the run and input data buffers
-		std::mutex output_mutex_;
 		std::mutex draw_mutex_;
 
-		// transient buffers indicating composite data not yet decoded
-		GLsizei composite_src_output_y_;
-
 		std::unique_ptr<OpenGL::OutputShader> output_shader_program_;
 
 		std::unique_ptr<OpenGL::IntermediateShader> composite_input_shader_program_;
@@ -92,6 +70,10 @@ class OpenGLOutputBuilder {
 		GLuint output_vertex_array_;
 		GLuint source_vertex_array_;
 
+		// The RGB palette, if one has been supplied, and the texture to which it is uploaded.
+		std::vector<uint8_t> palette_;
+		GLuint palette_texture_ = 0;
+
 		unsigned int last_output_width_, last_output_height_;
 
 		void set_timing_uniforms();
@@ -102,9 +84,12 @@ class OpenGLOutputBuilder {
 		void reset_all_OpenGL_state();
 
 		GLsync fence_;
-		float get_composite_output_width() const;
 		void set_output_shader_width();
 
+		void did_set_colour_format() override;
+		void did_set_gamma() override;
+		void did_set_timing() override;
+
 		// Maintain a couple of rectangles for masking off the extreme edge of the display;
 		// this is a bit of a cheat: there's some tolerance in when a sync pulse will be
 		// generated. So it might be slightly later than expected. Which might cause a scan
@@ -119,59 +104,17 @@ class OpenGLOutputBuilder {
 		std::unique_ptr<OpenGL::Rectangle> left_overlay_;
 
 	public:
-		// These two are protected by output_mutex_.
-		TextureBuilder texture_builder;
-		ArrayBuilder array_builder;
-
 		OpenGLOutputBuilder(std::size_t bytes_per_pixel);
 		~OpenGLOutputBuilder();
 
-		inline void set_colour_format(ColourSpace colour_space, unsigned int colour_cycle_numerator, unsigned int colour_cycle_denominator) {
-			std::lock_guard<std::mutex> output_guard(output_mutex_);
-			colour_space_ = colour_space;
-			colour_cycle_numerator_ = colour_cycle_numerator;
-			colour_cycle_denominator_ = colour_cycle_denominator;
-			set_colour_space_uniforms();
-		}
-
-		inline void set_visible_area(Rect visible_area) {
-			visible_area_ = visible_area;
-		}
-
-		inline void set_gamma(float gamma) {
-			gamma_ = gamma;
-			set_gamma();
-		}
-
-		inline std::unique_lock<std::mutex> get_output_lock() {
-			return std::unique_lock<std::mutex>(output_mutex_);
-		}
-
-		inline VideoSignal get_output_device() {
-			return video_signal_;
-		}
-
-		inline uint16_t get_composite_output_y() {
-			return static_cast<uint16_t>(composite_src_output_y_);
-		}
-
-		inline bool composite_output_buffer_is_full() {
-			return composite_src_output_y_ == IntermediateBufferHeight;
-		}
-
-		inline void increment_composite_output_y() {
-			if(!composite_output_buffer_is_full())
-				composite_src_output_y_++;
-		}
-
-		void set_target_framebuffer(GLint);
-		void draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty);
-		void set_openGL_context_will_change(bool should_delete_resources);
-		void set_composite_sampling_function(const std::string &);
-		void set_svideo_sampling_function(const std::string &);
-		void set_rgb_sampling_function(const std::string &);
-		void set_video_signal(VideoSignal);
-		void set_timing(unsigned int input_frequency, unsigned int cycles_per_line, unsigned int height_of_display, unsigned int horizontal_scan_period, unsigned int vertical_scan_period, unsigned int vertical_period_divider);
+		void set_target_framebuffer(GLint) override;
+		void draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty) override;
+		void set_openGL_context_will_change(bool should_delete_resources) override;
+		void set_composite_sampling_function(const std::string &, const CompositeSampler &) override;
+		void set_svideo_sampling_function(const std::string &, const SVideoSampler &) override;
+		void set_rgb_sampling_function(const std::string &, const RGBSampler &) override;
+		void set_rgb_palette(const std::vector<uint8_t> &) override;
+		void set_video_signal(VideoSignal) override;
 };
 
 }
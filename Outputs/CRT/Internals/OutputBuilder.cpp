@@ -0,0 +1,83 @@
+//
+//  OutputBuilder.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 29/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "OutputBuilder.hpp"
+
+using namespace Outputs::CRT;
+
+OutputBuilder::OutputBuilder(std::size_t bytes_per_pixel, GLenum source_texture_unit) :
+		texture_builder(bytes_per_pixel, source_texture_unit),
+		array_builder(SourceVertexBufferDataSize, OutputVertexBufferDataSize),
+		visible_area_(Rect(0, 0, 1, 1)),
+		composite_src_output_y_(0),
+		first_undrawn_composite_y_(0) {}
+
+OutputBuilder::OutputBuilder(
+	std::size_t bytes_per_pixel,
+	std::function<void(uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows)> texture_submission_function,
+	std::function<void(bool is_input, uint8_t *, std::size_t)> array_submission_function) :
+		texture_builder(bytes_per_pixel, texture_submission_function),
+		array_builder(SourceVertexBufferDataSize, OutputVertexBufferDataSize, array_submission_function),
+		visible_area_(Rect(0, 0, 1, 1)),
+		composite_src_output_y_(0),
+		first_undrawn_composite_y_(0) {}
+
+void OutputBuilder::set_composite_sampling_function(const std::string &shader, const CompositeSampler &sampler) {
+	std::lock_guard<std::mutex> lock_guard(output_mutex_);
+	composite_shader_ = shader;
+	composite_sampler_ = sampler;
+}
+
+void OutputBuilder::set_svideo_sampling_function(const std::string &shader, const SVideoSampler &sampler) {
+	std::lock_guard<std::mutex> lock_guard(output_mutex_);
+	svideo_shader_ = shader;
+	svideo_sampler_ = sampler;
+}
+
+void OutputBuilder::set_rgb_sampling_function(const std::string &shader, const RGBSampler &sampler) {
+	std::lock_guard<std::mutex> lock_guard(output_mutex_);
+	rgb_shader_ = shader;
+	rgb_sampler_ = sampler;
+}
+
+void OutputBuilder::set_video_signal(VideoSignal video_signal) {
+	video_signal_ = video_signal;
+}
+
+void OutputBuilder::set_timing(unsigned int input_frequency, unsigned int cycles_per_line, unsigned int height_of_display, unsigned int horizontal_scan_period, unsigned int vertical_scan_period, unsigned int vertical_period_divider) {
+	{
+		std::lock_guard<std::mutex> lock_guard(output_mutex_);
+		input_frequency_ = input_frequency;
+		cycles_per_line_ = cycles_per_line;
+		height_of_display_ = height_of_display;
+		horizontal_scan_period_ = horizontal_scan_period;
+		vertical_scan_period_ = vertical_scan_period;
+		vertical_period_divider_ = vertical_period_divider;
+	}
+	did_set_timing();
+}
+
+float OutputBuilder::get_composite_output_width() const {
+	return
+		(static_cast<float>(colour_cycle_numerator_ * 4) / static_cast<float>(colour_cycle_denominator_ * IntermediateBufferWidth)) *
+		(static_cast<float>(IntermediateBufferWidth) / static_cast<float>(cycles_per_line_));
+}
+
+void OutputBuilder::stage() {
+	array_builder.stage();
+	texture_builder.stage();
+
+	// Nothing staged after this point can refer to lines up to and including that of the most recent
+	// output run, so the CRT may reuse them.
+	std::size_t output_size;
+	const uint8_t *const output = array_builder.get_staged_output(output_size);
+	if(output_size >= OutputVertexSize) {
+		const uint16_t last_y = *reinterpret_cast<const uint16_t *>(&output[output_size - OutputVertexSize + OutputVertexOffsetOfVertical + 2]);
+		first_undrawn_composite_y_.store((last_y + 1) % IntermediateBufferHeight, std::memory_order_relaxed);
+	}
+}
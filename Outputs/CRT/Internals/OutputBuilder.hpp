@@ -0,0 +1,183 @@
+//
+//  OutputBuilder.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 29/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef OutputBuilder_hpp
+#define OutputBuilder_hpp
+
+#include "../CRTTypes.hpp"
+#include "CRTConstants.hpp"
+
+#include "ArrayBuilder.hpp"
+#include "TextureBuilder.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace Outputs {
+namespace CRT {
+
+/*!
+	C++ equivalents of the GLSL sampling functions that a machine may supply, for the benefit of output builders
+	that do not run shaders. Each is supplied with a pointer to the single source pixel to sample; phase and
+	amplitude have the same meaning as they do in GLSL.
+*/
+typedef std::function<void(const uint8_t *source, float *rgb)> RGBSampler;
+typedef std::function<void(const uint8_t *source, float phase, float amplitude, float *luminance_chrominance)> SVideoSampler;
+typedef std::function<float(const uint8_t *source, float phase, float amplitude)> CompositeSampler;
+
+/*!
+	An OutputBuilder receives the source data and scan geometry generated by a CRT, and at each call to @c draw_frame
+	turns everything received since the last into a visible image.
+
+	The collection side is common to all builders: the CRT writes source data through @c texture_builder and scans
+	through @c array_builder, neither of which requires any locking. Subclasses provide the drawing side, collecting
+	everything written since the last draw via @c stage.
+*/
+class OutputBuilder {
+	public:
+		TextureBuilder texture_builder;
+		ArrayBuilder array_builder;
+
+		virtual ~OutputBuilder() {}
+
+		inline void set_colour_format(ColourSpace colour_space, unsigned int colour_cycle_numerator, unsigned int colour_cycle_denominator) {
+			{
+				std::lock_guard<std::mutex> output_guard(output_mutex_);
+				colour_space_ = colour_space;
+				colour_cycle_numerator_ = colour_cycle_numerator;
+				colour_cycle_denominator_ = colour_cycle_denominator;
+			}
+			did_set_colour_format();
+		}
+
+		inline void set_visible_area(Rect visible_area) {
+			visible_area_ = visible_area;
+		}
+
+		inline void set_gamma(float gamma) {
+			gamma_ = gamma;
+			did_set_gamma();
+		}
+
+		inline VideoSignal get_output_device() {
+			return video_signal_;
+		}
+
+		inline uint16_t get_composite_output_y() {
+			return static_cast<uint16_t>(composite_src_output_y_);
+		}
+
+		inline bool composite_output_buffer_is_full() {
+			return (composite_src_output_y_ + 1) % IntermediateBufferHeight == first_undrawn_composite_y_.load(std::memory_order_relaxed);
+		}
+
+		inline void increment_composite_output_y() {
+			if(!composite_output_buffer_is_full())
+				composite_src_output_y_ = (composite_src_output_y_ + 1) % IntermediateBufferHeight;
+		}
+
+		void set_timing(unsigned int input_frequency, unsigned int cycles_per_line, unsigned int height_of_display, unsigned int horizontal_scan_period, unsigned int vertical_scan_period, unsigned int vertical_period_divider);
+
+		virtual void set_composite_sampling_function(const std::string &, const CompositeSampler &);
+		virtual void set_svideo_sampling_function(const std::string &, const SVideoSampler &);
+		virtual void set_rgb_sampling_function(const std::string &, const RGBSampler &);
+		virtual void set_video_signal(VideoSignal);
+
+		/*!
+			Draws everything received since the last call at the requested output size. If @c only_if_dirty is
+			@c true then the builder may decline to draw if doing so would block.
+		*/
+		virtual void draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty) = 0;
+
+		/*!
+			@returns The frame most recently drawn by @c draw_frame as rows of 8-bit RGBA pixels, top row first,
+			if this builder draws to memory; @c nullptr otherwise.
+		*/
+		virtual const uint8_t *get_frame_pixels() { return nullptr; }
+
+		// OpenGL-specific; ignored by builders that do not use OpenGL.
+		virtual void set_target_framebuffer(GLint) {}
+		virtual void set_openGL_context_will_change(bool should_delete_resources) {}
+
+		/*!
+			Supplies the 256-entry RGBA lookup table, eight bits per channel, that @c OpenGLOutputBuilder uploads as a
+			texture for its input shaders to sample as @c rgbPalette; OpenGL-specific, as other builders use
+			the equivalent RGB sampler.
+		*/
+		virtual void set_rgb_palette(const std::vector<uint8_t> &palette) {}
+
+	protected:
+		/// Constructs an output builder that will upload source data and scans to OpenGL.
+		OutputBuilder(std::size_t bytes_per_pixel, GLenum source_texture_unit);
+
+		/// Constructs an output builder that will pass source data and scans to the supplied functions upon submission.
+		OutputBuilder(
+			std::size_t bytes_per_pixel,
+			std::function<void(uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows)> texture_submission_function,
+			std::function<void(bool is_input, uint8_t *, std::size_t)> array_submission_function);
+
+		// Hooks for subclasses that need to respond to changes in configuration.
+		virtual void did_set_colour_format() {}
+		virtual void did_set_gamma() {}
+		virtual void did_set_timing() {}
+
+		// colour information
+		ColourSpace colour_space_;
+		unsigned int colour_cycle_numerator_;
+		unsigned int colour_cycle_denominator_;
+		VideoSignal video_signal_;
+		float gamma_;
+
+		// timing information to allow reasoning about input information
+		unsigned int input_frequency_;
+		unsigned int cycles_per_line_;
+		unsigned int height_of_display_;
+		unsigned int horizontal_scan_period_;
+		unsigned int vertical_scan_period_;
+		unsigned int vertical_period_divider_;
+
+		// The user-supplied visible area
+		Rect visible_area_;
+
+		// Sampling functions, as GLSL and as C++.
+		std::string composite_shader_;
+		std::string svideo_shader_;
+		std::string rgb_shader_;
+		CompositeSampler composite_sampler_;
+		SVideoSampler svideo_sampler_;
+		RGBSampler rgb_sampler_;
+
+		// Guards configuration that is set from the emulation thread but read when drawing.
+		std::mutex output_mutex_;
+
+		// Lines of the intermediate buffer are used cyclically. composite_src_output_y_ is the line currently being
+		// written, and first_undrawn_composite_y_ the first that may yet be required by a draw.
+		GLsizei composite_src_output_y_;
+		std::atomic<GLsizei> first_undrawn_composite_y_;
+
+		/*!
+			Sets aside all source data and scans flushed since the last call for submission by @c array_builder and
+			@c texture_builder, and releases the intermediate lines they occupy for reuse by later scans.
+		*/
+		void stage();
+
+		/*!
+			@returns The multiplier to apply to x positions received at the shader in order to produce locations in the intermediate
+				texture. Intermediate textures are in phase with the composite signal, so this is a function of (i) composite frequency
+				(determining how much of the texture adds up to a single line); and (ii) input frequency (determining what the input
+				positions mean as a fraction of a line).
+		*/
+		float get_composite_output_width() const;
+};
+
+}
+}
+
+#endif /* OutputBuilder_hpp */
@@ -8,15 +8,26 @@
 
 #include "Shader.hpp"
 
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 
+// Program binaries are part of OpenGL 4.1, and available as an extension before that.
+#if defined(GL_ARB_get_program_binary) || defined(GL_VERSION_4_1)
+#define SUPPORTS_PROGRAM_BINARIES
+#endif
+
 using namespace OpenGL;
 
 namespace {
 	// The below is disabled because it isn't context/thread-specific. Which makes it
 	// fairly 'unuseful'.
 //	Shader *bound_shader = nullptr;
+
+	std::string program_binary_cache_directory;
+
+	// Cache files begin with this, followed by the program binary's format and then the binary itself.
+	const char ProgramBinaryMagic[4] = {'C', 'L', 'K', 'P'};
 }
 
 GLuint Shader::compile_shader(const std::string &source, GLenum type) {
@@ -47,6 +58,11 @@ GLuint Shader::compile_shader(const std::string &source, GLenum type) {
 
 Shader::Shader(const std::string &vertex_shader, const std::string &fragment_shader, const std::vector<AttributeBinding> &attribute_bindings) {
 	shader_program_ = glCreateProgram();
+
+	// Use a cached binary if there is one; otherwise compile from source.
+	const std::string cache_path = program_binary_cache_path(vertex_shader, fragment_shader, attribute_bindings);
+	if(!cache_path.empty() && load_program_binary(cache_path)) return;
+
 	GLuint vertex = compile_shader(vertex_shader, GL_VERTEX_SHADER);
 	GLuint fragment = compile_shader(fragment_shader, GL_FRAGMENT_SHADER);
 
@@ -57,6 +73,9 @@ Shader::Shader(const std::string &vertex_shader, const std::string &fragment_sha
 		glBindAttribLocation(shader_program_, binding.index, binding.name.c_str());
 	}
 
+#ifdef SUPPORTS_PROGRAM_BINARIES
+	if(!cache_path.empty()) glProgramParameteri(shader_program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
 	glLinkProgram(shader_program_);
 
 #ifdef DEBUG
@@ -74,6 +93,114 @@ Shader::Shader(const std::string &vertex_shader, const std::string &fragment_sha
 		throw ProgramLinkageError;
 	}
 #endif
+
+	if(!cache_path.empty()) save_program_binary(cache_path);
+}
+
+// MARK: - Program binary cache.
+
+void Shader::set_program_binary_cache_directory(const std::string &directory) {
+	program_binary_cache_directory = directory;
+}
+
+std::string Shader::program_binary_cache_path(const std::string &vertex_shader, const std::string &fragment_shader, const std::vector<AttributeBinding> &attribute_bindings) {
+#ifdef SUPPORTS_PROGRAM_BINARIES
+	if(program_binary_cache_directory.empty()) return "";
+
+	GLint number_of_formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &number_of_formats);
+	if(!number_of_formats) return "";
+
+	// Take a 64-bit FNV-1a hash of everything that affects the binary: the driver, the source and the bindings.
+	uint64_t hash = 0xcbf29ce484222325;
+	const auto add_to_hash = [&hash] (const char *string, std::size_t length) {
+		for(std::size_t c = 0; c < length; ++c) {
+			hash = (hash ^ static_cast<uint8_t>(string[c])) * 0x100000001b3;
+		}
+		hash = (hash ^ 0xff) * 0x100000001b3;
+	};
+	const GLenum driver_strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+	for(const auto name: driver_strings) {
+		const char *const string = reinterpret_cast<const char *>(glGetString(name));
+		if(string) add_to_hash(string, std::strlen(string));
+	}
+	add_to_hash(vertex_shader.data(), vertex_shader.size());
+	add_to_hash(fragment_shader.data(), fragment_shader.size());
+	for(const auto &binding : attribute_bindings) {
+		add_to_hash(binding.name.data(), binding.name.size());
+		const std::string index = std::to_string(binding.index);
+		add_to_hash(index.data(), index.size());
+	}
+
+	char name[21];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+	return program_binary_cache_directory + "/" + name;
+#else
+	return "";
+#endif
+}
+
+bool Shader::load_program_binary(const std::string &path) {
+#ifdef SUPPORTS_PROGRAM_BINARIES
+	FILE *const file = std::fopen(path.c_str(), "rb");
+	if(!file) return false;
+
+	std::vector<uint8_t> contents;
+	uint8_t buffer[4096];
+	std::size_t read;
+	while((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		contents.insert(contents.end(), buffer, buffer + read);
+	}
+	std::fclose(file);
+
+	const std::size_t header_size = sizeof(ProgramBinaryMagic) + sizeof(GLenum);
+	if(contents.size() <= header_size || std::memcmp(contents.data(), ProgramBinaryMagic, sizeof(ProgramBinaryMagic))) return false;
+
+	GLenum format;
+	std::memcpy(&format, &contents[sizeof(ProgramBinaryMagic)], sizeof(format));
+	glProgramBinary(shader_program_, format, &contents[header_size], static_cast<GLsizei>(contents.size() - header_size));
+
+	// The driver may decline a binary it previously produced, e.g. following an update.
+	GLint did_link = 0;
+	glGetProgramiv(shader_program_, GL_LINK_STATUS, &did_link);
+	if(did_link != GL_TRUE) {
+		// Discard the error raised by an unrecognised format, if any.
+		glGetError();
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Shader::save_program_binary(const std::string &path) {
+#ifdef SUPPORTS_PROGRAM_BINARIES
+	GLint did_link = 0, length = 0;
+	glGetProgramiv(shader_program_, GL_LINK_STATUS, &did_link);
+	glGetProgramiv(shader_program_, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(did_link != GL_TRUE || length <= 0) return;
+
+	std::vector<uint8_t> binary(static_cast<std::size_t>(length));
+	GLenum format = 0;
+	glGetProgramBinary(shader_program_, length, &length, &format, binary.data());
+
+	// Write to a temporary file and then rename it, so that a partially-written binary is never observed.
+	const std::string temporary_path = path + ".tmp";
+	FILE *const file = std::fopen(temporary_path.c_str(), "wb");
+	if(!file) return;
+	const bool did_write =
+		std::fwrite(ProgramBinaryMagic, sizeof(ProgramBinaryMagic), 1, file) == 1 &&
+		std::fwrite(&format, sizeof(format), 1, file) == 1 &&
+		std::fwrite(binary.data(), static_cast<std::size_t>(length), 1, file) == 1;
+	std::fclose(file);
+
+	if(did_write) {
+		std::rename(temporary_path.c_str(), path.c_str());
+	} else {
+		std::remove(temporary_path.c_str());
+	}
+#endif
 }
 
 Shader::~Shader() {
@@ -45,6 +45,13 @@ public:
 	Shader(const std::string &vertex_shader, const std::string &fragment_shader, const std::vector<AttributeBinding> &attribute_bindings = {});
 	~Shader();
 
+	/*!
+		Nominates a directory in which to cache linked program binaries, if the driver supports them. Programs are keyed
+		by their source, their attribute bindings and the identity of the driver, so a later @c Shader with the same
+		inputs can skip compilation. An empty string, the default, disables the cache.
+	*/
+	static void set_program_binary_cache_directory(const std::string &directory);
+
 	/*!
 		Performs an @c glUseProgram to make this the active shader unless:
 			(i) it was the previous shader bound; and
@@ -110,6 +117,10 @@ private:
 	GLuint compile_shader(const std::string &source, GLenum type);
 	GLuint shader_program_;
 
+	static std::string program_binary_cache_path(const std::string &vertex_shader, const std::string &fragment_shader, const std::vector<AttributeBinding> &attribute_bindings);
+	bool load_program_binary(const std::string &path);
+	void save_program_binary(const std::string &path);
+
 	void flush_functions();
 	std::vector<std::function<void(void)>> enqueued_functions_;
 	std::mutex function_mutex_;
@@ -0,0 +1,638 @@
+//
+//  SoftwareOutputBuilder.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 29/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "SoftwareOutputBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Outputs::CRT;
+
+namespace {
+
+/*!
+	Four floats, operated upon in parallel via SSE2 where available and one at a time otherwise.
+*/
+#if defined(__SSE2__)
+struct Float4 {
+	__m128 v;
+
+	Float4(__m128 v) : v(v) {}
+	Float4(float value) : v(_mm_set1_ps(value)) {}
+
+	static Float4 load(const float *source)		{	return _mm_loadu_ps(source);	}
+	void store(float *target) const				{	_mm_storeu_ps(target, v);		}
+	void store_truncated(int *target) const		{	_mm_storeu_si128(reinterpret_cast<__m128i *>(target), _mm_cvttps_epi32(v));	}
+
+	Float4 operator +(const Float4 &rhs) const	{	return _mm_add_ps(v, rhs.v);	}
+	Float4 operator -(const Float4 &rhs) const	{	return _mm_sub_ps(v, rhs.v);	}
+	Float4 operator *(const Float4 &rhs) const	{	return _mm_mul_ps(v, rhs.v);	}
+
+	Float4 clamped(float low, float high) const {
+		return _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(low)), _mm_set1_ps(high));
+	}
+
+	/// @returns For each lane, @c if_positive if this is greater than zero; @c otherwise otherwise.
+	Float4 choose(const Float4 &if_positive, const Float4 &otherwise) const {
+		const __m128 mask = _mm_cmpgt_ps(v, _mm_setzero_ps());
+		return _mm_or_ps(_mm_and_ps(mask, if_positive.v), _mm_andnot_ps(mask, otherwise.v));
+	}
+};
+#else
+struct Float4 {
+	float v[4];
+
+	Float4() {}
+	Float4(float value) : v{value, value, value, value} {}
+
+	static Float4 load(const float *source)		{	Float4 result; std::memcpy(result.v, source, sizeof(result.v)); return result;	}
+	void store(float *target) const				{	std::memcpy(target, v, sizeof(v));	}
+	void store_truncated(int *target) const		{	for(int c = 0; c < 4; ++c) target[c] = static_cast<int>(v[c]);	}
+
+	Float4 operator +(const Float4 &rhs) const	{	Float4 result; for(int c = 0; c < 4; ++c) result.v[c] = v[c] + rhs.v[c]; return result;	}
+	Float4 operator -(const Float4 &rhs) const	{	Float4 result; for(int c = 0; c < 4; ++c) result.v[c] = v[c] - rhs.v[c]; return result;	}
+	Float4 operator *(const Float4 &rhs) const	{	Float4 result; for(int c = 0; c < 4; ++c) result.v[c] = v[c] * rhs.v[c]; return result;	}
+
+	Float4 clamped(float low, float high) const {
+		Float4 result; for(int c = 0; c < 4; ++c) result.v[c] = std::min(std::max(v[c], low), high); return result;
+	}
+
+	Float4 choose(const Float4 &if_positive, const Float4 &otherwise) const {
+		Float4 result; for(int c = 0; c < 4; ++c) result.v[c] = (v[c] > 0.0f) ? if_positive.v[c] : otherwise.v[c]; return result;
+	}
+};
+#endif
+
+/*!
+	Blends @c pixels RGBA pixels from @c source into @c target with the same weights as the OpenGL output, i.e.
+	64% of the new plus 40% of the old, saturating. Weights are held to seven bits so that sums fit in 16.
+*/
+void blend(uint8_t *target, const uint8_t *source, std::size_t pixels) {
+	std::size_t byte = 0;
+	const std::size_t bytes = pixels * 4;
+
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i source_weight = _mm_set1_epi16(82);
+	const __m128i target_weight = _mm_set1_epi16(51);
+	for(; byte + 16 <= bytes; byte += 16) {
+		const __m128i new_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&source[byte]));
+		const __m128i old_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&target[byte]));
+
+		const __m128i low = _mm_srli_epi16(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(new_pixels, zero), source_weight),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(old_pixels, zero), target_weight)), 7);
+		const __m128i high = _mm_srli_epi16(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(new_pixels, zero), source_weight),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(old_pixels, zero), target_weight)), 7);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&target[byte]), _mm_packus_epi16(low, high));
+	}
+#endif
+
+	for(; byte < bytes; ++byte) {
+		target[byte] = static_cast<uint8_t>(std::min((source[byte] * 82 + target[byte] * 51) >> 7, 255));
+	}
+}
+
+inline uint16_t get16(const uint8_t *vertex, std::size_t offset) {
+	return *reinterpret_cast<const uint16_t *>(&vertex[offset]);
+}
+
+const float QuarterCycle = 1.5707963268f;
+
+// The number of intermediate samples of padding either side of a line, so that filters may overrun it.
+const int LinePadding = 8;
+
+// The size of each of the nine arrays of intermediate samples used when decoding composite and s-video.
+const std::size_t SignalArraySize = IntermediateBufferWidth + LinePadding*2 + 4;
+
+// The size of each of the three arrays of gamma table indices produced when decoding composite and s-video.
+const std::size_t ChannelArraySize = IntermediateBufferWidth + 4;
+
+}
+
+struct SoftwareOutputBuilder::Decoder {
+	enum class Mode {
+		None, RGB, SVideo, Composite
+	} mode = Mode::None;
+
+	/// The sampler that source data will be read through; if it doesn't directly produce the signal
+	/// type of @c mode then its output is converted as the OpenGL pipeline would.
+	enum class Source {
+		RGB, SVideo, Composite
+	} source = Source::Composite;
+
+	RGBSampler rgb_sampler;
+	SVideoSampler svideo_sampler;
+	CompositeSampler composite_sampler;
+
+	/// The number of intermediate samples per unit of horizontal position.
+	float scaler = 1.0f;
+
+	/// Column-major matrices from luminance and chrominance to RGB, and back.
+	float to_rgb[9], from_rgb[9];
+};
+
+SoftwareOutputBuilder::SoftwareOutputBuilder(std::size_t bytes_per_pixel) :
+	OutputBuilder(
+		bytes_per_pixel,
+		[this] (uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows) {
+			const std::size_t row_size = bytes_per_pixel_ * InputBufferBuilderWidth;
+			std::memcpy(&source_texture_[y * row_size], rows, (height - 1) * row_size + width * bytes_per_pixel_);
+		},
+		[this] (bool is_input, uint8_t *data, std::size_t size) {
+			std::vector<uint8_t> &target = is_input ? source_runs_ : output_runs_;
+			target.assign(data, data + size);
+		}),
+	bytes_per_pixel_(bytes_per_pixel),
+	source_texture_(bytes_per_pixel * InputBufferBuilderWidth * InputBufferBuilderHeight),
+	decoded_lines_(IntermediateBufferWidth * IntermediateBufferHeight * 4),
+	line_run_starts_(IntermediateBufferHeight + 1) {
+	const unsigned int thread_count = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+	scratch_.resize(thread_count);
+	for(auto &scratch: scratch_) {
+		scratch.signals.resize(SignalArraySize * 9, 0.0f);
+		scratch.channels.resize(ChannelArraySize * 3);
+	}
+	for(unsigned int c = 1; c < thread_count; ++c) {
+		workers_.emplace_back([this, c] {
+			unsigned int generation = 0;
+			while(true) {
+				{
+					std::unique_lock<std::mutex> lock(work_mutex_);
+					work_condition_.wait(lock, [this, generation] { return workers_should_quit_ || work_generation_ != generation; });
+					if(workers_should_quit_) return;
+					generation = work_generation_;
+				}
+
+				perform_bands(c);
+
+				std::lock_guard<std::mutex> lock(work_mutex_);
+				--outstanding_workers_;
+				if(!outstanding_workers_) completion_condition_.notify_all();
+			}
+		});
+	}
+}
+
+SoftwareOutputBuilder::~SoftwareOutputBuilder() {
+	{
+		std::lock_guard<std::mutex> lock(work_mutex_);
+		workers_should_quit_ = true;
+	}
+	work_condition_.notify_all();
+	for(auto &worker: workers_) worker.join();
+}
+
+const uint8_t *SoftwareOutputBuilder::get_frame_pixels() {
+	return frame_.empty() ? nullptr : frame_.data();
+}
+
+// MARK: - Threading
+
+void SoftwareOutputBuilder::perform_in_bands(std::size_t count, const std::function<void(std::size_t worker, std::size_t begin, std::size_t end)> &function) {
+	if(!count) return;
+
+	// Use a few more bands than there are threads, to smooth out uneven workloads.
+	const std::size_t band_count = (workers_.size() + 1) * 4;
+
+	{
+		std::lock_guard<std::mutex> lock(work_mutex_);
+		work_ = &function;
+		work_count_ = count;
+		work_band_size_ = std::max((count + band_count - 1) / band_count, std::size_t(1));
+		next_band_ = 0;
+		outstanding_workers_ = workers_.size();
+		++work_generation_;
+	}
+	work_condition_.notify_all();
+
+	perform_bands(0);
+
+	std::unique_lock<std::mutex> lock(work_mutex_);
+	completion_condition_.wait(lock, [this] { return !outstanding_workers_; });
+}
+
+void SoftwareOutputBuilder::perform_bands(std::size_t worker) {
+	while(true) {
+		const std::size_t begin = (next_band_++) * work_band_size_;
+		if(begin >= work_count_) return;
+		(*work_)(worker, begin, std::min(begin + work_band_size_, work_count_));
+	}
+}
+
+// MARK: - Decoding
+
+void SoftwareOutputBuilder::decode_line(const Decoder &decoder, uint16_t line, Scratch &scratch) {
+	uint8_t *const target = &decoded_lines_[static_cast<std::size_t>(line) * IntermediateBufferWidth * 4];
+	for(int c = 0; c < IntermediateBufferWidth; ++c) {
+		target[c*4 + 0] = target[c*4 + 1] = target[c*4 + 2] = 0;
+		target[c*4 + 3] = 0xff;
+	}
+
+	const std::size_t first_run = line_run_starts_[line];
+	const std::size_t end_run = line_run_starts_[line + 1];
+	if(first_run == end_run || decoder.mode == Decoder::Mode::None) return;
+
+	// RGB: decode each source pixel once, then copy to the intermediate samples that it covers.
+	if(decoder.mode == Decoder::Mode::RGB) {
+		std::vector<uint8_t> &pixels = scratch.pixels;
+		for(std::size_t run = first_run; run < end_run; ++run) {
+			const uint8_t *const vertex = &source_runs_[line_runs_[run] * SourceVertexSize];
+			const int input_start = get16(vertex, SourceVertexOffsetOfInputStart);
+			const int input_end = get16(vertex, SourceVertexOffsetOfEnds);
+			const int output_start = get16(vertex, SourceVertexOffsetOfOutputStart);
+			const int output_end = std::min(static_cast<int>(get16(vertex, SourceVertexOffsetOfEnds + 2)), static_cast<int>(IntermediateBufferWidth));
+			if(output_end <= output_start || input_end <= input_start) continue;
+
+			const int length = input_end - input_start;
+			const uint8_t *const source = &source_texture_[(get16(vertex, SourceVertexOffsetOfInputStart + 2) * InputBufferBuilderWidth + input_start) * bytes_per_pixel_];
+			if(pixels.size() < static_cast<std::size_t>(length) * 4) pixels.resize(static_cast<std::size_t>(length) * 4);
+			for(int c = 0; c < length; ++c) {
+				float rgb[3];
+				decoder.rgb_sampler(&source[static_cast<std::size_t>(c) * bytes_per_pixel_], rgb);
+				for(int channel = 0; channel < 3; ++channel) {
+					pixels[c*4 + channel] = gamma_table_[static_cast<int>(std::min(std::max(rgb[channel], 0.0f), 1.0f) * (GammaTableSize - 1) + 0.5f)];
+				}
+				pixels[c*4 + 3] = 0xff;
+			}
+
+			const int output_length = output_end - output_start;
+			for(int c = 0; c < output_length; ++c) {
+				const int pixel = ((2*c + 1) * length) / (2 * output_length);
+				std::memcpy(&target[(output_start + c) * 4], &pixels[pixel * 4], 4);
+			}
+		}
+		return;
+	}
+
+	// Composite and s-video: sample at four points per colour cycle, recording alongside each sample the
+	// quadrature of the colour subcarrier and the colour burst amplitude. The scratch arrays are all-zero
+	// on entry, and are returned to that state below.
+	float *const signal = &scratch.signals[SignalArraySize * 0 + LinePadding];
+	float *const chroma = &scratch.signals[SignalArraySize * 1 + LinePadding];
+	float *const inverse_amplitude = &scratch.signals[SignalArraySize * 2 + LinePadding];
+	float *const luminance_gain = &scratch.signals[SignalArraySize * 3 + LinePadding];
+	float *const cosine = &scratch.signals[SignalArraySize * 4 + LinePadding];
+	float *const sine = &scratch.signals[SignalArraySize * 5 + LinePadding];
+	float *const luminance = &scratch.signals[SignalArraySize * 6 + LinePadding];
+	float *const u = &scratch.signals[SignalArraySize * 7 + LinePadding];
+	float *const v = &scratch.signals[SignalArraySize * 8 + LinePadding];
+
+	int line_start = IntermediateBufferWidth, line_end = 0;
+	for(std::size_t run = first_run; run < end_run; ++run) {
+		const uint8_t *const vertex = &source_runs_[line_runs_[run] * SourceVertexSize];
+		const int input_start = get16(vertex, SourceVertexOffsetOfInputStart);
+		const int input_end = get16(vertex, SourceVertexOffsetOfEnds);
+		const float output_start = get16(vertex, SourceVertexOffsetOfOutputStart) * decoder.scaler;
+		const float output_end = get16(vertex, SourceVertexOffsetOfEnds + 2) * decoder.scaler;
+		if(output_end <= output_start || input_end <= input_start) continue;
+
+		// Determine the samples with centres in [output_start, output_end).
+		const int first = std::max(static_cast<int>(std::ceil(output_start - 0.5f)), 0);
+		const int end = std::min(static_cast<int>(std::ceil(output_end - 0.5f)), static_cast<int>(IntermediateBufferWidth));
+		if(end <= first) continue;
+		line_start = std::min(line_start, first);
+		line_end = std::max(line_end, end);
+
+		const float amplitude = static_cast<float>(vertex[SourceVertexOffsetOfPhaseTimeAndAmplitude + 1] - 128) / 127.0f;
+		const float absolute_amplitude = std::fabs(amplitude);
+		const float amplitude_sign = static_cast<float>((amplitude > 0.0f) - (amplitude < 0.0f));
+		const float run_inverse_amplitude = (absolute_amplitude > 0.05f) ? 1.0f / absolute_amplitude : 0.0f;
+		const float run_luminance_gain = (absolute_amplitude < 1.0f) ? 1.0f / (1.0f - absolute_amplitude) : 1.0f;
+
+		// Samples fall a quarter of a colour cycle apart, so the quadrature can be rotated rather than recomputed.
+		const float first_phase = (static_cast<float>(first) + 0.5f + static_cast<float>(vertex[SourceVertexOffsetOfPhaseTimeAndAmplitude]) / 64.0f) * QuarterCycle;
+		float quadrature_cosine = std::cos(first_phase), quadrature_sine = std::sin(first_phase);
+
+		const int length = input_end - input_start;
+		const float pixel_step = static_cast<float>(length) / (output_end - output_start);
+		float pixel_position = (static_cast<float>(first) + 0.5f - output_start) * pixel_step;
+		const uint8_t *const source = &source_texture_[(get16(vertex, SourceVertexOffsetOfInputStart + 2) * InputBufferBuilderWidth + input_start) * bytes_per_pixel_];
+
+		int last_pixel = -1;
+		float pixel_luminance_chrominance[3];
+		for(int c = first; c < end; ++c) {
+			const int pixel = std::min(static_cast<int>(pixel_position), length - 1);
+			const float phase = first_phase + static_cast<float>(c - first) * QuarterCycle;
+			const uint8_t *const sample_source = &source[static_cast<std::size_t>(pixel) * bytes_per_pixel_];
+
+			switch(decoder.source) {
+				case Decoder::Source::Composite:
+					signal[c] = decoder.composite_sampler(sample_source, phase, amplitude);
+				break;
+
+				case Decoder::Source::SVideo: {
+					float luminance_chrominance[2];
+					decoder.svideo_sampler(sample_source, phase, amplitude, luminance_chrominance);
+					if(decoder.mode == Decoder::Mode::Composite) {
+						signal[c] = luminance_chrominance[0] * (1.0f - absolute_amplitude) + luminance_chrominance[1] * absolute_amplitude;
+					} else {
+						signal[c] = luminance_chrominance[0];
+						chroma[c] = luminance_chrominance[1];
+					}
+				} break;
+
+				case Decoder::Source::RGB: {
+					// RGB samplers are independent of phase, so convert each source pixel only once.
+					if(pixel != last_pixel) {
+						last_pixel = pixel;
+						float rgb[3];
+						decoder.rgb_sampler(sample_source, rgb);
+						for(int channel = 0; channel < 3; ++channel) rgb[channel] = std::min(std::max(rgb[channel], 0.0f), 1.0f);
+						for(int channel = 0; channel < 3; ++channel) {
+							pixel_luminance_chrominance[channel] =
+								decoder.from_rgb[channel + 0] * rgb[0] +
+								decoder.from_rgb[channel + 3] * rgb[1] +
+								decoder.from_rgb[channel + 6] * rgb[2];
+						}
+					}
+
+					if(decoder.mode == Decoder::Mode::Composite) {
+						signal[c] =
+							pixel_luminance_chrominance[0] * (1.0f - absolute_amplitude) +
+							pixel_luminance_chrominance[1] * quadrature_cosine * absolute_amplitude +
+							pixel_luminance_chrominance[2] * quadrature_sine * amplitude;
+					} else {
+						signal[c] = pixel_luminance_chrominance[0];
+						chroma[c] = 0.5f + (
+							pixel_luminance_chrominance[1] * quadrature_cosine +
+							pixel_luminance_chrominance[2] * quadrature_sine * amplitude_sign) * 0.5f;
+					}
+				} break;
+			}
+			inverse_amplitude[c] = run_inverse_amplitude;
+			luminance_gain[c] = run_luminance_gain;
+			cosine[c] = quadrature_cosine;
+			sine[c] = quadrature_sine * amplitude_sign;
+
+			const float next_cosine = -quadrature_sine;
+			quadrature_sine = quadrature_cosine;
+			quadrature_cosine = next_cosine;
+			pixel_position += pixel_step;
+		}
+	}
+	if(line_end <= line_start) return;
+
+	// Separate luminance and chrominance, and demodulate the latter. This covers a few samples beyond the
+	// line so that the chrominance filter below has complete input.
+	for(int c = line_start - 4; c < line_end + 4; c += 4) {
+		const Float4 sample = Float4::load(&signal[c]);
+		const Float4 amplitude_reciprocal = Float4::load(&inverse_amplitude[c]);
+
+		Float4 chrominance(0.0f);
+		if(decoder.mode == Decoder::Mode::Composite) {
+			// Take luminance as the average across a colour cycle if a colour subcarrier is present, or else
+			// as a weighted sum around the sample; chrominance is whatever remains.
+			const Float4 previous = Float4::load(&signal[c-1]);
+			const Float4 next = Float4::load(&signal[c+1]);
+			const Float4 cycle_average = (Float4::load(&signal[c-2]) + previous + sample + next) * Float4(0.25f);
+			const Float4 weighted = (previous + next) * Float4(0.16f) + sample * Float4(0.66f);
+			const Float4 separated_luminance = amplitude_reciprocal.choose(cycle_average, weighted);
+
+			chrominance = (sample - separated_luminance) * amplitude_reciprocal;
+			(separated_luminance * Float4::load(&luminance_gain[c])).store(&luminance[c]);
+		} else {
+			chrominance = Float4::load(&chroma[c]) * amplitude_reciprocal;
+			sample.store(&luminance[c]);
+		}
+
+		(chrominance * Float4::load(&cosine[c])).store(&u[c]);
+		(chrominance * Float4::load(&sine[c])).store(&v[c]);
+	}
+
+	// Filter chrominance across a colour cycle, convert to RGB and apply gamma.
+	int *const red = &scratch.channels[ChannelArraySize * 0];
+	int *const green = &scratch.channels[ChannelArraySize * 1];
+	int *const blue = &scratch.channels[ChannelArraySize * 2];
+	const float table_scale = static_cast<float>(GammaTableSize - 1);
+	for(int c = line_start; c < line_end; c += 4) {
+		const Float4 y = Float4::load(&luminance[c]);
+		const Float4 filtered_u = (Float4::load(&u[c-2]) + Float4::load(&u[c-1]) + Float4::load(&u[c]) + Float4::load(&u[c+1])) * Float4(0.25f);
+		const Float4 filtered_v = (Float4::load(&v[c-2]) + Float4::load(&v[c-1]) + Float4::load(&v[c]) + Float4::load(&v[c+1])) * Float4(0.25f);
+
+		const int offset = c - line_start;
+		((y * Float4(decoder.to_rgb[0]) + filtered_u * Float4(decoder.to_rgb[3]) + filtered_v * Float4(decoder.to_rgb[6])).clamped(0.0f, 1.0f) * Float4(table_scale) + Float4(0.5f)).store_truncated(&red[offset]);
+		((y * Float4(decoder.to_rgb[1]) + filtered_u * Float4(decoder.to_rgb[4]) + filtered_v * Float4(decoder.to_rgb[7])).clamped(0.0f, 1.0f) * Float4(table_scale) + Float4(0.5f)).store_truncated(&green[offset]);
+		((y * Float4(decoder.to_rgb[2]) + filtered_u * Float4(decoder.to_rgb[5]) + filtered_v * Float4(decoder.to_rgb[8])).clamped(0.0f, 1.0f) * Float4(table_scale) + Float4(0.5f)).store_truncated(&blue[offset]);
+	}
+
+	for(int c = line_start; c < line_end; ++c) {
+		const int offset = c - line_start;
+		target[c*4 + 0] = gamma_table_[red[offset]];
+		target[c*4 + 1] = gamma_table_[green[offset]];
+		target[c*4 + 2] = gamma_table_[blue[offset]];
+	}
+
+	// Clear everything that was written above, which lies within a padding's width of the line.
+	for(std::size_t array = 0; array < 9; ++array) {
+		float *const base = &scratch.signals[SignalArraySize * array + LinePadding];
+		std::fill(&base[line_start - LinePadding], &base[line_end + LinePadding], 0.0f);
+	}
+}
+
+// MARK: - Drawing
+
+void SoftwareOutputBuilder::draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty) {
+	Decoder decoder;
+	Rect visible_area;
+	float horizontal_scan_period, vertical_scan_period, scan_thickness, gamma;
+
+	// Set aside everything provided since last time.
+	stage();
+
+	{
+		std::lock_guard<std::mutex> output_guard(output_mutex_);
+
+		// Take a copy of all relevant configuration.
+		visible_area = visible_area_;
+		horizontal_scan_period = static_cast<float>(horizontal_scan_period_);
+		vertical_scan_period = static_cast<float>(vertical_scan_period_) / static_cast<float>(vertical_period_divider_);
+		scan_thickness = static_cast<float>(cycles_per_line_) / (static_cast<float>(height_of_display_) * horizontal_scan_period);
+
+		const float yuv_to_rgb[] = {1.0f, 1.0f, 1.0f, 0.0f, -0.39465f, 2.03211f, 1.13983f, -0.58060f, 0.0f};
+		const float rgb_to_yuv[] = {0.299f, -0.14713f, 0.615f, 0.587f, -0.28886f, -0.51499f, 0.114f, 0.436f, -0.10001f};
+		const float yiq_to_rgb[] = {1.0f, 1.0f, 1.0f, 0.956f, -0.272f, -1.106f, 0.621f, -0.647f, 1.703f};
+		const float rgb_to_yiq[] = {0.299f, 0.596f, 0.211f, 0.587f, -0.274f, -0.523f, 0.114f, -0.322f, 0.312f};
+		std::memcpy(decoder.to_rgb, (colour_space_ == ColourSpace::YIQ) ? yiq_to_rgb : yuv_to_rgb, sizeof(decoder.to_rgb));
+		std::memcpy(decoder.from_rgb, (colour_space_ == ColourSpace::YIQ) ? rgb_to_yiq : rgb_to_yuv, sizeof(decoder.from_rgb));
+
+		// Pick a decoding route according to the requested signal and the available samplers, preferring
+		// whichever sampler most directly produces the requested signal.
+		decoder.rgb_sampler = rgb_sampler_;
+		decoder.svideo_sampler = svideo_sampler_;
+		decoder.composite_sampler = composite_sampler_;
+		switch(video_signal_) {
+			case VideoSignal::RGB:
+				if(rgb_sampler_) {
+					decoder.mode = Decoder::Mode::RGB;
+					decoder.source = Decoder::Source::RGB;
+					break;
+				}
+			// Without an RGB sampler, fall back on s-video.
+
+			case VideoSignal::SVideo:
+				if(svideo_sampler_ || rgb_sampler_) {
+					decoder.mode = Decoder::Mode::SVideo;
+					decoder.source = svideo_sampler_ ? Decoder::Source::SVideo : Decoder::Source::RGB;
+					break;
+				}
+			// Without an s-video or RGB sampler, fall back on composite.
+
+			case VideoSignal::Composite:
+				decoder.mode = Decoder::Mode::Composite;
+				if(composite_sampler_)		decoder.source = Decoder::Source::Composite;
+				else if(svideo_sampler_)	decoder.source = Decoder::Source::SVideo;
+				else if(rgb_sampler_)		decoder.source = Decoder::Source::RGB;
+				else						decoder.mode = Decoder::Mode::None;
+			break;
+		}
+		decoder.scaler = (decoder.mode == Decoder::Mode::RGB) ? 1.0f : get_composite_output_width();
+		gamma = gamma_;
+	}
+
+	// Collect the staged data; the CRT may continue in the meantime.
+	array_builder.submit();
+	texture_builder.submit();
+
+	if(gamma_table_gamma_ != gamma) {
+		gamma_table_gamma_ = gamma;
+		for(int c = 0; c < GammaTableSize; ++c) {
+			gamma_table_[c] = static_cast<uint8_t>(std::pow(static_cast<float>(c) / static_cast<float>(GammaTableSize - 1), gamma) * 255.0f + 0.5f);
+		}
+	}
+
+	// Make sure there's a frame to draw to.
+	if(frame_width_ != output_width || frame_height_ != output_height) {
+		if(frame_width_ != output_width) {
+			for(auto &scratch: scratch_) scratch.samples.resize(static_cast<std::size_t>(output_width) * 4);
+		}
+		frame_width_ = output_width;
+		frame_height_ = output_height;
+		frame_.resize(static_cast<std::size_t>(output_width) * output_height * 4);
+		for(std::size_t c = 0; c < frame_.size(); c += 4) {
+			frame_[c] = frame_[c+1] = frame_[c+2] = 0;
+			frame_[c+3] = 0xff;
+		}
+	}
+	if(output_runs_.empty() || !output_width || !output_height) return;
+
+	// Sort source runs by intermediate line, and determine which lines are to be output.
+	const std::size_t number_of_source_runs = source_runs_.size() / SourceVertexSize;
+	const std::size_t number_of_output_runs = output_runs_.size() / OutputVertexSize;
+
+	std::fill(line_run_starts_.begin(), line_run_starts_.end(), 0);
+	for(std::size_t run = 0; run < number_of_source_runs; ++run) {
+		const uint16_t line = get16(&source_runs_[run * SourceVertexSize], SourceVertexOffsetOfOutputStart + 2);
+		if(line < IntermediateBufferHeight) ++line_run_starts_[line + 1];
+	}
+	for(std::size_t line = 1; line < line_run_starts_.size(); ++line) {
+		line_run_starts_[line] += line_run_starts_[line - 1];
+	}
+	line_runs_.resize(number_of_source_runs);
+	{
+		std::vector<std::size_t> insertion_points(line_run_starts_.begin(), line_run_starts_.end() - 1);
+		for(std::size_t run = 0; run < number_of_source_runs; ++run) {
+			const uint16_t line = get16(&source_runs_[run * SourceVertexSize], SourceVertexOffsetOfOutputStart + 2);
+			if(line < IntermediateBufferHeight) line_runs_[insertion_points[line]++] = run;
+		}
+	}
+
+	lines_to_decode_.clear();
+	for(std::size_t run = 0; run < number_of_output_runs; ++run) {
+		const uint16_t line = get16(&output_runs_[run * OutputVertexSize], OutputVertexOffsetOfVertical + 2);
+		if(line < IntermediateBufferHeight) lines_to_decode_.push_back(line);
+	}
+	std::sort(lines_to_decode_.begin(), lines_to_decode_.end());
+	lines_to_decode_.erase(std::unique(lines_to_decode_.begin(), lines_to_decode_.end()), lines_to_decode_.end());
+
+	// Decode those lines.
+	perform_in_bands(lines_to_decode_.size(), [this, &decoder] (std::size_t worker, std::size_t begin, std::size_t end) {
+		for(std::size_t line = begin; line < end; ++line) {
+			decode_line(decoder, lines_to_decode_[line], scratch_[worker]);
+		}
+	});
+
+	// Map output runs to the frame, adjusting the visible area to the frame's aspect ratio as OutputShader does.
+	const float aspect_ratio_multiplier = (static_cast<float>(output_width) / static_cast<float>(output_height)) / (4.0f / 3.0f);
+	const float left_extent = (-1.0f / aspect_ratio_multiplier) / visible_area.size.width;
+	const float right_extent = (1.0f / aspect_ratio_multiplier) / visible_area.size.width;
+	visible_area.origin.x -= (aspect_ratio_multiplier - 1.0f) * visible_area.size.width * 0.5f;
+	visible_area.size.width *= aspect_ratio_multiplier;
+
+	struct Paint {
+		int first_row, end_row;
+		int first_column, end_column;
+		float sample_position, sample_step;
+		const uint8_t *line;
+	};
+	std::vector<Paint> paints;
+	paints.reserve(number_of_output_runs);
+	const float width = static_cast<float>(output_width), height = static_cast<float>(output_height);
+	for(std::size_t run = 0; run < number_of_output_runs; ++run) {
+		const uint8_t *const vertex = &output_runs_[run * OutputVertexSize];
+		const uint16_t line = get16(vertex, OutputVertexOffsetOfVertical + 2);
+		if(line >= IntermediateBufferHeight) continue;
+
+		const float top = ((static_cast<float>(get16(vertex, OutputVertexOffsetOfVertical)) / vertical_scan_period) - visible_area.origin.y) * height / visible_area.size.height;
+		const float bottom = top + scan_thickness * height / visible_area.size.height;
+		const float left = ((static_cast<float>(get16(vertex, OutputVertexOffsetOfHorizontal)) / horizontal_scan_period) - visible_area.origin.x) * width / visible_area.size.width;
+		const float right = ((static_cast<float>(get16(vertex, OutputVertexOffsetOfHorizontal + 2)) / horizontal_scan_period) - visible_area.origin.x) * width / visible_area.size.width;
+
+		Paint paint;
+		paint.first_row = std::max(static_cast<int>(std::ceil(top - 0.5f)), 0);
+		paint.end_row = std::min(static_cast<int>(std::ceil(bottom - 0.5f)), static_cast<int>(output_height));
+		paint.first_column = std::max(static_cast<int>(std::ceil(left - 0.5f)), 0);
+		paint.end_column = std::min(static_cast<int>(std::ceil(right - 0.5f)), static_cast<int>(output_width));
+		if(paint.end_row <= paint.first_row || paint.end_column <= paint.first_column) continue;
+
+		paint.sample_step = visible_area.size.width * horizontal_scan_period * decoder.scaler / width;
+		paint.sample_position = ((static_cast<float>(paint.first_column) + 0.5f) * visible_area.size.width / width + visible_area.origin.x) * horizontal_scan_period * decoder.scaler;
+		paint.line = &decoded_lines_[static_cast<std::size_t>(line) * IntermediateBufferWidth * 4];
+		paints.push_back(paint);
+	}
+
+	// Paint, in bands of rows. Then mask off the extreme left and right of the display.
+	const int left_gutter = std::min(std::max(static_cast<int>(std::ceil((left_extent * 0.98f + 1.0f) * width * 0.5f - 0.5f)), 0), static_cast<int>(output_width));
+	const int right_gutter = std::min(std::max(static_cast<int>(std::ceil((right_extent * 0.98f + 1.0f) * width * 0.5f - 0.5f)), 0), static_cast<int>(output_width));
+	perform_in_bands(output_height, [this, &paints, output_width, left_gutter, right_gutter] (std::size_t worker, std::size_t begin, std::size_t end) {
+		std::vector<uint8_t> &samples = scratch_[worker].samples;
+		for(const auto &paint: paints) {
+			const int first_row = std::max(paint.first_row, static_cast<int>(begin));
+			const int end_row = std::min(paint.end_row, static_cast<int>(end));
+			if(first_row >= end_row) continue;
+
+			float position = paint.sample_position;
+			for(int column = paint.first_column; column < paint.end_column; ++column) {
+				const int sample = std::min(std::max(static_cast<int>(position), 0), static_cast<int>(IntermediateBufferWidth) - 1);
+				std::memcpy(&samples[static_cast<std::size_t>(column - paint.first_column) * 4], &paint.line[sample * 4], 4);
+				position += paint.sample_step;
+			}
+
+			for(int row = first_row; row < end_row; ++row) {
+				blend(&frame_[(static_cast<std::size_t>(row) * output_width + static_cast<std::size_t>(paint.first_column)) * 4], samples.data(), static_cast<std::size_t>(paint.end_column - paint.first_column));
+			}
+		}
+
+		for(std::size_t row = begin; row < end; ++row) {
+			uint8_t *const pixels = &frame_[row * output_width * 4];
+			for(int column = 0; column < left_gutter; ++column) {
+				pixels[column*4 + 0] = pixels[column*4 + 1] = pixels[column*4 + 2] = 0;
+			}
+			for(int column = right_gutter; column < static_cast<int>(output_width); ++column) {
+				pixels[column*4 + 0] = pixels[column*4 + 1] = pixels[column*4 + 2] = 0;
+			}
+		}
+	});
+}
@@ -0,0 +1,92 @@
+//
+//  SoftwareOutputBuilder.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 29/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef SoftwareOutputBuilder_hpp
+#define SoftwareOutputBuilder_hpp
+
+#include "OutputBuilder.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace Outputs {
+namespace CRT {
+
+/*!
+	An OutputBuilder that draws to memory without any use of OpenGL, using the C++ sampling functions
+	supplied alongside the GLSL ones.
+
+	Decoding follows the same steps as the OpenGL pipeline: source data is sampled into an intermediate line per
+	scan — at four samples per colour cycle for composite and s-video, with luminance and chrominance then
+	separated and filtered — before scans are painted into the frame with the same persistence as the OpenGL
+	output. Both stages are divided into bands that are processed concurrently.
+*/
+class SoftwareOutputBuilder: public OutputBuilder {
+	public:
+		SoftwareOutputBuilder(std::size_t bytes_per_pixel);
+		~SoftwareOutputBuilder();
+
+		void draw_frame(unsigned int output_width, unsigned int output_height, bool only_if_dirty) override;
+		const uint8_t *get_frame_pixels() override;
+
+	private:
+		const std::size_t bytes_per_pixel_;
+
+		// Copies of the source data and scans most recently submitted by the builders.
+		std::vector<uint8_t> source_texture_;
+		std::vector<uint8_t> source_runs_;
+		std::vector<uint8_t> output_runs_;
+
+		// Decoded RGBA pixels for each line of the intermediate buffer.
+		std::vector<uint8_t> decoded_lines_;
+		std::vector<std::size_t> line_run_starts_;
+		std::vector<std::size_t> line_runs_;
+		std::vector<uint16_t> lines_to_decode_;
+
+		// The accumulated frame, as 8-bit RGBA.
+		std::vector<uint8_t> frame_;
+		unsigned int frame_width_ = 0, frame_height_ = 0;
+
+		// A lookup table from normalised intensity to gamma-corrected 8-bit output.
+		static const int GammaTableSize = 1024;
+		uint8_t gamma_table_[GammaTableSize];
+		float gamma_table_gamma_ = -1.0f;
+
+		// Working storage for each thread that decodes or paints lines, so that neither allocates per line.
+		// Index 0 belongs to the thread that calls draw_frame, and index n to workers_[n-1].
+		struct Scratch {
+			std::vector<float> signals;		// All-zero other than while a line is being decoded.
+			std::vector<int> channels;
+			std::vector<uint8_t> pixels;
+			std::vector<uint8_t> samples;	// One output line's worth of RGBA.
+		};
+		std::vector<Scratch> scratch_;
+
+		struct Decoder;
+		void decode_line(const Decoder &decoder, uint16_t line, Scratch &scratch);
+
+		// Worker threads, and the means by which work is divided between them.
+		void perform_in_bands(std::size_t count, const std::function<void(std::size_t worker, std::size_t begin, std::size_t end)> &function);
+		void perform_bands(std::size_t worker);
+
+		std::vector<std::thread> workers_;
+		std::mutex work_mutex_;
+		std::condition_variable work_condition_, completion_condition_;
+		const std::function<void(std::size_t worker, std::size_t begin, std::size_t end)> *work_ = nullptr;
+		std::size_t work_count_ = 0, work_band_size_ = 0, outstanding_workers_ = 0;
+		std::atomic<std::size_t> next_band_;
+		unsigned int work_generation_ = 0;
+		bool workers_should_quit_ = false;
+};
+
+}
+}
+
+#endif /* SoftwareOutputBuilder_hpp */
@@ -39,16 +39,66 @@ const GLenum formatForDepth(std::size_t depth) {
 }
 
 TextureBuilder::TextureBuilder(std::size_t bytes_per_pixel, GLenum texture_unit) :
-		bytes_per_pixel_(bytes_per_pixel), texture_unit_(texture_unit) {
-	image_.resize(bytes_per_pixel * InputBufferBuilderWidth * InputBufferBuilderHeight);
+		bytes_per_pixel_(bytes_per_pixel), texture_unit_(texture_unit),
+		is_full_(false), first_unsubmitted_y_(0), flushed_position_(0), staged_ranges_{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}} {
 	glGenTextures(1, &texture_name_);
 
 	bind();
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormatForDepth(bytes_per_pixel), InputBufferBuilderWidth, InputBufferBuilderHeight, 0, formatForDepth(bytes_per_pixel), GL_UNSIGNED_BYTE, nullptr);
+
+	// Source data is streamed through a pixel buffer. If possible that buffer is mapped persistently
+	// and written to directly; otherwise data is built in client memory and copied in upon each submit.
+	const GLsizeiptr image_size = static_cast<GLsizeiptr>(bytes_per_pixel * InputBufferBuilderWidth * InputBufferBuilderHeight);
+	glGenBuffers(1, &pixel_buffer_);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+#ifdef GL_ARB_buffer_storage
+	if(supports_buffer_storage()) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, image_size, nullptr, flags);
+		image_ = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, image_size, flags));
+	}
+#endif
+	if(!image_) {
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, image_size, nullptr, GL_STREAM_DRAW);
+		image_storage_.resize(static_cast<std::size_t>(image_size));
+		image_ = image_storage_.data();
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+TextureBuilder::TextureBuilder(std::size_t bytes_per_pixel, std::function<void(uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows)> submission_function) :
+		bytes_per_pixel_(bytes_per_pixel), texture_unit_(0), submission_function_(submission_function),
+		is_full_(false), first_unsubmitted_y_(0), flushed_position_(0), staged_ranges_{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}} {
+	image_storage_.resize(bytes_per_pixel * InputBufferBuilderWidth * InputBufferBuilderHeight);
+	image_ = image_storage_.data();
 }
 
 TextureBuilder::~TextureBuilder() {
-	glDeleteTextures(1, &texture_name_);
+	if(!submission_function_) {
+		if(upload_fence_) glDeleteSync(upload_fence_);
+		if(image_storage_.empty()) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &pixel_buffer_);
+		glDeleteTextures(1, &texture_name_);
+	}
+}
+
+bool TextureBuilder::supports_buffer_storage() {
+	GLint major_version = 0, minor_version = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+	glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+	if(major_version > 4 || (major_version == 4 && minor_version >= 4)) return true;
+
+	GLint number_of_extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &number_of_extensions);
+	for(GLuint c = 0; c < static_cast<GLuint>(number_of_extensions); c++) {
+		const char *extension_name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, c));
+		if(extension_name && !std::strcmp(extension_name, "GL_ARB_buffer_storage")) return true;
+	}
+	return false;
 }
 
 void TextureBuilder::bind() {
@@ -137,35 +187,103 @@ bool TextureBuilder::is_full() {
 	return is_full_;
 }
 
-void TextureBuilder::submit() {
-	if(write_areas_start_y_ < first_unsubmitted_y_) {
-		// A write area start y less than the first line on which submissions began implies it must have wrapped
-		// around. So the submission set is everything back to zero before the current write area plus everything
-		// from the first unsubmitted y downward.
-		uint16_t height = write_areas_start_y_ + (write_areas_start_x_ ? 1 : 0);
+void TextureBuilder::submit_rows(uint16_t y, uint16_t height, uint16_t width, std::size_t buffer_offset) {
+	const std::size_t row_offset = y * bytes_per_pixel_ * InputBufferBuilderWidth;
+	if(submission_function_) {
+		submission_function_(y, height, width, &image_[row_offset]);
+	} else {
 		glTexSubImage2D(	GL_TEXTURE_2D, 0,
-							0, 0,
-							InputBufferBuilderWidth, height,
+							0, y,
+							width, height,
 							formatForDepth(bytes_per_pixel_), GL_UNSIGNED_BYTE,
-							image_.data());
+							reinterpret_cast<const GLvoid *>(buffer_offset));
+	}
+}
 
-		glTexSubImage2D(	GL_TEXTURE_2D, 0,
-							0, first_unsubmitted_y_,
-							InputBufferBuilderWidth, InputBufferBuilderHeight - first_unsubmitted_y_,
-							formatForDepth(bytes_per_pixel_), GL_UNSIGNED_BYTE,
-							image_.data() + first_unsubmitted_y_ * bytes_per_pixel_ * InputBufferBuilderWidth);
+void TextureBuilder::stage() {
+	const uint32_t flushed_position = flushed_position_.load(std::memory_order_acquire);
+	const uint16_t flushed_y = static_cast<uint16_t>(flushed_position >> 16);
+	const uint16_t flushed_x = static_cast<uint16_t>(flushed_position);
+
+	if(flushed_y < next_staged_y_) {
+		// A write area start y less than the first line on which submissions began implies it must have wrapped
+		// around. So the submission set is everything back to zero before the current write area plus everything
+		// from the first unsubmitted y downward.
+		staged_ranges_[0].y = 0;
+		staged_ranges_[0].height = flushed_y;
+		staged_ranges_[1].y = next_staged_y_;
+		staged_ranges_[1].height = InputBufferBuilderHeight - next_staged_y_;
 	} else {
 		// If the current write area start y is after the first unsubmitted line, just submit the region in between.
-		uint16_t height = write_areas_start_y_ + (write_areas_start_x_ ? 1 : 0) - first_unsubmitted_y_;
-		glTexSubImage2D(	GL_TEXTURE_2D, 0,
-							0, first_unsubmitted_y_,
-							InputBufferBuilderWidth, height,
-							formatForDepth(bytes_per_pixel_), GL_UNSIGNED_BYTE,
-							image_.data() + first_unsubmitted_y_ * bytes_per_pixel_ * InputBufferBuilderWidth);
+		staged_ranges_[0].y = next_staged_y_;
+		staged_ranges_[0].height = flushed_y - next_staged_y_;
+		staged_ranges_[1].height = 0;
+	}
+	staged_ranges_[0].width = staged_ranges_[1].width = InputBufferBuilderWidth;
+
+	// The writer may still be adding to the final row, so stage only the portion of it that has been flushed.
+	staged_ranges_[2].y = flushed_y;
+	staged_ranges_[2].height = flushed_x ? 1 : 0;
+	staged_ranges_[2].width = flushed_x;
+	staged_start_y_ = next_staged_y_;
+	next_staged_y_ = staged_end_y_ = flushed_y;
+}
+
+void TextureBuilder::submit() {
+	const std::size_t row_size = bytes_per_pixel_ * InputBufferBuilderWidth;
+
+	if(submission_function_) {
+		for(const auto &range: staged_ranges_) {
+			if(range.height) submit_rows(range.y, range.height, range.width, 0);
+		}
+		first_unsubmitted_y_ = staged_end_y_;
+	} else if(image_storage_.empty()) {
+		// The pixel buffer is mapped persistently, so data is already in place. Upload it, and release the rows
+		// that were uploaded last time, which the GPU will by now have finished with.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+		for(const auto &range: staged_ranges_) {
+			if(range.height) submit_rows(range.y, range.height, range.width, range.y * row_size);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if(upload_fence_) {
+			glClientWaitSync(upload_fence_, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(upload_fence_);
+		}
+		upload_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		first_unsubmitted_y_ = staged_start_y_;
+	} else {
+		// Orphan the pixel buffer, copy the staged rows into its replacement and upload from there.
+		// Each range is either of complete rows or is a single row, so its size is always height * width pixels.
+		std::size_t total_size = 0;
+		for(const auto &range: staged_ranges_) {
+			total_size += range.height * range.width * bytes_per_pixel_;
+		}
+		if(total_size) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(image_storage_.size()), nullptr, GL_STREAM_DRAW);
+			uint8_t *const destination = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(total_size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+			if(destination) {
+				std::size_t offset = 0;
+				for(const auto &range: staged_ranges_) {
+					const std::size_t range_size = range.height * range.width * bytes_per_pixel_;
+					std::memcpy(&destination[offset], &image_[range.y * row_size], range_size);
+					offset += range_size;
+				}
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+				offset = 0;
+				for(const auto &range: staged_ranges_) {
+					if(range.height) submit_rows(range.y, range.height, range.width, offset);
+					offset += range.height * range.width * bytes_per_pixel_;
+				}
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		first_unsubmitted_y_ = staged_end_y_;
 	}
 
-	// Update the starting location for the next submission, and mark definitively that the buffer is once again not full.
-	first_unsubmitted_y_ = write_areas_start_y_;
+	// Mark definitively that the buffer is once again not full.
 	is_full_ = false;
 }
 
@@ -176,4 +294,7 @@ void TextureBuilder::flush(const std::function<void(const std::vector<WriteArea>
 		function(write_areas_, number_of_write_areas_);
 	}
 	number_of_write_areas_ = 0;
+
+	// Publish the extent of everything flushed, for the benefit of stage.
+	flushed_position_.store((uint32_t(write_areas_start_y_) << 16) | write_areas_start_x_, std::memory_order_release);
 }
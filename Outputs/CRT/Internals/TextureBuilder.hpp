@@ -9,6 +9,7 @@
 #ifndef Outputs_CRT_Internals_TextureBuilder_hpp
 #define Outputs_CRT_Internals_TextureBuilder_hpp
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -28,6 +29,10 @@ namespace CRT {
 	Although this class is not itself inherently thread safe, it is built to permit one serialised stream
 	of calls to provide source data, with an interceding (but also serialised) submission to the GPU at any time.
 
+	Where ARB_buffer_storage is available, write areas are vended directly from a persistently-mapped pixel buffer,
+	so that submission involves no copying by the CPU. Otherwise they are vended from client memory, and submission
+	copies only the rows written since the last into a freshly-orphaned pixel buffer.
+
 
 	Intended usage by the data generator:
 
@@ -53,10 +58,13 @@ namespace CRT {
 
 	Intended usage by the GPU owner:
 
-		(i)		call submit to move data to the GPU and free up its CPU-side resources.
+		(i)		call stage to mark the current submission queue as the next to upload.
+		(ii)	call submit, at any time thereafter, to move staged data to the GPU and free up its CPU-side resources.
 
 	The latest data is now on the GPU, regardless of where the data provider may be in its process; only data
-	that has entered the submission queue is uploaded.
+	that had entered the submission queue when staged is uploaded. Each flush atomically publishes the extent of the
+	submission queue, and staged rows are not reused by the data generator until they have been submitted, so neither
+	step need be serialised with it.
 
 */
 class TextureBuilder {
@@ -64,6 +72,11 @@ class TextureBuilder {
 		/// Constructs an instance of InputTextureBuilder that contains a texture of colour depth @c bytes_per_pixel;
 		/// this creates a new texture and binds it to the current active texture unit.
 		TextureBuilder(std::size_t bytes_per_pixel, GLenum texture_unit);
+
+		/// Constructs an instance of TextureBuilder that contains a buffer of colour depth @c bytes_per_pixel and that,
+		/// rather than using OpenGL, will pass newly-submitted rows to @c submission_function; only the first @c width
+		/// pixels of each row are supplied.
+		TextureBuilder(std::size_t bytes_per_pixel, std::function<void(uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows)> submission_function);
 		virtual ~TextureBuilder();
 
 		/// Finds the first available space of at least @c required_length pixels in size which is suitably aligned
@@ -76,6 +89,11 @@ class TextureBuilder {
 		/// and indicates that its actual final size was @c actual_length.
 		void reduce_previous_allocation_to(std::size_t actual_length);
 
+		/// @returns The colour depth supplied at construction.
+		std::size_t get_bytes_per_pixel() const {
+			return bytes_per_pixel_;
+		}
+
 		/// Allocated runs are provisional; they will not appear in the next flush queue unless retained.
 		/// @returns @c true if a retain succeeded; @c false otherwise.
 		bool retain_latest();
@@ -87,7 +105,12 @@ class TextureBuilder {
 		/// being full; @c false if calls may succeed.
 		bool is_full();
 
-		/// Updates the currently-bound texture with all new data provided since the last @c submit.
+		/// Marks all data flushed since the last @c stage as the next to be submitted. This need not be serialised
+		/// with the data generator.
+		void stage();
+
+		/// Updates the currently-bound texture, or calls the submission function, with all data marked by the
+		/// most recent @c stage. This need not be serialised with the data generator.
 		void submit();
 
 		struct WriteArea {
@@ -106,9 +129,15 @@ class TextureBuilder {
 		std::size_t bytes_per_pixel_;
 		GLenum texture_unit_;
 
-		// the buffer
-		std::vector<uint8_t> image_;
-		GLuint texture_name_;
+		// the buffer; this is either a persistent mapping of pixel_buffer_ or else is image_storage_
+		uint8_t *image_ = nullptr;
+		std::vector<uint8_t> image_storage_;
+		GLuint texture_name_ = 0;
+		GLuint pixel_buffer_ = 0;
+		GLsync upload_fence_ = nullptr;
+		std::function<void(uint16_t y, uint16_t height, uint16_t width, const uint8_t *rows)> submission_function_;
+		void submit_rows(uint16_t y, uint16_t height, uint16_t width, std::size_t buffer_offset);
+		static bool supports_buffer_storage();
 
 		// the current write area
 		WriteArea write_area_;
@@ -116,8 +145,19 @@ class TextureBuilder {
 		// the list of write areas that have ascended to the flush queue
 		std::vector<WriteArea> write_areas_;
 		std::size_t number_of_write_areas_ = 0;
-		bool is_full_ = false, was_full_ = false;
-		uint16_t first_unsubmitted_y_ = 0;
+		std::atomic<bool> is_full_;
+		bool was_full_ = false;
+		std::atomic<uint16_t> first_unsubmitted_y_;
+
+		// The write area start position as of the most recent flush, as y in the high sixteen bits and x in the low.
+		std::atomic<uint32_t> flushed_position_;
+
+		// The rows marked by the most recent stage; if the submission queue wrapped around then the complete rows form two
+		// ranges. Any partially-flushed final row is a third range, narrowed to exclude the part still being written.
+		struct RowRange {
+			uint16_t y, height, width;
+		} staged_ranges_[3];
+		uint16_t next_staged_y_ = 0, staged_start_y_ = 0, staged_end_y_ = 0;
 		inline uint8_t *pointer_to_location(uint16_t x, uint16_t y);
 
 		// Usually: the start position for the current batch of write areas.
@@ -0,0 +1,62 @@
+//
+//  OpenGLFrameReader.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "OpenGLFrameReader.hpp"
+
+using namespace Outputs::Capture;
+
+OpenGLFrameReader::OpenGLFrameReader() {
+	for(auto &read: reads_) {
+		glGenBuffers(1, &read.buffer);
+	}
+}
+
+OpenGLFrameReader::~OpenGLFrameReader() {
+	for(auto &read: reads_) {
+		glDeleteBuffers(1, &read.buffer);
+	}
+}
+
+void OpenGLFrameReader::read(Recorder &recorder, int x, int y, int width, int height, Time::Seconds emulated_time) {
+	Read &read = reads_[next_read_];
+	next_read_ = (next_read_ + 1) % BufferCount;
+	if(read.is_pending) collect(recorder, read);
+
+	const GLsizeiptr size = static_cast<GLsizeiptr>(width * height * 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer);
+	if(read.width != width || read.height != height) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+	}
+	glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	read.is_pending = true;
+	read.width = width;
+	read.height = height;
+	read.emulated_time = emulated_time;
+}
+
+void OpenGLFrameReader::flush(Recorder &recorder) {
+	// Collect in order of issue, starting from the oldest.
+	for(int c = 0; c < BufferCount; ++c) {
+		Read &read = reads_[(next_read_ + c) % BufferCount];
+		if(read.is_pending) collect(recorder, read);
+	}
+}
+
+void OpenGLFrameReader::collect(Recorder &recorder, Read &read) {
+	const GLsizeiptr size = static_cast<GLsizeiptr>(read.width * read.height * 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer);
+	const uint8_t *const pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+	if(pixels) {
+		recorder.add_frame(pixels, static_cast<unsigned int>(read.width), static_cast<unsigned int>(read.height), true, read.emulated_time);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	read.is_pending = false;
+}
@@ -0,0 +1,57 @@
+//
+//  OpenGLFrameReader.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef OpenGLFrameReader_hpp
+#define OpenGLFrameReader_hpp
+
+#include "Recorder.hpp"
+#include "../CRT/Internals/OpenGL.hpp"
+
+namespace Outputs {
+namespace Capture {
+
+/*!
+	Reads back frames from the current OpenGL framebuffer for a Recorder without stalling the pipeline:
+	each read is directed into one of a ring of pixel buffers and not collected until that buffer next
+	comes around, by which time the transfer will normally be complete.
+
+	All methods must be called with the relevant OpenGL context current.
+*/
+class OpenGLFrameReader {
+	public:
+		OpenGLFrameReader();
+		~OpenGLFrameReader();
+
+		/*!
+			Begins an asynchronous read of the area of the current read framebuffer with bottom-left corner
+			(@c x, @c y) and size @c width by @c height, which will be tagged with @c emulated_time. Passes
+			to @c recorder the oldest outstanding read, if that would otherwise be overwritten.
+		*/
+		void read(Recorder &recorder, int x, int y, int width, int height, Time::Seconds emulated_time);
+
+		/// Passes all outstanding reads to @c recorder.
+		void flush(Recorder &recorder);
+
+	private:
+		static const int BufferCount = 3;
+
+		struct Read {
+			GLuint buffer = 0;
+			bool is_pending = false;
+			int width = 0, height = 0;
+			Time::Seconds emulated_time = 0.0;
+		} reads_[BufferCount];
+		int next_read_ = 0;
+
+		void collect(Recorder &recorder, Read &read);
+};
+
+}
+}
+
+#endif /* OpenGLFrameReader_hpp */
@@ -0,0 +1,235 @@
+//
+//  Recorder.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "Recorder.hpp"
+
+#include <cmath>
+
+using namespace Outputs::Capture;
+
+Recorder::Recorder(
+	const std::string &video_file_name, VideoFormat video_format, unsigned int width, unsigned int height, unsigned int frames_per_second,
+	const std::string &audio_file_name, unsigned int sample_rate) :
+		video_format_(video_format),
+		width_(width),
+		height_(height),
+		frames_per_second_(frames_per_second) {
+	if(!video_file_name.empty()) {
+		video_file_.reset(new Storage::FileHolder(video_file_name, Storage::FileHolder::FileMode::Rewrite));
+		converted_frame_.resize(width_ * height_ * 3);
+
+		if(video_format_ == VideoFormat::Y4M) {
+			const std::string header =
+				"YUV4MPEG2 W" + std::to_string(width_) + " H" + std::to_string(height_) +
+				" F" + std::to_string(frames_per_second_) + ":1 Ip A1:1 C444\n";
+			video_file_->write(reinterpret_cast<const uint8_t *>(header.data()), header.size());
+		}
+
+		for(std::size_t c = 0; c < FramePoolSize; ++c) {
+			free_frames_.emplace_back(new Frame);
+		}
+	}
+
+	if(!audio_file_name.empty()) {
+		audio_file_.reset(new Storage::FileHolder(audio_file_name, Storage::FileHolder::FileMode::Rewrite));
+
+		// Write a canonical 16-bit mono WAV header; the two sizes it contains are completed upon destruction.
+		audio_file_->write(reinterpret_cast<const uint8_t *>("RIFF"), 4);
+		audio_file_->put_le<uint32_t>(36);
+		audio_file_->write(reinterpret_cast<const uint8_t *>("WAVEfmt "), 8);
+		audio_file_->put_le<uint32_t>(16);				// Size of the format chunk.
+		audio_file_->put_le<uint16_t>(1);				// PCM.
+		audio_file_->put_le<uint16_t>(1);				// Channels.
+		audio_file_->put_le<uint32_t>(sample_rate);
+		audio_file_->put_le<uint32_t>(sample_rate * 2);	// Bytes per second.
+		audio_file_->put_le<uint16_t>(2);				// Bytes per sample frame.
+		audio_file_->put_le<uint16_t>(16);				// Bits per sample.
+		audio_file_->write(reinterpret_cast<const uint8_t *>("data"), 4);
+		audio_file_->put_le<uint32_t>(0);
+
+		for(std::size_t c = 0; c < SamplesPoolSize; ++c) {
+			free_samples_.emplace_back(new Samples);
+		}
+	}
+
+	writer_ = std::thread([this] { run(); });
+}
+
+Recorder::~Recorder() {
+	{
+		std::lock_guard<std::mutex> lock_guard(lock_);
+		should_quit_ = true;
+	}
+	condition_.notify_all();
+	writer_.join();
+
+	if(audio_file_) {
+		// Pad with any samples dropped since the last that were written, then complete the header.
+		Samples silence;
+		silence.preceding_silence = dropped_samples_;
+		write_samples(silence);
+
+		const uint32_t data_size = samples_written_ * 2;
+		audio_file_->seek(4, SEEK_SET);
+		audio_file_->put_le<uint32_t>(36 + data_size);
+		audio_file_->seek(40, SEEK_SET);
+		audio_file_->put_le<uint32_t>(data_size);
+	}
+}
+
+// MARK: - Producer side.
+
+void Recorder::add_frame(const uint8_t *pixels, unsigned int width, unsigned int height, bool is_bottom_up, Time::Seconds emulated_time) {
+	std::unique_ptr<Frame> frame;
+	{
+		std::lock_guard<std::mutex> lock_guard(lock_);
+		if(!video_file_) return;
+		if(free_frames_.empty()) {
+			++dropped_frames_;
+			return;
+		}
+		frame = std::move(free_frames_.back());
+		free_frames_.pop_back();
+	}
+
+	frame->pixels.assign(pixels, pixels + width * height * 4);
+	frame->width = width;
+	frame->height = height;
+	frame->is_bottom_up = is_bottom_up;
+	frame->emulated_time = emulated_time;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(lock_);
+		pending_frames_.push_back(std::move(frame));
+	}
+	condition_.notify_all();
+}
+
+void Recorder::add_samples(const std::vector<int16_t> &samples) {
+	std::unique_ptr<Samples> buffer;
+	{
+		std::lock_guard<std::mutex> lock_guard(lock_);
+		if(!audio_file_) return;
+		if(free_samples_.empty()) {
+			dropped_samples_ += samples.size();
+			return;
+		}
+		buffer = std::move(free_samples_.back());
+		free_samples_.pop_back();
+		buffer->preceding_silence = dropped_samples_;
+		dropped_samples_ = 0;
+	}
+
+	buffer->samples = samples;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(lock_);
+		pending_samples_.push_back(std::move(buffer));
+	}
+	condition_.notify_all();
+}
+
+std::size_t Recorder::get_dropped_frames() {
+	std::lock_guard<std::mutex> lock_guard(lock_);
+	return dropped_frames_;
+}
+
+// MARK: - Writer side.
+
+void Recorder::run() {
+	std::vector<std::unique_ptr<Frame>> frames;
+	std::vector<std::unique_ptr<Samples>> samples;
+
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(lock_);
+
+			// Return the buffers written last time around to the pool.
+			for(auto &frame: frames) free_frames_.push_back(std::move(frame));
+			for(auto &buffer: samples) free_samples_.push_back(std::move(buffer));
+			frames.clear();
+			samples.clear();
+
+			condition_.wait(lock, [this] {
+				return should_quit_ || !pending_frames_.empty() || !pending_samples_.empty();
+			});
+			if(pending_frames_.empty() && pending_samples_.empty()) return;
+
+			std::swap(frames, pending_frames_);
+			std::swap(samples, pending_samples_);
+		}
+
+		for(const auto &frame: frames) write_frame(*frame);
+		for(const auto &buffer: samples) write_samples(*buffer);
+	}
+}
+
+void Recorder::write_frame(const Frame &frame) {
+	// Determine where this frame sits on the output timeline; if a frame has already been written
+	// for that position then this one is surplus.
+	const long long index = std::llround(frame.emulated_time * static_cast<double>(frames_per_second_));
+	if(index < frames_written_) return;
+
+	// Fill any gap with repeats of the previous frame.
+	if(frames_written_) {
+		while(frames_written_ < index) write_converted_frame();
+	}
+
+	// Scale and convert. Y4M is planar; raw RGB is interleaved.
+	const std::size_t plane_size = width_ * height_;
+	uint8_t *output = converted_frame_.data();
+	for(unsigned int y = 0; y < height_; ++y) {
+		unsigned int source_y = (y * frame.height) / height_;
+		if(frame.is_bottom_up) source_y = frame.height - 1 - source_y;
+		const uint8_t *const source_row = &frame.pixels[source_y * frame.width * 4];
+
+		for(unsigned int x = 0; x < width_; ++x) {
+			const uint8_t *const source = &source_row[((x * frame.width) / width_) * 4];
+			const int red = source[0], green = source[1], blue = source[2];
+
+			switch(video_format_) {
+				case VideoFormat::Y4M:
+					// Convert to BT.601 studio-range YCbCr.
+					output[0] = static_cast<uint8_t>((((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16));
+					output[plane_size] = static_cast<uint8_t>((((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128));
+					output[plane_size * 2] = static_cast<uint8_t>((((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128));
+					++output;
+				break;
+
+				case VideoFormat::RGB:
+					output[0] = source[0];
+					output[1] = source[1];
+					output[2] = source[2];
+					output += 3;
+				break;
+			}
+		}
+	}
+
+	while(frames_written_ <= index) write_converted_frame();
+}
+
+void Recorder::write_converted_frame() {
+	if(video_format_ == VideoFormat::Y4M) {
+		video_file_->write(reinterpret_cast<const uint8_t *>("FRAME\n"), 6);
+	}
+	video_file_->write(converted_frame_);
+	++frames_written_;
+}
+
+void Recorder::write_samples(const Samples &samples) {
+	std::vector<uint8_t> bytes((samples.preceding_silence + samples.samples.size()) * 2, 0);
+	uint8_t *output = &bytes[samples.preceding_silence * 2];
+	for(const auto sample: samples.samples) {
+		output[0] = static_cast<uint8_t>(sample & 0xff);
+		output[1] = static_cast<uint8_t>((sample >> 8) & 0xff);
+		output += 2;
+	}
+	audio_file_->write(bytes);
+	samples_written_ += static_cast<uint32_t>(samples.preceding_silence + samples.samples.size());
+}
@@ -0,0 +1,116 @@
+//
+//  Recorder.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 30/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef Recorder_hpp
+#define Recorder_hpp
+
+#include "../../ClockReceiver/TimeTypes.hpp"
+#include "../../Storage/FileHolder.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Outputs {
+namespace Capture {
+
+/*!
+	A Recorder writes video frames and audio samples to disk on a thread of its own.
+
+	Video is written at a constant frame rate as either a YUV4MPEG2 stream or as raw 24-bit RGB; audio is
+	written as a 16-bit mono WAV. Frames are placed according to the emulated time supplied with them
+	rather than the time at which they arrive, repeating the previous frame to fill any gaps, so that
+	video and audio remain in step at any emulation speed.
+
+	Frames and samples are copied into a fixed pool of buffers. If the writer falls behind and the pool
+	is exhausted then new frames are dropped and new samples are replaced with silence, so neither
+	@c add_frame nor @c add_samples will ever wait upon the disk.
+*/
+class Recorder {
+	public:
+		enum class VideoFormat {
+			/// A YUV4MPEG2 stream, using 4:4:4 sampling.
+			Y4M,
+			/// Headerless 24-bit RGB, top row first.
+			RGB
+		};
+
+		/*!
+			Creates a Recorder that will write video to @c video_file_name, as @c video_format at a size of
+			@c width by @c height and a rate of @c frames_per_second, and audio to @c audio_file_name at
+			@c sample_rate. Either file name may be empty to omit that stream.
+
+			@raises Storage::FileHolder::Error::CantOpen if either file cannot be opened.
+		*/
+		Recorder(
+			const std::string &video_file_name, VideoFormat video_format, unsigned int width, unsigned int height, unsigned int frames_per_second,
+			const std::string &audio_file_name, unsigned int sample_rate);
+
+		/// Writes everything still queued and finalises both files.
+		~Recorder();
+
+		/*!
+			Queues a frame of 8-bit RGBA pixels, @c width by @c height, that represents the display at
+			@c emulated_time. Frames that differ in size from the recording are scaled to fit.
+
+			@param is_bottom_up @c true if rows are ordered bottom first, as per @c glReadPixels; @c false otherwise.
+		*/
+		void add_frame(const uint8_t *pixels, unsigned int width, unsigned int height, bool is_bottom_up, Time::Seconds emulated_time);
+
+		/// Queues @c samples, which are assumed to continue directly from those previously added.
+		void add_samples(const std::vector<int16_t> &samples);
+
+		/// @returns The number of frames so far dropped because the writer had fallen behind.
+		std::size_t get_dropped_frames();
+
+	private:
+		struct Frame {
+			std::vector<uint8_t> pixels;
+			unsigned int width = 0, height = 0;
+			bool is_bottom_up = false;
+			Time::Seconds emulated_time = 0.0;
+		};
+		struct Samples {
+			std::vector<int16_t> samples;
+			std::size_t preceding_silence = 0;
+		};
+
+		static const std::size_t FramePoolSize = 8;
+		static const std::size_t SamplesPoolSize = 64;
+
+		// Buffers are passed between the free and pending lists under lock_, but filled and written without it.
+		std::mutex lock_;
+		std::condition_variable condition_;
+		std::vector<std::unique_ptr<Frame>> free_frames_, pending_frames_;
+		std::vector<std::unique_ptr<Samples>> free_samples_, pending_samples_;
+		std::size_t dropped_frames_ = 0, dropped_samples_ = 0;
+		bool should_quit_ = false;
+
+		void run();
+		void write_frame(const Frame &frame);
+		void write_samples(const Samples &samples);
+		void write_converted_frame();
+
+		std::unique_ptr<Storage::FileHolder> video_file_, audio_file_;
+		const VideoFormat video_format_;
+		const unsigned int width_, height_, frames_per_second_;
+		std::vector<uint8_t> converted_frame_;
+		long long frames_written_ = 0;
+		uint32_t samples_written_ = 0;
+
+		std::thread writer_;
+};
+
+}
+}
+
+#endif /* Recorder_hpp */
@@ -0,0 +1,204 @@
+//
+//  InflateStream.cpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 27/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#include "InflateStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Storage::Data;
+
+const std::size_t InflateStream::WindowSize;
+const uint64_t InflateStream::AccessPointSpacing;
+
+InflateStream::InflateStream(std::vector<uint8_t> &&source, Format format) :
+	source_(std::move(source)),
+	format_(format),
+	stream_() {
+	if(format_ == Format::Uncompressed) return;
+
+	stream_.next_in = source_.data();
+	stream_.avail_in = static_cast<uInt>(source_.size());
+
+	// A window size of 15 bits is the maximum permitted; adding 16 selects gzip rather than zlib wrapping.
+	if(inflateInit2(&stream_, (format_ == Format::GZip) ? 15 + 16 : 15) != Z_OK) {
+		throw Error::CantInitialise;
+	}
+}
+
+InflateStream::~InflateStream() {
+	if(format_ != Format::Uncompressed) inflateEnd(&stream_);
+}
+
+InflateStream::AccessPoint::~AccessPoint() {
+	inflateEnd(&stream);
+}
+
+// MARK: - Reading
+
+std::size_t InflateStream::read(uint8_t *buffer, std::size_t size) {
+	std::size_t bytes_read = 0;
+	while(bytes_read < size) {
+		if(window_pointer_ == window_size_ && !fill_window()) {
+			eof_ = true;
+			break;
+		}
+
+		const std::size_t bytes_to_copy = std::min(size - bytes_read, window_size_ - window_pointer_);
+		std::memcpy(&buffer[bytes_read], &window_[window_pointer_], bytes_to_copy);
+		window_pointer_ += bytes_to_copy;
+		bytes_read += bytes_to_copy;
+	}
+	return bytes_read;
+}
+
+uint8_t InflateStream::get8() {
+	if(window_pointer_ < window_size_) return window_[window_pointer_++];
+
+	uint8_t result = 0;
+	read(&result, 1);
+	return result;
+}
+
+uint16_t InflateStream::get16le() {
+	uint16_t result = get8();
+	result |= get8() << 8;
+	return result;
+}
+
+uint32_t InflateStream::get24le() {
+	uint32_t result = get8();
+	result |= get8() << 8;
+	result |= get8() << 16;
+	return result;
+}
+
+uint32_t InflateStream::get32le() {
+	uint32_t result = get8();
+	result |= get8() << 8;
+	result |= get8() << 16;
+	result |= static_cast<uint32_t>(get8()) << 24;
+	return result;
+}
+
+bool InflateStream::eof() const {
+	return eof_;
+}
+
+bool InflateStream::is_at_end() {
+	if(window_pointer_ < window_size_) return false;
+	return !fill_window();
+}
+
+// MARK: - Seeking
+
+uint64_t InflateStream::tell() const {
+	return window_start_ + window_pointer_;
+}
+
+void InflateStream::seek(uint64_t offset) {
+	eof_ = false;
+
+	// If the target is within the current window then there's nothing to do.
+	if(offset >= window_start_ && offset <= window_start_ + window_size_) {
+		window_pointer_ = static_cast<std::size_t>(offset - window_start_);
+		return;
+	}
+
+	// Uncompressed data can be windowed from anywhere.
+	if(format_ == Format::Uncompressed) {
+		window_start_ = offset;
+		window_size_ = window_pointer_ = 0;
+		return;
+	}
+
+	// Restart decompression from the final access point before the target if the target is
+	// behind the current window, or if that access point is ahead of it.
+	const auto next_access_point = std::upper_bound(access_points_.begin(), access_points_.end(), offset,
+		[](uint64_t lhs, const std::unique_ptr<AccessPoint> &rhs) { return lhs < rhs->offset; });
+	const AccessPoint *const access_point = (next_access_point == access_points_.begin()) ? nullptr : (next_access_point - 1)->get();
+	if(offset < window_start_ || (access_point && access_point->offset > window_start_ + window_size_)) {
+		restart(access_point);
+	}
+
+	// Decompress forwards until the target is in the window, or the stream ends.
+	while(offset > window_start_ + window_size_) {
+		if(!fill_window()) break;
+	}
+	window_pointer_ = static_cast<std::size_t>(std::min(offset - window_start_, static_cast<uint64_t>(window_size_)));
+}
+
+void InflateStream::restart(const AccessPoint *access_point) {
+	window_size_ = window_pointer_ = 0;
+
+	if(access_point) {
+		inflateEnd(&stream_);
+		inflateCopy(&stream_, const_cast<z_stream *>(&access_point->stream));
+		window_start_ = access_point->offset;
+		stream_has_ended_ = access_point->stream_has_ended;
+	} else {
+		inflateReset(&stream_);
+		stream_.next_in = source_.data();
+		stream_.avail_in = static_cast<uInt>(source_.size());
+		window_start_ = 0;
+		stream_has_ended_ = false;
+	}
+}
+
+// MARK: - Decompression
+
+bool InflateStream::fill_window() {
+	window_start_ += window_size_;
+	window_size_ = window_pointer_ = 0;
+
+	if(format_ == Format::Uncompressed) {
+		if(window_start_ >= source_.size()) return false;
+		window_size_ = std::min(WindowSize, static_cast<std::size_t>(source_.size() - window_start_));
+		std::memcpy(window_, &source_[static_cast<std::size_t>(window_start_)], window_size_);
+		return true;
+	}
+
+	// Capture an access point if this is sufficiently far beyond the last. Windows are decompressed
+	// strictly in order from the latest access point, so the list remains sorted.
+	const uint64_t next_access_point = access_points_.empty() ? AccessPointSpacing : access_points_.back()->offset + AccessPointSpacing;
+	if(window_start_ >= next_access_point) {
+		std::unique_ptr<AccessPoint> access_point(new AccessPoint());
+		access_point->offset = window_start_;
+		access_point->stream_has_ended = stream_has_ended_;
+		if(inflateCopy(&access_point->stream, &stream_) == Z_OK) {
+			access_points_.push_back(std::move(access_point));
+		}
+	}
+
+	while(window_size_ < WindowSize && !stream_has_ended_) {
+		stream_.next_out = &window_[window_size_];
+		stream_.avail_out = static_cast<uInt>(WindowSize - window_size_);
+		const int result = inflate(&stream_, Z_NO_FLUSH);
+		window_size_ = WindowSize - stream_.avail_out;
+
+		switch(result) {
+			case Z_OK: break;
+
+			case Z_STREAM_END:
+				// gzip permits multiple members to be concatenated.
+				if(format_ == Format::GZip && stream_.avail_in) {
+					inflateReset(&stream_);
+				} else {
+					stream_has_ended_ = true;
+				}
+			break;
+
+			default:
+				// Treat any error, including truncated input, as the end of the stream.
+				stream_has_ended_ = true;
+			break;
+		}
+	}
+
+	return window_size_ > 0;
+}
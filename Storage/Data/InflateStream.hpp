@@ -0,0 +1,119 @@
+//
+//  InflateStream.hpp
+//  Clock Signal
+//
+//  Created by Thomas Harte on 27/09/2018.
+//  Copyright 2018 Thomas Harte. All rights reserved.
+//
+
+#ifndef InflateStream_hpp
+#define InflateStream_hpp
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+namespace Storage {
+namespace Data {
+
+/*!
+	Provides sequential access to the decompressed form of a zlib or gzip stream, decompressing
+	on demand into a small window rather than all at once.
+
+	Arbitrary seeks are supported. To keep them cheap, a copy of the decompressor state is retained
+	every @c AccessPointSpacing bytes of output as decompression proceeds, so that a seek need
+	decompress at most that much.
+
+	An uncompressed source can also be supplied, allowing owners to treat compressed and
+	uncompressed data uniformly.
+*/
+class InflateStream {
+	public:
+		enum class Format {
+			Uncompressed,
+			ZLib,
+			GZip
+		};
+
+		enum class Error {
+			CantInitialise = -1
+		};
+
+		/*!
+			Constructs an @c InflateStream that will decompress @c source, which is in @c format.
+
+			@throws Error::CantInitialise if zlib is unable to set up a decompressor, e.g. for lack of memory.
+		*/
+		InflateStream(std::vector<uint8_t> &&source, Format format);
+		~InflateStream();
+
+		InflateStream(const InflateStream &) = delete;
+		InflateStream &operator =(const InflateStream &) = delete;
+
+		/*!
+			Reads up to @c size bytes into @c buffer.
+
+			@returns the number of bytes read, which will be less than @c size only if the end
+			of the stream was reached, in which case the end-of-file indicator will be set.
+		*/
+		std::size_t read(uint8_t *buffer, std::size_t size);
+
+		/*! Reads a single byte; returns 0 and sets the end-of-file indicator if none is available. */
+		uint8_t get8();
+
+		/*! Performs @c get8 two times, returning the results assembled in little endian order. */
+		uint16_t get16le();
+
+		/*! Performs @c get8 three times, returning the results assembled in little endian order. */
+		uint32_t get24le();
+
+		/*! Performs @c get8 four times, returning the results assembled in little endian order. */
+		uint32_t get32le();
+
+		/*!
+			Moves to @c offset within the decompressed stream, and clears the end-of-file indicator.
+		*/
+		void seek(uint64_t offset);
+
+		/*! @returns The current offset within the decompressed stream. */
+		uint64_t tell() const;
+
+		/*! @returns @c true if the end-of-file indicator is set, i.e. if a read has run out of data. */
+		bool eof() const;
+
+		/*! @returns @c true if no further bytes are available; may decompress in order to find out. */
+		bool is_at_end();
+
+	private:
+		static const std::size_t WindowSize = 4096;
+		static const uint64_t AccessPointSpacing = 1024*1024;
+
+		std::vector<uint8_t> source_;
+		Format format_;
+		z_stream stream_;
+		bool stream_has_ended_ = false;
+
+		uint8_t window_[WindowSize];
+		uint64_t window_start_ = 0;
+		std::size_t window_size_ = 0;
+		std::size_t window_pointer_ = 0;
+		bool eof_ = false;
+
+		struct AccessPoint {
+			uint64_t offset;
+			bool stream_has_ended;
+			z_stream stream;
+
+			~AccessPoint();
+		};
+		std::vector<std::unique_ptr<AccessPoint>> access_points_;
+
+		bool fill_window();
+		void restart(const AccessPoint *access_point);
+};
+
+}
+}
+
+#endif /* InflateStream_hpp */
@@ -42,13 +42,13 @@ Drive &Controller::get_drive() {
 
 void Controller::process_event(const Track::Event &event) {
 	switch(event.type) {
-		case Track::Event::FluxTransition:	pll_->add_pulse();		break;
+		case Track::Event::FluxTransition:	if(is_decoding_flux_) pll_->add_pulse();	break;
 		case Track::Event::IndexHole:		process_index_hole();	break;
 	}
 }
 
 void Controller::advance(const Cycles cycles) {
-	if(is_reading_) pll_->run_for(Cycles(cycles.as_int() * clock_rate_multiplier_));
+	if(is_reading_ && is_decoding_flux_) pll_->run_for(Cycles(cycles.as_int() * clock_rate_multiplier_));
 }
 
 void Controller::process_write_completed() {
@@ -83,11 +83,13 @@ void Controller::set_drive(std::shared_ptr<Drive> drive) {
 		if(drive_) {
 			drive_->set_event_delegate(nullptr);
 			drive_->set_clocking_hint_observer(nullptr);
+			drive_->set_announces_flux_transitions(true);
 		}
 		drive_ = drive;
 		if(drive_) {
 			drive_->set_event_delegate(this);
 			drive_->set_clocking_hint_observer(this);
+			drive_->set_announces_flux_transitions(is_decoding_flux_);
 		} else {
 			drive_ = empty_drive_;
 		}
@@ -113,3 +115,8 @@ void Controller::end_writing() {
 bool Controller::is_reading() {
 	return is_reading_;
 }
+
+void Controller::set_is_decoding_flux(bool is_decoding_flux) {
+	is_decoding_flux_ = is_decoding_flux;
+	get_drive().set_announces_flux_transitions(is_decoding_flux);
+}
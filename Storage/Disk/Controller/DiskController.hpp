@@ -93,6 +93,14 @@ class Controller:
 		*/
 		bool is_reading();
 
+		/*!
+			Enables or disables flux-level decoding. While disabled, the drive announces only index holes,
+			the PLL is idle and subclasses will not receive calls to @c process_input_bit.
+
+			This is intended for high-level shortcuts that obtain track content by other means.
+		*/
+		void set_is_decoding_flux(bool is_decoding_flux);
+
 		/*!
 			Returns the connected drive or, if none is connected, an invented one. No guarantees are
 			made about the lifetime or the exclusivity of the invented drive.
@@ -110,6 +118,7 @@ class Controller:
 		int clock_rate_ = 1;
 
 		bool is_reading_ = true;
+		bool is_decoding_flux_ = true;
 
 		std::shared_ptr<DigitalPhaseLockedLoop> pll_;
 		std::shared_ptr<Drive> drive_;
@@ -10,11 +10,14 @@
 
 #include "../Encodings/MFM/Constants.hpp"
 
+#include <algorithm>
+
 using namespace Storage::Disk;
 
 MFMController::MFMController(Cycles clock_rate) :
 	Storage::Disk::Controller(clock_rate),
-	shifter_(&crc_generator_) {
+	shifter_(&crc_generator_),
+	clock_rate_(clock_rate.as_int()) {
 }
 
 void MFMController::process_index_hole() {
@@ -44,6 +47,70 @@ void MFMController::set_data_mode(DataMode mode) {
 	shifter_.set_should_obey_syncs(mode == DataMode::Scanning);
 }
 
+void MFMController::set_fast_sector_transfer(bool enabled, int speed_multiplier) {
+	fast_sector_transfer_enabled_ = enabled;
+	fast_transfer_speed_multiplier_ = std::max(speed_multiplier, 1);
+	if(!enabled) {
+		fast_transfer_track_ = nullptr;
+		fast_transfer_sectors_ = nullptr;
+	}
+}
+
+bool MFMController::get_fast_transfer_sector(const Storage::Encodings::MFM::Sector::Address &address, uint8_t size, bool compare_side, bool compare_size, std::shared_ptr<const Storage::Encodings::MFM::Sector> &sector) {
+	sector = nullptr;
+	if(!fast_sector_transfer_enabled_ || !is_reading()) return false;
+
+	// Decode the track under the head, unless that has been done already.
+	const std::shared_ptr<Track> track = get_drive().get_current_track();
+	if(!track) return false;
+	if(track != fast_transfer_track_ || is_double_density_ != fast_transfer_track_is_double_density_) {
+		fast_transfer_track_ = track;
+		fast_transfer_track_is_double_density_ = is_double_density_;
+		fast_transfer_sectors_ = Storage::Encodings::MFM::sectors_from_track(*track, is_double_density_);
+
+		// Anything unusual on the track is left for the flux-level decoder.
+		fast_transfer_track_is_clean_ = true;
+		for(const auto &candidate: *fast_transfer_sectors_) {
+			if(
+				candidate.has_header_crc_error ||
+				candidate.has_data_crc_error ||
+				candidate.samples.size() != 1 ||
+				candidate.size > 7 ||
+				candidate.samples[0].size() != static_cast<std::size_t>(128 << candidate.size)
+			) {
+				fast_transfer_track_is_clean_ = false;
+				break;
+			}
+		}
+	}
+	if(!fast_transfer_track_is_clean_) return false;
+
+	// Find the matching sector, declining if there is more than one.
+	for(const auto &candidate: *fast_transfer_sectors_) {
+		if(
+			candidate.address.track != address.track ||
+			candidate.address.sector != address.sector ||
+			(compare_side && candidate.address.side != address.side) ||
+			(compare_size && candidate.size != size)
+		) continue;
+
+		if(sector) {
+			sector = nullptr;
+			return false;
+		}
+		// Share ownership of the table, so that the sector outlives any subsequent change of track
+		// or disabling of fast transfer while the caller is still reading from it.
+		sector = std::shared_ptr<const Storage::Encodings::MFM::Sector>(fast_transfer_sectors_, &candidate);
+	}
+	return true;
+}
+
+Cycles MFMController::get_fast_transfer_byte_period() {
+	// Each byte is sixteen bits on the disk surface, at 500kbps in MFM and 250kbps in FM.
+	const int natural_period = (clock_rate_ * 16) / (is_double_density_ ? 500000 : 250000);
+	return Cycles(std::max(natural_period / fast_transfer_speed_multiplier_, 1));
+}
+
 MFMController::Token MFMController::get_latest_token() {
 	return latest_token_;
 }
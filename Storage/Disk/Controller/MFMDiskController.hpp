@@ -12,6 +12,7 @@
 #include "DiskController.hpp"
 #include "../../../NumberTheory/CRC.hpp"
 #include "../../../ClockReceiver/ClockReceiver.hpp"
+#include "../Encodings/MFM/Parser.hpp"
 #include "../Encodings/MFM/Shifter.hpp"
 
 namespace Storage {
@@ -32,6 +33,28 @@ class MFMController: public Controller {
 		/// @returns @c true if currently decoding MFM content; @c false otherwise.
 		bool get_is_double_density();
 
+		/*!
+			Enables or disables fast sector transfer. While enabled, sector reads that can be satisfied from a
+			cleanly-decoded copy of the track under the head skip both the wait for the sector to arrive and
+			flux-level decoding, supplying data at @c speed_multiplier times the natural rate.
+		*/
+		void set_fast_sector_transfer(bool enabled, int speed_multiplier = 1);
+
+		/*!
+			Searches the track under the head for a sector that may be transferred without flux-level
+			decoding. Sectors are matched by track and sector number, by side if @c compare_side is @c true
+			and by size if @c compare_size is @c true.
+
+			@returns @c true if fast sector transfer is enabled and the track under the head decoded without
+			error, in which case @c sector is set to the matching sector, or to @c nullptr if the track
+			contains no such sector; @c false if the caller should proceed at the flux level. @c sector keeps the
+			decoded track alive, so it remains valid for as long as the caller retains it.
+		*/
+		bool get_fast_transfer_sector(const Encodings::MFM::Sector::Address &address, uint8_t size, bool compare_side, bool compare_size, std::shared_ptr<const Encodings::MFM::Sector> &sector);
+
+		/// @returns The time taken to supply each byte during fast sector transfer.
+		Cycles get_fast_transfer_byte_period();
+
 		enum DataMode {
 			/// When the controller is scanning it will obey all synchronisation marks found, even if in the middle of data.
 			Scanning,
@@ -164,6 +187,15 @@ class MFMController: public Controller {
 
 		// CRC generator
 		CRC::CCITT crc_generator_;
+
+		// Fast sector transfer.
+		int clock_rate_;
+		bool fast_sector_transfer_enabled_ = false;
+		int fast_transfer_speed_multiplier_ = 1;
+		std::shared_ptr<Track> fast_transfer_track_;
+		bool fast_transfer_track_is_double_density_ = false;
+		bool fast_transfer_track_is_clean_ = false;
+		std::shared_ptr<Encodings::MFM::SectorTable> fast_transfer_sectors_;
 };
 
 }
@@ -89,6 +89,26 @@ std::shared_ptr<Track> Drive::step_to(HeadPosition offset) {
 	return track_;
 }
 
+std::shared_ptr<Track> Drive::get_current_track() {
+	return get_track();
+}
+
+void Drive::set_announces_flux_transitions(bool announces_flux_transitions) {
+	if(announces_flux_transitions_ == announces_flux_transitions) return;
+	announces_flux_transitions_ = announces_flux_transitions;
+
+	// Whatever comes next, the track will need to be picked up again from the current rotational position.
+	track_ = nullptr;
+
+	// Ceasing flux announcements can wait for the next event, which will be imminent. Resuming them can't
+	// wait for what may be most of a rotation until the next index hole, so reschedule now unless an
+	// event is already being processed, in which case rescheduling will happen anyway.
+	if(announces_flux_transitions_ && !is_processing_event_) {
+		reset_timer();
+		get_next_event(Time(0));
+	}
+}
+
 void Drive::set_head(int head) {
 	head = std::min(head, available_heads_ - 1);
 	if(head != head_) {
@@ -185,6 +205,21 @@ void Drive::run_for(const Cycles cycles) {
 // MARK: - Track timed event loop
 
 void Drive::get_next_event(const Time &duration_already_passed) {
+	// If flux transitions aren't being announced then the only event of interest is the next index hole.
+	if(!announces_flux_transitions_) {
+		random_interval_.set_zero();
+		current_event_.type = Track::Event::IndexHole;
+
+		const Time time_into_track = get_time_into_track();
+		if(time_into_track < Time(1)) {
+			current_event_.length = Time(1) - time_into_track;
+		} else {
+			current_event_.length.set_zero();
+		}
+		set_next_event_time_interval(current_event_.length * rotational_multiplier_);
+		return;
+	}
+
 	// Grab a new track if not already in possession of one. This will recursively call get_next_event,
 	// supplying a proper duration_already_passed.
 	if(!track_) {
@@ -245,7 +280,9 @@ void Drive::process_next_event() {
 		event_delegate_ &&
 		(current_event_.type == Track::Event::IndexHole || is_reading_)
 	){
+		is_processing_event_ = true;
 		event_delegate_->process_event(current_event_);
+		is_processing_event_ = false;
 	}
 	get_next_event(Time(0));
 }
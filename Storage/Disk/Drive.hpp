@@ -138,6 +138,23 @@ class Drive: public ClockingHint::Source, public TimedEventLoop {
 		*/
 		std::shared_ptr<Track> step_to(HeadPosition offset);
 
+		/*!
+			@returns the track currently underneath the head, if any.
+
+			This is for the benefit of user-optional fast-loading mechanisms **ONLY**; the track
+			returned should be inspected, never modified.
+		*/
+		std::shared_ptr<Track> get_current_track();
+
+		/*!
+			Enables or disables announcement of flux transitions to the event delegate. While disabled,
+			only index holes are announced, and the drive does no per-transition work.
+
+			This is unambiguously **NOT A REALISTIC DRIVE FUNCTION**. It's for the benefit of
+			user-optional fast-loading mechanisms **ONLY**.
+		*/
+		void set_announces_flux_transitions(bool announces_flux_transitions);
+
 	private:
 		// Drives contain an entire disk; from that a certain track
 		// will be currently under the head.
@@ -186,6 +203,8 @@ class Drive: public ClockingHint::Source, public TimedEventLoop {
 		void get_next_event(const Time &duration_already_passed);
 		void advance(const Cycles cycles) override;
 		Track::Event current_event_;
+		bool is_processing_event_ = false;
+		bool announces_flux_transitions_ = true;
 
 		// Helper for track changes.
 		Time get_time_into_track();
@@ -9,6 +9,7 @@
 #include "Parser.hpp"
 
 #include "Constants.hpp"
+#include "../../Track/PCMTrack.hpp"
 #include "../../Track/TrackSerialiser.hpp"
 #include "SegmentParser.hpp"
 
@@ -17,40 +18,49 @@ using namespace Storage::Encodings::MFM;
 Parser::Parser(bool is_mfm, const std::shared_ptr<Storage::Disk::Disk> &disk) :
 		disk_(disk), is_mfm_(is_mfm) {}
 
-void Parser::install_sectors_from_track(const Storage::Disk::Track::Address &address) {
-	if(sectors_by_address_by_track_.find(address) != sectors_by_address_by_track_.end()) {
-		return;
+std::shared_ptr<SectorTable> Storage::Encodings::MFM::sectors_from_track(const Storage::Disk::Track &track, bool is_mfm) {
+	// Tracks generated from sector-level disk images are usually a single PCM segment at or close to
+	// the expected bit rate; those can be scanned directly, without the expense of a PLL pass.
+	const Time bit_length = is_mfm ? MFMBitLength : FMBitLength;
+	const std::size_t expected_bits = bit_length.clock_rate / bit_length.length;
+	const Storage::Disk::PCMTrack *const pcm_track = dynamic_cast<const Storage::Disk::PCMTrack *>(&track);
+	const Storage::Disk::PCMSegment *const segment = pcm_track ? pcm_track->get_single_segment() : nullptr;
+
+	std::map<std::size_t, Sector> sectors;
+	if(segment && segment->data.size() >= expected_bits - expected_bits / 10 && segment->data.size() <= expected_bits + expected_bits / 10) {
+		sectors = sectors_from_segment(Storage::Disk::PCMSegment(*segment), is_mfm);
+	} else {
+		sectors = sectors_from_segment(Storage::Disk::track_serialisation(track, bit_length), is_mfm);
 	}
 
-	std::shared_ptr<Storage::Disk::Track> track = disk_->get_track_at_position(address);
-	if(!track) {
-		return;
+	std::shared_ptr<SectorTable> table(new SectorTable);
+	table->reserve(sectors.size());
+	for(auto &sector : sectors) {
+		table->push_back(std::move(sector.second));
 	}
+	return table;
+}
 
-	std::map<std::size_t, Sector> sectors = sectors_from_segment(
-		Storage::Disk::track_serialisation(*track, is_mfm_ ? MFMBitLength : FMBitLength),
-		is_mfm_);
+std::shared_ptr<SectorTable> Parser::get_sectors(int head, int track) {
+	const Disk::Track::Address address(head, Storage::Disk::HeadPosition(track));
 
-	std::map<int, Storage::Encodings::MFM::Sector> sectors_by_id;
-	for(const auto &sector : sectors) {
-		sectors_by_id.insert(std::make_pair(sector.second.address.sector, std::move(sector.second)));
+	auto sectors = sectors_by_track_.find(address);
+	if(sectors == sectors_by_track_.end()) {
+		const std::shared_ptr<Storage::Disk::Track> disk_track = disk_->get_track_at_position(address);
+		sectors = sectors_by_track_.insert(std::make_pair(address, disk_track ? sectors_from_track(*disk_track, is_mfm_) : nullptr)).first;
 	}
-	sectors_by_address_by_track_.insert(std::make_pair(address, std::move(sectors_by_id)));
+	return sectors->second;
 }
 
 Sector *Parser::get_sector(int head, int track, uint8_t sector) {
-	Disk::Track::Address address(head, Storage::Disk::HeadPosition(track));
-	install_sectors_from_track(address);
-
-	auto sectors = sectors_by_address_by_track_.find(address);
-	if(sectors == sectors_by_address_by_track_.end()) {
+	const std::shared_ptr<SectorTable> sectors = get_sectors(head, track);
+	if(!sectors) {
 		return nullptr;
 	}
 
-	auto stored_sector = sectors->second.find(sector);
-	if(stored_sector == sectors->second.end()) {
-		return nullptr;
+	// Sectors are stored in track order, so this finds the first with a matching ID.
+	for(auto &candidate : *sectors) {
+		if(candidate.address.sector == sector) return &candidate;
 	}
-
-	return &stored_sector->second;
+	return nullptr;
 }
@@ -13,12 +13,32 @@
 #include "../../Track/Track.hpp"
 #include "../../Drive.hpp"
 
+#include <map>
+#include <memory>
+#include <vector>
+
 namespace Storage {
 namespace Encodings {
 namespace MFM {
 
+/*!
+	A flat table of all sectors found on a single track, in the order in which they were found.
+*/
+using SectorTable = std::vector<Sector>;
+
+/*!
+	Decodes every sector on @c track, which is expected to hold MFM content if @c is_mfm is @c true
+	and FM content otherwise.
+
+	@returns the table of all sectors found.
+*/
+std::shared_ptr<SectorTable> sectors_from_track(const Storage::Disk::Track &track, bool is_mfm);
+
 /*!
 	Provides a mechanism for collecting sectors from a disk.
+
+	Each track is decoded once, upon first request, and its sectors are then retained in a @c SectorTable.
+	Tables are reference counted so that they may outlive the parser or be shared with other users.
 */
 class Parser {
 	public:
@@ -32,12 +52,18 @@ class Parser {
 		*/
 		Storage::Encodings::MFM::Sector *get_sector(int head, int track, uint8_t sector);
 
+		/*!
+			Seeks to the physical track at @c head and @c track.
+
+			@returns the table of all sectors found on it if the track exists; @c nullptr otherwise.
+		*/
+		std::shared_ptr<SectorTable> get_sectors(int head, int track);
+
 	private:
 		std::shared_ptr<Storage::Disk::Disk> disk_;
 		bool is_mfm_ = true;
 
-		void install_sectors_from_track(const Storage::Disk::Track::Address &address);
-		std::map<Storage::Disk::Track::Address, std::map<int, Storage::Encodings::MFM::Sector>> sectors_by_address_by_track_;
+		std::map<Storage::Disk::Track::Address, std::shared_ptr<SectorTable>> sectors_by_track_;
 };
 
 }
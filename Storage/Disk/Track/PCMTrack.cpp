@@ -69,6 +69,11 @@ bool PCMTrack::is_resampled_clone() {
 	return is_resampled_clone_;
 }
 
+const PCMSegment *PCMTrack::get_single_segment() const {
+	if(segment_event_sources_.size() != 1) return nullptr;
+	return &segment_event_sources_.front().segment();
+}
+
 Track *PCMTrack::clone() const {
 	return new PCMTrack(*this);
 }
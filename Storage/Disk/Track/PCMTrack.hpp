@@ -58,6 +58,11 @@ class PCMTrack: public Track {
 		PCMTrack *resampled_clone(size_t bits_per_track);
 		bool is_resampled_clone();
 
+		/*!
+			@returns the segment that constitutes this track if there is exactly one; @c nullptr otherwise.
+		*/
+		const PCMSegment *get_single_segment() const;
+
 		/*!
 			Replaces whatever is currently on the track from @c start_position to @c start_position + segment length
 			with the contents of @c segment.
@@ -84,6 +84,30 @@ void CAS::virtual_reset() {
 	distance_into_bit_ = 0;
 }
 
+struct CAS::CheckpointState: public Tape::ResumeState {
+	std::size_t chunk_pointer;
+	Phase phase;
+	std::size_t distance_into_phase;
+	std::size_t distance_into_bit;
+};
+
+std::unique_ptr<Tape::ResumeState> CAS::virtual_get_resume_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->chunk_pointer = chunk_pointer_;
+	state->phase = phase_;
+	state->distance_into_phase = distance_into_phase_;
+	state->distance_into_bit = distance_into_bit_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void CAS::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	chunk_pointer_ = state.chunk_pointer;
+	phase_ = state.phase;
+	distance_into_phase_ = state.distance_into_phase;
+	distance_into_bit_ = state.distance_into_bit;
+}
+
 Tape::Pulse CAS::virtual_get_next_pulse() {
 	Pulse pulse;
 	pulse.length.clock_rate = 9600;
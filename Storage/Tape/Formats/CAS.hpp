@@ -42,6 +42,11 @@ class CAS: public Tape {
 		void virtual_reset();
 		Pulse virtual_get_next_pulse();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		// Helper for populating the file list, below.
 		void get_next(Storage::FileHolder &file, uint8_t (&buffer)[10], std::size_t quantity);
 
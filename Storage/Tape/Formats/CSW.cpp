@@ -12,8 +12,7 @@
 
 using namespace Storage::Tape;
 
-CSW::CSW(const std::string &file_name) :
-	source_data_pointer_(0) {
+CSW::CSW(const std::string &file_name) {
 	Storage::FileHolder file(file_name);
 	if(file.stats().st_size < 0x20) throw ErrorNotCSW;
 
@@ -33,7 +32,6 @@ CSW::CSW(const std::string &file_name) :
 	if(major_version > 2 || !major_version || minor_version > 1) throw ErrorNotCSW;
 
 	// The header now diverges based on version.
-	uint32_t number_of_waves = 0;
 	if(major_version == 1) {
 		pulse_.length.clock_rate = file.get16le();
 
@@ -45,7 +43,7 @@ CSW::CSW(const std::string &file_name) :
 		file.seek(0x20, SEEK_SET);
 	} else {
 		pulse_.length.clock_rate = file.get32le();
-		number_of_waves = file.get32le();
+		file.seek(4, SEEK_CUR);	// Skip the number of waves; that's implied by the data.
 		switch(file.get8()) {
 			case 1: compression_type_ = CompressionType::RLE;	break;
 			case 2: compression_type_ = CompressionType::ZRLE;	break;
@@ -59,53 +57,43 @@ CSW::CSW(const std::string &file_name) :
 		file.seek(0x34 + extension_length, SEEK_SET);
 	}
 
-	// Grab all data remaining in the file.
+	// Grab all data remaining in the file; if it is compressed then it'll be decompressed as it is read.
 	std::vector<uint8_t> file_data;
 	std::size_t remaining_data = static_cast<std::size_t>(file.stats().st_size) - static_cast<std::size_t>(file.tell());
 	file_data.resize(remaining_data);
 	file.read(file_data.data(), remaining_data);
-
-	if(compression_type_ == CompressionType::ZRLE) {
-		// The only clue given by CSW as to the output size in bytes is that there will be
-		// number_of_waves waves. Waves are usually one byte, but may be five. So this code
-		// is pessimistic.
-		source_data_.resize(static_cast<std::size_t>(number_of_waves) * 5);
-
-		// uncompress will tell how many compressed bytes there actually were, so use its
-		// modification of output_length to throw away all the memory that isn't actually
-		// needed.
-		uLongf output_length = static_cast<uLongf>(number_of_waves * 5);
-		uncompress(source_data_.data(), &output_length, file_data.data(), file_data.size());
-		source_data_.resize(static_cast<std::size_t>(output_length));
-	} else {
-		source_data_ = std::move(file_data);
+	try {
+		set_data(std::move(file_data));
+	} catch(Storage::Data::InflateStream::Error) {
+		throw ErrorNotCSW;
 	}
 
 	invert_pulse();
+	initial_pulse_type_ = pulse_.type;
 }
 
-CSW::CSW(const std::vector<uint8_t> &&data, CompressionType compression_type, bool initial_level, uint32_t sampling_rate) {
+CSW::CSW(std::vector<uint8_t> &&data, CompressionType compression_type, bool initial_level, uint32_t sampling_rate) :
+	compression_type_(compression_type) {
 	pulse_.length.clock_rate = sampling_rate;
 	pulse_.type = initial_level ? Pulse::High : Pulse::Low;
-	source_data_ = std::move(data);
+	initial_pulse_type_ = pulse_.type;
+	set_data(std::move(data));
+}
+
+void CSW::set_data(std::vector<uint8_t> &&data) {
+	source_.reset(new Storage::Data::InflateStream(
+		std::move(data),
+		(compression_type_ == CompressionType::ZRLE) ? Storage::Data::InflateStream::Format::ZLib : Storage::Data::InflateStream::Format::Uncompressed));
 }
 
 uint8_t CSW::get_next_byte() {
-	if(source_data_pointer_ == source_data_.size()) return 0xff;
-	uint8_t result = source_data_[source_data_pointer_];
-	source_data_pointer_++;
-	return result;
+	uint8_t result = source_->get8();
+	return source_->eof() ? 0xff : result;
 }
 
 uint32_t CSW::get_next_int32le() {
-	if(source_data_pointer_ > source_data_.size() - 4) return 0xffff;
-	uint32_t result = (uint32_t)(
-		(source_data_[source_data_pointer_ + 0] << 0) |
-		(source_data_[source_data_pointer_ + 1] << 8) |
-		(source_data_[source_data_pointer_ + 2] << 16) |
-		(source_data_[source_data_pointer_ + 3] << 24));
-	source_data_pointer_ += 4;
-	return result;
+	uint32_t result = source_->get32le();
+	return source_->eof() ? 0xffff : result;
 }
 
 void CSW::invert_pulse() {
@@ -113,11 +101,30 @@ void CSW::invert_pulse() {
 }
 
 bool CSW::is_at_end() {
-	return source_data_pointer_ == source_data_.size();
+	return source_->is_at_end();
 }
 
 void CSW::virtual_reset() {
-	source_data_pointer_ = 0;
+	source_->seek(0);
+	pulse_.type = initial_pulse_type_;
+}
+
+struct CSW::CheckpointState: public Tape::ResumeState {
+	uint64_t source_offset;
+	Pulse pulse;
+};
+
+std::unique_ptr<Tape::ResumeState> CSW::virtual_get_resume_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->source_offset = source_->tell();
+	state->pulse = pulse_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void CSW::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	source_->seek(state.source_offset);
+	pulse_ = state.pulse;
 }
 
 Tape::Pulse CSW::virtual_get_next_pulse() {
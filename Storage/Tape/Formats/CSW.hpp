@@ -11,16 +11,19 @@
 
 #include "../Tape.hpp"
 #include "../../FileHolder.hpp"
+#include "../../Data/InflateStream.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
-#include <zlib.h>
 
 namespace Storage {
 namespace Tape {
 
 /*!
 	Provides a @c Tape containing a CSW tape image, which is a compressed 1-bit sampling.
+
+	Z-RLE content is decompressed on demand as the tape plays, rather than upfront.
 */
 class CSW: public Tape {
 	public:
@@ -37,9 +40,12 @@ class CSW: public Tape {
 		};
 
 		/*!
-			Constructs a @c CSW containing content as specified. Does not throw.
+			Constructs a @c CSW containing content as specified.
+
+			@throws Storage::Data::InflateStream::Error::CantInitialise if @c data is Z-RLE compressed and
+			a decompressor could not be set up.
 		*/
-		CSW(const std::vector<uint8_t> &&data, CompressionType compression_type, bool initial_level, uint32_t sampling_rate);
+		CSW(std::vector<uint8_t> &&data, CompressionType compression_type, bool initial_level, uint32_t sampling_rate);
 
 		enum {
 			ErrorNotCSW
@@ -52,15 +58,21 @@ class CSW: public Tape {
 		void virtual_reset();
 		Pulse virtual_get_next_pulse();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		Pulse pulse_;
+		Pulse::Type initial_pulse_type_;
 		CompressionType compression_type_;
 
+		void set_data(std::vector<uint8_t> &&data);
 		uint8_t get_next_byte();
 		uint32_t get_next_int32le();
 		void invert_pulse();
 
-		std::vector<uint8_t> source_data_;
-		std::size_t source_data_pointer_;
+		std::unique_ptr<Storage::Data::InflateStream> source_;
 };
 
 }
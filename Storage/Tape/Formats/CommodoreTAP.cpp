@@ -52,6 +52,29 @@ bool CommodoreTAP::is_at_end()
 	return is_at_end_;
 }
 
+struct CommodoreTAP::CheckpointState: public Tape::ResumeState {
+	long file_offset;
+	Pulse current_pulse;
+	bool is_at_end;
+};
+
+std::unique_ptr<Storage::Tape::Tape::ResumeState> CommodoreTAP::virtual_get_resume_state()
+{
+	CheckpointState *const state = new CheckpointState;
+	state->file_offset = file_.tell();
+	state->current_pulse = current_pulse_;
+	state->is_at_end = is_at_end_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void CommodoreTAP::virtual_set_resume_state(const ResumeState &resume_state)
+{
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	file_.seek(state.file_offset, SEEK_SET);
+	current_pulse_ = state.current_pulse;
+	is_at_end_ = state.is_at_end;
+}
+
 Storage::Tape::Tape::Pulse CommodoreTAP::virtual_get_next_pulse()
 {
 	if(is_at_end_)
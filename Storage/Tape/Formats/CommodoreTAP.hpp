@@ -42,6 +42,11 @@ class CommodoreTAP: public Tape {
 		void virtual_reset();
 		Pulse virtual_get_next_pulse();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		bool updated_layout_;
 		uint32_t file_size_;
 
@@ -31,6 +31,43 @@ void OricTAP::virtual_reset() {
 	pulse_counter_ = 0;
 }
 
+struct OricTAP::CheckpointState: public Tape::ResumeState {
+	long file_offset;
+	uint16_t current_value;
+	int bit_count;
+	int pulse_counter;
+	Phase phase, next_phase;
+	int phase_counter;
+	uint16_t data_end_address, data_start_address;
+};
+
+std::unique_ptr<Tape::ResumeState> OricTAP::virtual_get_resume_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->file_offset = file_.tell();
+	state->current_value = current_value_;
+	state->bit_count = bit_count_;
+	state->pulse_counter = pulse_counter_;
+	state->phase = phase_;
+	state->next_phase = next_phase_;
+	state->phase_counter = phase_counter_;
+	state->data_end_address = data_end_address_;
+	state->data_start_address = data_start_address_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void OricTAP::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	file_.seek(state.file_offset, SEEK_SET);
+	current_value_ = state.current_value;
+	bit_count_ = state.bit_count;
+	pulse_counter_ = state.pulse_counter;
+	phase_ = state.phase;
+	next_phase_ = state.next_phase;
+	phase_counter_ = state.phase_counter;
+	data_end_address_ = state.data_end_address;
+	data_start_address_ = state.data_start_address;
+}
+
 Tape::Pulse OricTAP::virtual_get_next_pulse() {
 	// Each byte byte is written as 13 bits: 0, eight bits of data, parity, three 1s.
 	if(bit_count_ == 13) {
@@ -42,6 +42,11 @@ class OricTAP: public Tape {
 		void virtual_reset();
 		Pulse virtual_get_next_pulse();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		// byte serialisation and output
 		uint16_t current_value_;
 		int bit_count_;
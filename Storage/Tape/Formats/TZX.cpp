@@ -47,6 +47,24 @@ void TZX::virtual_reset() {
 	post_gap(500);
 }
 
+struct TZX::CheckpointState: public Tape::ResumeState {
+	long file_offset;
+	bool current_level;
+};
+
+std::unique_ptr<Tape::ResumeState> TZX::get_source_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->file_offset = file_.tell();
+	state->current_level = current_level_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void TZX::set_source_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	file_.seek(state.file_offset, SEEK_SET);
+	current_level_ = state.current_level;
+}
+
 void TZX::get_next_pulses() {
 	while(empty()) {
 		uint8_t chunk_id = file_.get8();
@@ -107,11 +125,15 @@ void TZX::get_csw_recording_block() {
 
 	std::vector<uint8_t> raw_block = file_.read(block_length - 10);
 
-	CSW csw(std::move(raw_block), (compression_type == 2) ? CSW::CompressionType::ZRLE : CSW::CompressionType::RLE, current_level_, sampling_rate);
-	while(!csw.is_at_end()) {
-		Tape::Pulse next_pulse = csw.get_next_pulse();
-		current_level_ = (next_pulse.type == Tape::Pulse::High);
-		emplace_back(std::move(next_pulse));
+	try {
+		CSW csw(std::move(raw_block), (compression_type == 2) ? CSW::CompressionType::ZRLE : CSW::CompressionType::RLE, current_level_, sampling_rate);
+		while(!csw.is_at_end()) {
+			Tape::Pulse next_pulse = csw.get_next_pulse();
+			current_level_ = (next_pulse.type == Tape::Pulse::High);
+			emplace_back(std::move(next_pulse));
+		}
+	} catch(Storage::Data::InflateStream::Error) {
+		// Without a decompressor there's no way to obtain this block's content, so treat it as silence.
 	}
 
 	(void)number_of_compressed_pulses;
@@ -39,6 +39,11 @@ class TZX: public PulseQueuedTape {
 		void virtual_reset();
 		void get_next_pulses();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> get_source_state();
+		void set_source_state(const ResumeState &);
+
 		bool current_level_;
 
 		void get_standard_speed_data_block();
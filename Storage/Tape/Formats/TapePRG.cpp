@@ -87,6 +87,46 @@ Storage::Tape::Tape::Pulse PRG::virtual_get_next_pulse() {
 	return pulse;
 }
 
+struct PRG::CheckpointState: public Tape::ResumeState {
+	long file_offset;
+	FilePhase file_phase;
+	int phase_offset;
+	int bit_phase;
+	OutputToken output_token;
+	uint8_t output_byte;
+	uint8_t check_digit;
+	uint8_t copy_mask;
+};
+
+std::unique_ptr<Tape::ResumeState> PRG::virtual_get_resume_state() {
+	// The end-of-file flag is inspected upon the next byte boundary, and can't be restored
+	// by a seek, so decline to checkpoint while it is set.
+	if(file_.eof()) return nullptr;
+
+	CheckpointState *const state = new CheckpointState;
+	state->file_offset = file_.tell();
+	state->file_phase = file_phase_;
+	state->phase_offset = phase_offset_;
+	state->bit_phase = bit_phase_;
+	state->output_token = output_token_;
+	state->output_byte = output_byte_;
+	state->check_digit = check_digit_;
+	state->copy_mask = copy_mask_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void PRG::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	file_.seek(state.file_offset, SEEK_SET);
+	file_phase_ = state.file_phase;
+	phase_offset_ = state.phase_offset;
+	bit_phase_ = state.bit_phase;
+	output_token_ = state.output_token;
+	output_byte_ = state.output_byte;
+	check_digit_ = state.check_digit;
+	copy_mask_ = state.copy_mask;
+}
+
 void PRG::virtual_reset() {
 	bit_phase_ = 3;
 	file_.seek(2, SEEK_SET);
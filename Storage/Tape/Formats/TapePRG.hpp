@@ -43,6 +43,11 @@ class PRG: public Tape {
 		Pulse virtual_get_next_pulse();
 		void virtual_reset();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		uint16_t load_address_;
 		uint16_t length_;
 
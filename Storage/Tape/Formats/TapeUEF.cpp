@@ -7,16 +7,18 @@
 //
 
 #include "TapeUEF.hpp"
+#include "../../FileHolder.hpp"
+
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
 
-// MARK: - ZLib extensions
+// MARK: - Stream extensions
 
-static float gzgetfloat(gzFile file) {
+static float getfloat(Storage::Data::InflateStream &file) {
 	uint8_t bytes[4];
-	gzread(file, bytes, 4);
+	file.read(bytes, 4);
 
 	/* assume a four byte array named Float exists, where Float[0]
 	was the first byte read from the UEF, Float[1] the second, etc */
@@ -41,44 +43,32 @@ static float gzgetfloat(gzFile file) {
 	return result;
 }
 
-static uint8_t gzget8(gzFile file) {
-	// This is a workaround for gzgetc, which seems to be broken in ZLib 1.2.8.
-	uint8_t result;
-	gzread(file, &result, 1);
-	return result;
-}
-
-static int gzget16(gzFile file) {
-	uint8_t bytes[2];
-	gzread(file, bytes, 2);
-	return bytes[0] | (bytes[1] << 8);
-}
-
-static int gzget24(gzFile file) {
-	uint8_t bytes[3];
-	gzread(file, bytes, 3);
-	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
-}
-
-static int gzget32(gzFile file) {
-	uint8_t bytes[4];
-	gzread(file, bytes, 4);
-	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
-}
-
 using namespace Storage::Tape;
 
 UEF::UEF(const std::string &file_name) {
-	file_ = gzopen(file_name.c_str(), "rb");
+	// Load the entire file, and inspect it for the gzip signature; a UEF may be either compressed or not.
+	std::vector<uint8_t> file_data;
+	{
+		Storage::FileHolder file(file_name);
+		file_data = file.read(static_cast<std::size_t>(file.stats().st_size));
+	}
+	const bool is_compressed = file_data.size() >= 2 && file_data[0] == 0x1f && file_data[1] == 0x8b;
+	try {
+		file_.reset(new Storage::Data::InflateStream(
+			std::move(file_data),
+			is_compressed ? Storage::Data::InflateStream::Format::GZip : Storage::Data::InflateStream::Format::Uncompressed));
+	} catch(Storage::Data::InflateStream::Error) {
+		throw ErrorNotUEF;
+	}
 
 	char identifier[10];
-	int bytes_read = gzread(file_, identifier, 10);
+	std::size_t bytes_read = file_->read(reinterpret_cast<uint8_t *>(identifier), 10);
 	if(bytes_read < 10 || std::strcmp(identifier, "UEF File!")) {
 		throw ErrorNotUEF;
 	}
 
 	uint8_t version[2];
-	gzread(file_, version, 2);
+	file_->read(version, 2);
 
 	if(version[1] > 0 || version[0] > 10) {
 		throw ErrorNotUEF;
@@ -87,26 +77,45 @@ UEF::UEF(const std::string &file_name) {
 	set_platform_type();
 }
 
-UEF::~UEF() {
-	gzclose(file_);
-}
-
 // MARK: - Public methods
 
 void UEF::virtual_reset() {
-	gzseek(file_, 12, SEEK_SET);
+	file_->seek(12);
 	set_is_at_end(false);
 	clear();
+	time_base_ = 1200;
+	is_300_baud_ = false;
+}
+
+struct UEF::CheckpointState: public Tape::ResumeState {
+	uint64_t file_offset;
+	unsigned int time_base;
+	bool is_300_baud;
+};
+
+std::unique_ptr<Tape::ResumeState> UEF::get_source_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->file_offset = file_->tell();
+	state->time_base = time_base_;
+	state->is_300_baud = is_300_baud_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void UEF::set_source_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	file_->seek(state.file_offset);
+	time_base_ = state.time_base;
+	is_300_baud_ = state.is_300_baud;
 }
 
 // MARK: - Chunk navigator
 
 bool UEF::get_next_chunk(UEF::Chunk &result) {
-	uint16_t chunk_id = static_cast<uint16_t>(gzget16(file_));
-	uint32_t chunk_length = (uint32_t)gzget32(file_);
-	z_off_t start_of_next_chunk = gztell(file_) + chunk_length;
+	uint16_t chunk_id = file_->get16le();
+	uint32_t chunk_length = file_->get32le();
+	uint64_t start_of_next_chunk = file_->tell() + chunk_length;
 
-	if(gzeof(file_)) {
+	if(file_->eof()) {
 		return false;
 	}
 
@@ -141,13 +150,13 @@ void UEF::get_next_pulses() {
 			// change of base rate
 			case 0x0113: {
 				// TODO: something smarter than just converting this to an int
-				float new_time_base = gzgetfloat(file_);
+				float new_time_base = getfloat(*file_);
 				time_base_ = static_cast<unsigned int>(roundf(new_time_base));
 			}
 			break;
 
 			case 0x0117: {
-				int baud_rate = gzget16(file_);
+				int baud_rate = file_->get16le();
 				is_300_baud_ = (baud_rate == 300);
 			}
 			break;
@@ -157,7 +166,7 @@ void UEF::get_next_pulses() {
 			break;
 		}
 
-		gzseek(file_, next_chunk.start_of_next_chunk, SEEK_SET);
+		file_->seek(next_chunk.start_of_next_chunk);
 	}
 }
 
@@ -165,15 +174,15 @@ void UEF::get_next_pulses() {
 
 void UEF::queue_implicit_bit_pattern(uint32_t length) {
 	while(length--) {
-		queue_implicit_byte(gzget8(file_));
+		queue_implicit_byte(file_->get8());
 	}
 }
 
 void UEF::queue_explicit_bit_pattern(uint32_t length) {
-	std::size_t length_in_bits = (length << 3) - static_cast<std::size_t>(gzget8(file_));
+	std::size_t length_in_bits = (length << 3) - file_->get8();
 	uint8_t current_byte = 0;
 	for(std::size_t bit = 0; bit < length_in_bits; bit++) {
-		if(!(bit&7)) current_byte = gzget8(file_);
+		if(!(bit&7)) current_byte = file_->get8();
 		queue_bit(current_byte&1);
 		current_byte >>= 1;
 	}
@@ -181,13 +190,13 @@ void UEF::queue_explicit_bit_pattern(uint32_t length) {
 
 void UEF::queue_integer_gap() {
 	Time duration;
-	duration.length = static_cast<unsigned int>(gzget16(file_));
+	duration.length = file_->get16le();
 	duration.clock_rate = time_base_;
 	emplace_back(Pulse::Zero, duration);
 }
 
 void UEF::queue_floating_point_gap() {
-	float length = gzgetfloat(file_);
+	float length = getfloat(*file_);
 	Time duration;
 	duration.length = static_cast<unsigned int>(length * 4000000);
 	duration.clock_rate = 4000000;
@@ -195,26 +204,26 @@ void UEF::queue_floating_point_gap() {
 }
 
 void UEF::queue_carrier_tone() {
-	unsigned int number_of_cycles = static_cast<unsigned int>(gzget16(file_));
+	unsigned int number_of_cycles = file_->get16le();
 	while(number_of_cycles--) queue_bit(1);
 }
 
 void UEF::queue_carrier_tone_with_dummy() {
-	unsigned int pre_cycles = static_cast<unsigned int>(gzget16(file_));
-	unsigned int post_cycles = static_cast<unsigned int>(gzget16(file_));
+	unsigned int pre_cycles = file_->get16le();
+	unsigned int post_cycles = file_->get16le();
 	while(pre_cycles--) queue_bit(1);
 	queue_implicit_byte(0xaa);
 	while(post_cycles--) queue_bit(1);
 }
 
 void UEF::queue_security_cycles() {
-	int number_of_cycles = gzget24(file_);
-	bool first_is_pulse = gzget8(file_) == 'P';
-	bool last_is_pulse = gzget8(file_) == 'P';
+	int number_of_cycles = static_cast<int>(file_->get24le());
+	bool first_is_pulse = file_->get8() == 'P';
+	bool last_is_pulse = file_->get8() == 'P';
 
 	uint8_t current_byte = 0;
 	for(int cycle = 0; cycle < number_of_cycles; cycle++) {
-		if(!(cycle&7)) current_byte = gzget8(file_);
+		if(!(cycle&7)) current_byte = file_->get8();
 		int bit = (current_byte >> 7);
 		current_byte <<= 1;
 
@@ -236,16 +245,16 @@ void UEF::queue_security_cycles() {
 void UEF::queue_defined_data(uint32_t length) {
 	if(length < 3) return;
 
-	int bits_per_packet = gzget8(file_);
-	char parity_type = (char)gzget8(file_);
-	int number_of_stop_bits = gzget8(file_);
+	int bits_per_packet = file_->get8();
+	char parity_type = (char)file_->get8();
+	int number_of_stop_bits = file_->get8();
 
 	bool has_extra_stop_wave = (number_of_stop_bits < 0);
 	number_of_stop_bits = abs(number_of_stop_bits);
 
 	length -= 3;
 	while(length--) {
-		uint8_t byte = gzget8(file_);
+		uint8_t byte = file_->get8();
 
 		uint8_t parity_value = byte;
 		parity_value ^= (parity_value >> 4);
@@ -324,7 +333,7 @@ void UEF::set_platform_type() {
 	Chunk next_chunk;
 	while(get_next_chunk(next_chunk)) {
 		if(next_chunk.id == 0x0005) {
-			uint8_t target = gzget8(file_);
+			uint8_t target = file_->get8();
 			switch(target >> 4) {
 				case 0:	platform_type_ = TargetPlatform::BBCModelA;		break;
 				case 1:	platform_type_ = TargetPlatform::AcornElectron;	break;
@@ -334,7 +343,7 @@ void UEF::set_platform_type() {
 				default: break;
 			}
 		}
-		gzseek(file_, next_chunk.start_of_next_chunk, SEEK_SET);
+		file_->seek(next_chunk.start_of_next_chunk);
 	}
 	reset();
 }
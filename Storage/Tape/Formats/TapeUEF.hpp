@@ -11,17 +11,20 @@
 
 #include "../PulseQueuedTape.hpp"
 
+#include "../../Data/InflateStream.hpp"
 #include "../../TargetPlatforms.hpp"
 
 #include <cstdint>
+#include <memory>
 #include <string>
-#include <zlib.h>
 
 namespace Storage {
 namespace Tape {
 
 /*!
 	Provides a @c Tape containing a UEF tape image, a slightly-convoluted description of pulses.
+
+	UEFs are usually gzip compressed; they are decompressed on demand as the tape plays.
 */
 class UEF : public PulseQueuedTape, public TargetPlatform::TypeDistinguisher {
 	public:
@@ -31,7 +34,6 @@ class UEF : public PulseQueuedTape, public TargetPlatform::TypeDistinguisher {
 			@throws ErrorNotUEF if this file could not be opened and recognised as a valid UEF.
 		*/
 		UEF(const std::string &file_name);
-		~UEF();
 
 		enum {
 			ErrorNotUEF
@@ -44,19 +46,24 @@ class UEF : public PulseQueuedTape, public TargetPlatform::TypeDistinguisher {
 		TargetPlatform::Type target_platform_type();
 		TargetPlatform::Type platform_type_ = TargetPlatform::Acorn;
 
-		gzFile file_;
+		std::unique_ptr<Storage::Data::InflateStream> file_;
 		unsigned int time_base_ = 1200;
 		bool is_300_baud_ = false;
 
 		struct Chunk {
 			uint16_t id;
 			uint32_t length;
-			z_off_t start_of_next_chunk;
+			uint64_t start_of_next_chunk;
 		};
 
 		bool get_next_chunk(Chunk &);
 		void get_next_pulses();
 
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> get_source_state();
+		void set_source_state(const ResumeState &);
+
 		void queue_implicit_bit_pattern(uint32_t length);
 		void queue_explicit_bit_pattern(uint32_t length);
 
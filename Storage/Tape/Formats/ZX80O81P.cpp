@@ -42,6 +42,38 @@ void ZX80O81P::virtual_reset() {
 	bit_pointer_ = wave_pointer_ = 0;
 }
 
+struct ZX80O81P::CheckpointState: public Tape::ResumeState {
+	uint8_t byte;
+	int bit_pointer;
+	int wave_pointer;
+	bool is_past_silence, has_ended_final_byte;
+	bool is_high;
+	std::size_t data_pointer;
+};
+
+std::unique_ptr<Tape::ResumeState> ZX80O81P::virtual_get_resume_state() {
+	CheckpointState *const state = new CheckpointState;
+	state->byte = byte_;
+	state->bit_pointer = bit_pointer_;
+	state->wave_pointer = wave_pointer_;
+	state->is_past_silence = is_past_silence_;
+	state->has_ended_final_byte = has_ended_final_byte_;
+	state->is_high = is_high_;
+	state->data_pointer = data_pointer_;
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void ZX80O81P::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	byte_ = state.byte;
+	bit_pointer_ = state.bit_pointer;
+	wave_pointer_ = state.wave_pointer;
+	is_past_silence_ = state.is_past_silence;
+	has_ended_final_byte_ = state.has_ended_final_byte;
+	is_high_ = state.is_high;
+	data_pointer_ = state.data_pointer;
+}
+
 bool ZX80O81P::has_finished_data() {
 	return (data_pointer_ == data_.size()) && !wave_pointer_ && !bit_pointer_;
 }
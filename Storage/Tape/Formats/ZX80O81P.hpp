@@ -47,6 +47,11 @@ class ZX80O81P: public Tape, public TargetPlatform::TypeDistinguisher {
 
 		void virtual_reset();
 		Pulse virtual_get_next_pulse();
+
+		// Seeking index support.
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
 		bool has_finished_data();
 
 		uint8_t byte_;
@@ -37,6 +37,38 @@ void PulseQueuedTape::emplace_back(const Tape::Pulse &&pulse) {
 	queued_pulses_.emplace_back(pulse);
 }
 
+struct PulseQueuedTape::CheckpointState: public Tape::ResumeState {
+	bool is_at_end;
+	std::unique_ptr<ResumeState> source_state;
+};
+
+std::unique_ptr<Tape::ResumeState> PulseQueuedTape::virtual_get_resume_state() {
+	// Unless the tape has ended, a checkpoint can be taken only once the queue is exhausted,
+	// i.e. when the subclass is about to be asked for a new batch.
+	if(!is_at_end_ && pulse_pointer_ != queued_pulses_.size()) return nullptr;
+
+	std::unique_ptr<ResumeState> source_state = get_source_state();
+	if(!source_state) return nullptr;
+
+	CheckpointState *const state = new CheckpointState;
+	state->is_at_end = is_at_end_;
+	state->source_state = std::move(source_state);
+	return std::unique_ptr<ResumeState>(state);
+}
+
+void PulseQueuedTape::virtual_set_resume_state(const ResumeState &resume_state) {
+	const CheckpointState &state = static_cast<const CheckpointState &>(resume_state);
+	clear();
+	is_at_end_ = state.is_at_end;
+	set_source_state(*state.source_state);
+}
+
+std::unique_ptr<Tape::ResumeState> PulseQueuedTape::get_source_state() {
+	return nullptr;
+}
+
+void PulseQueuedTape::set_source_state(const ResumeState &) {}
+
 Tape::Pulse PulseQueuedTape::silence() {
 	Pulse silence;
 	silence.type = Pulse::Zero;
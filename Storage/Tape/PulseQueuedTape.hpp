@@ -39,10 +39,23 @@ class PulseQueuedTape: public Tape {
 		void set_is_at_end(bool);
 		virtual void get_next_pulses() = 0;
 
+		/*!
+			Subclasses may implement these to enable indexed seeking. @c get_source_state should
+			return whatever is necessary to regenerate all pulses from the next call to @c get_next_pulses
+			onwards, or @c nullptr if that isn't possible; @c set_source_state should restore such a state.
+			Checkpoints are taken only between batches of pulses.
+		*/
+		virtual std::unique_ptr<ResumeState> get_source_state();
+		virtual void set_source_state(const ResumeState &);
+
 	private:
 		Pulse virtual_get_next_pulse();
 		Pulse silence();
 
+		struct CheckpointState;
+		std::unique_ptr<ResumeState> virtual_get_resume_state();
+		void virtual_set_resume_state(const ResumeState &);
+
 		std::vector<Pulse> queued_pulses_;
 		std::size_t pulse_pointer_;
 		bool is_at_end_;
@@ -9,6 +9,8 @@
 #include "Tape.hpp"
 #include "../../NumberTheory/Factors.hpp"
 
+#include <algorithm>
+
 using namespace Storage::Tape;
 
 // MARK: - Lifecycle
@@ -19,26 +21,68 @@ TapePlayer::TapePlayer(unsigned int input_clock_rate) :
 
 // MARK: - Seeking
 
+namespace {
+/// The minimum number of pulses between checkpoints in the seeking index.
+const uint64_t PulsesPerCheckpoint = 8192;
+}
+
 void Storage::Tape::Tape::seek(Time &seek_time) {
-	Time next_time(0);
-	reset();
+	// Resume from the final checkpoint with a time no later than seek_time, if any.
+	const auto checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), seek_time,
+		[](const Time &lhs, const Checkpoint &rhs) { return lhs < rhs.time; });
+
+	Time next_time;
+	restore_checkpoint((checkpoint == checkpoints_.begin()) ? nullptr : &*(checkpoint - 1), next_time);
 	while(next_time <= seek_time) {
-		get_next_pulse();
-		next_time += pulse_.length;
+		advance_and_index(next_time);
 	}
 }
 
 Storage::Time Tape::get_current_time() {
-	Time time(0);
-	uint64_t steps = get_offset();
-	reset();
-	while(steps--) {
-		get_next_pulse();
-		time += pulse_.length;
+	// Resume from the final checkpoint with an offset no later than the current one, if any.
+	const uint64_t target_offset = offset_;
+	const auto checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), target_offset,
+		[](uint64_t lhs, const Checkpoint &rhs) { return lhs < rhs.offset; });
+
+	Time time;
+	restore_checkpoint((checkpoint == checkpoints_.begin()) ? nullptr : &*(checkpoint - 1), time);
+	while(offset_ < target_offset) {
+		advance_and_index(time);
 	}
 	return time;
 }
 
+void Storage::Tape::Tape::restore_checkpoint(const Checkpoint *checkpoint, Time &time) {
+	reset();
+	if(checkpoint) {
+		virtual_set_resume_state(*checkpoint->state);
+		offset_ = checkpoint->offset;
+		time = checkpoint->time;
+	} else {
+		time.set_zero();
+	}
+}
+
+void Storage::Tape::Tape::advance_and_index(Time &time) {
+	get_next_pulse();
+	time += pulse_.length;
+
+	// Add a checkpoint if this is sufficiently far beyond the last, and the subclass is able to provide one.
+	// Because pulses are always indexed from an existing checkpoint, anything recorded here is necessarily
+	// later than everything already in the index.
+	const uint64_t next_checkpoint_offset = checkpoints_.empty() ? PulsesPerCheckpoint : checkpoints_.back().offset + PulsesPerCheckpoint;
+	if(offset_ >= next_checkpoint_offset) {
+		std::unique_ptr<ResumeState> state = virtual_get_resume_state();
+		if(state) checkpoints_.emplace_back(offset_, time, std::move(state));
+	}
+}
+
+std::unique_ptr<Tape::ResumeState> Tape::virtual_get_resume_state() {
+	return nullptr;
+}
+
+void Tape::virtual_set_resume_state(const ResumeState &) {}
+
 void Storage::Tape::Tape::reset() {
 	offset_ = 0;
 	virtual_reset();
@@ -56,11 +100,18 @@ uint64_t Tape::get_offset() {
 
 void Tape::set_offset(uint64_t offset) {
 	if(offset == offset_) return;
-	if(offset < offset_) {
-		reset();
+
+	// Restore the final checkpoint no later than offset if either the tape would otherwise
+	// need to be rewound, or if that checkpoint is beyond the current position.
+	const auto checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), offset,
+		[](uint64_t lhs, const Checkpoint &rhs) { return lhs < rhs.offset; });
+	const Checkpoint *const nearest_checkpoint = (checkpoint == checkpoints_.begin()) ? nullptr : &*(checkpoint - 1);
+	if(offset < offset_ || (nearest_checkpoint && nearest_checkpoint->offset > offset_)) {
+		Time time;
+		restore_checkpoint(nearest_checkpoint, time);
 	}
-	offset -= offset_;
-	while(offset--) get_next_pulse();
+
+	while(offset_ < offset) get_next_pulse();
 }
 
 // MARK: - Player
@@ -10,6 +10,7 @@
 #define Tape_hpp
 
 #include <memory>
+#include <vector>
 
 #include "../../ClockReceiver/ClockReceiver.hpp"
 #include "../../ClockReceiver/ClockingHintSource.hpp"
@@ -29,6 +30,10 @@ namespace Tape {
 	Subclasses should implement at least @c get_next_pulse and @c reset to provide a serial feeding
 	of pulses and the ability to return to the start of the feed. They may also implement @c seek if
 	a better implementation than a linear search from the @c reset time can be implemented.
+
+	Subclasses that can cheaply capture and restore their complete parsing state should also implement
+	@c virtual_get_resume_state and @c virtual_set_resume_state; if they do then seeking and time reporting
+	will be assisted by a sparse index of checkpoints, built lazily as the tape is navigated.
 */
 class Tape {
 	public:
@@ -80,12 +85,50 @@ class Tape {
 
 		virtual ~Tape() {};
 
+	protected:
+		/*!
+			Base type for whatever a subclass needs to retain in order to resume pulse generation
+			from a particular point in the tape.
+		*/
+		struct ResumeState {
+			virtual ~ResumeState() {}
+		};
+
 	private:
 		uint64_t offset_;
 		Tape::Pulse pulse_;
 
 		virtual Pulse virtual_get_next_pulse() = 0;
 		virtual void virtual_reset() = 0;
+
+		/*!
+			@returns a description of the current parsing state, sufficient that a later call to
+			@c virtual_set_resume_state can return the tape to this point, or @c nullptr if the state
+			cannot be captured at this point. The default implementation always returns @c nullptr.
+		*/
+		virtual std::unique_ptr<ResumeState> virtual_get_resume_state();
+
+		/*!
+			Restores a state previously returned by @c virtual_get_resume_state. Will be called
+			only immediately after @c virtual_reset.
+		*/
+		virtual void virtual_set_resume_state(const ResumeState &state);
+
+		// The seeking index: a list of checkpoints in ascending order, each recording
+		// an offset, the time at the end of the pulse at that offset and the subclass
+		// state necessary to continue from there.
+		struct Checkpoint {
+			uint64_t offset;
+			Time time;
+			std::unique_ptr<ResumeState> state;
+
+			Checkpoint(uint64_t offset, const Time &time, std::unique_ptr<ResumeState> &&state) :
+				offset(offset), time(time), state(std::move(state)) {}
+		};
+		std::vector<Checkpoint> checkpoints_;
+
+		void restore_checkpoint(const Checkpoint *checkpoint, Time &time);
+		void advance_and_index(Time &time);
 };
 
 /*!